@@ -35,8 +35,8 @@ public:
     {
         for (int i=0; i<3; ++i)
         {
-            if      (_p[i] < min_[i])  min_[i] = _p[i];
-            else if (_p[i] > max_[i])  max_[i] = _p[i];
+            if (_p[i] < min_[i])  min_[i] = _p[i];
+            if (_p[i] > max_[i])  max_[i] = _p[i];
         }
         return *this;
     }
@@ -10,6 +10,8 @@
 #include <graphene/geometry/Matrix4x4.h>
 #include <math.h>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 
 //== NAMESPACE ================================================================
@@ -421,6 +423,155 @@ symmetric_eigendecomposition(const Mat3<Scalar>& m,
 }
 
 
+//-----------------------------------------------------------------------------
+
+
+/// Non-iterative version of symmetric_eigendecomposition() (D. Eberly, "A
+/// robust eigensolver for 3x3 symmetric matrices"): eigenvalues from the
+/// trigonometric solution of the characteristic polynomial, eigenvectors
+/// from cross products of the rows of m - eval*I. Same output convention:
+/// eval1 >= eval2 >= eval3, evec3 = evec1 x evec2. Returns false for
+/// non-finite input.
+template <typename Scalar>
+bool
+symmetric_eigendecomposition_closed_form(const Mat3<Scalar>& m,
+                                         Scalar& eval1,
+                                         Scalar& eval2,
+                                         Scalar& eval3,
+                                         Vector<Scalar,3>& evec1,
+                                         Vector<Scalar,3>& evec2,
+                                         Vector<Scalar,3>& evec3)
+{
+    typedef Vector<Scalar,3> Vec;
+
+    // scale to [-1,1] against overflow
+    Scalar s = 0.0;
+    for (int i=0; i<3; ++i)
+    {
+        for (int j=i; j<3; ++j)
+        {
+            const Scalar a = fabs(m(i,j));
+            if (!(a <= std::numeric_limits<Scalar>::max())) return false;
+            s = std::max(s, a);
+        }
+    }
+
+    if (s == 0.0)
+    {
+        eval1 = eval2 = eval3 = 0.0;
+        evec1 = Vec(1,0,0);
+        evec2 = Vec(0,1,0);
+        evec3 = Vec(0,0,1);
+        return true;
+    }
+
+    const Scalar a00 = m(0,0)/s, a01 = m(0,1)/s, a02 = m(0,2)/s;
+    const Scalar a11 = m(1,1)/s, a12 = m(1,2)/s, a22 = m(2,2)/s;
+    const Scalar off = a01*a01 + a02*a02 + a12*a12;
+
+
+    // eigenvalues: m = q*I + p*B, det(B - beta*I) = 0 with beta = 2 cos(phi)
+    const Scalar q   = (a00 + a11 + a22) / 3.0;
+    const Scalar b00 = a00 - q, b11 = a11 - q, b22 = a22 - q;
+    const Scalar p   = sqrt((b00*b00 + b11*b11 + b22*b22 + 2.0*off) / 6.0);
+
+    if (p == 0.0)
+    {
+        eval1 = eval2 = eval3 = q*s;
+        evec1 = Vec(1,0,0);
+        evec2 = Vec(0,1,0);
+        evec3 = Vec(0,0,1);
+        return true;
+    }
+
+    const Scalar c00 = b11*b22 - a12*a12;
+    const Scalar c01 = a01*b22 - a12*a02;
+    const Scalar c02 = a01*a12 - b11*a02;
+    const Scalar half_det = std::min(Scalar(1.0), std::max(Scalar(-1.0),
+                            Scalar(0.5 * (b00*c00 - a01*c01 + a02*c02) / (p*p*p))));
+
+    const Scalar phi   = acos(half_det) / 3.0;
+    const Scalar beta0 = 2.0 * cos(phi);                    // largest
+    const Scalar beta2 = 2.0 * cos(phi + 2.0*M_PI/3.0);     // smallest
+    const Scalar beta1 = std::min(beta0, std::max(beta2, -(beta0 + beta2)));
+
+    const Scalar lambda[3] = { q + p*beta0, q + p*beta1, q + p*beta2 };
+
+
+    // rows of m - lambda*I
+    const Vec r0(a00, a01, a02), r1(a01, a11, a12), r2(a02, a12, a22);
+
+    // eigenvector of a simple eigenvalue: largest cross product of two rows
+    struct Local
+    {
+        static Vec simple(const Vec& r0, const Vec& r1, const Vec& r2, Scalar lambda)
+        {
+            const Vec s0(r0[0]-lambda, r0[1], r0[2]);
+            const Vec s1(r1[0], r1[1]-lambda, r1[2]);
+            const Vec s2(r2[0], r2[1], r2[2]-lambda);
+            const Vec c[3] = { cross(s0,s1), cross(s0,s2), cross(s1,s2) };
+            const Scalar d[3] = { sqrnorm(c[0]), sqrnorm(c[1]), sqrnorm(c[2]) };
+            const int i = (d[0] >= d[1]) ? ((d[0] >= d[2]) ? 0 : 2) : ((d[1] >= d[2]) ? 1 : 2);
+            return (d[i] > 0.0) ? Vec(c[i] / sqrt(d[i])) : Vec(1,0,0);
+        }
+
+        // eigenvector of lambda orthogonal to the eigenvector w
+        static Vec orthogonal(const Vec& r0, const Vec& r1, const Vec& r2, Scalar lambda, const Vec& w)
+        {
+            // orthonormal u, v spanning the complement of w
+            Vec u;
+            if (fabs(w[0]) > fabs(w[1]))
+                u = Vec(-w[2], 0, w[0]) / sqrt(w[0]*w[0] + w[2]*w[2]);
+            else
+                u = Vec(0, w[2], -w[1]) / sqrt(w[1]*w[1] + w[2]*w[2]);
+            const Vec v = cross(w, u);
+
+            // 2x2 restriction of m - lambda*I, its null vector in (u,v)
+            const Vec mu(dot(r0,u), dot(r1,u), dot(r2,u));
+            const Vec mv(dot(r0,v), dot(r1,v), dot(r2,v));
+            Scalar m00 = dot(u,mu) - lambda, m01 = dot(u,mv), m11 = dot(v,mv) - lambda;
+            const Scalar f00 = fabs(m00), f01 = fabs(m01), f11 = fabs(m11);
+
+            if (f00 >= f11)
+            {
+                if (std::max(f00, f01) == 0.0) return u;
+                if (f00 >= f01) { m01 /= m00; m00 = 1.0 / sqrt(1.0 + m01*m01); m01 *= m00; }
+                else            { m00 /= m01; m01 = 1.0 / sqrt(1.0 + m00*m00); m00 *= m01; }
+                return m01*u - m00*v;
+            }
+            else
+            {
+                if (std::max(f11, f01) == 0.0) return u;
+                if (f11 >= f01) { m01 /= m11; m11 = 1.0 / sqrt(1.0 + m01*m01); m01 *= m11; }
+                else            { m11 /= m01; m01 = 1.0 / sqrt(1.0 + m11*m11); m11 *= m01; }
+                return m11*u - m01*v;
+            }
+        }
+    };
+
+
+    // start with the eigenvalue farther from the middle one
+    if (half_det >= 0.0)
+    {
+        evec1 = Local::simple(r0, r1, r2, lambda[0]);
+        evec2 = Local::orthogonal(r0, r1, r2, lambda[1], evec1);
+    }
+    else
+    {
+        evec3 = Local::simple(r0, r1, r2, lambda[2]);
+        evec2 = Local::orthogonal(r0, r1, r2, lambda[1], evec3);
+        evec1 = normalize(cross(evec2, evec3));
+    }
+    evec3 = normalize(cross(evec1, evec2));
+
+    eval1 = lambda[0] * s;
+    eval2 = lambda[1] * s;
+    eval3 = lambda[2] * s;
+
+    return true;
+}
+
+
 //=============================================================================
 } // namespace graphene
 //=============================================================================
@@ -436,6 +436,9 @@ namespace graphene {
 		{
 			Base_node* node = (Base_node*)scene_graph_->selected_node();
 
+			// a running job still works on the node
+			if (node && node->is_busy()) return;
+
 			if (node)
 			{
 				delete node;
@@ -545,6 +548,9 @@ namespace graphene {
 		{
 			Base_node* node = (Base_node*)scene_graph_->selected_node();
 
+			// a running job still works on the node
+			if (node && node->is_busy()) return;
+
 			if (node)
 			{
 				std::string filename = node->fileinfo();
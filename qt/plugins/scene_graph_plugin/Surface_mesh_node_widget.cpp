@@ -198,6 +198,9 @@ void
 Surface_mesh_node_widget::
 update_node()
 {
+    // the mesh belongs to a running job
+    if (node_->is_busy()) return;
+
     QColor color;
 
     color = pb_front_color->palette().color(QPalette::Window);
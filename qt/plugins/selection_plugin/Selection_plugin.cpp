@@ -35,6 +35,7 @@ Selection_plugin()
 {
     name_ = "Selection_plugin";
     lasso_ = NULL;
+    ui_ = NULL;
 }
 
 
@@ -66,6 +67,8 @@ init(Main_window *w)
     connect(ui->pb5, SIGNAL(clicked()), this, SLOT(slot_grow_selection()));
     connect(ui->pb6, SIGNAL(clicked()), this, SLOT(slot_load()));
     connect(ui->pb7, SIGNAL(clicked()), this, SLOT(slot_save()));
+    connect(ui->pb8, SIGNAL(clicked()), this, SLOT(slot_grow_selection_radius()));
+    ui_ = ui;
 
     toolbox_->addItem(ui,"Selections");
     toolbox_->setItemIcon(toolbox_->indexOf(ui),QIcon(":/graphene/icons/selection.png"));
@@ -191,6 +194,28 @@ slot_grow_selection()
 //-----------------------------------------------------------------------------
 
 
+void
+Selection_plugin::
+slot_grow_selection_radius()
+{
+    Object_node* node = main_window_->scene_graph_->selected_node();
+
+    if (node)
+    {
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+
+        node->grow_selection(ui_->sb1->value() * node->bbox().size());
+
+        QApplication::restoreOverrideCursor();
+
+        main_window_->qglviewer_->updateGL();
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 void
 Selection_plugin::
 slot_key_press_event(QKeyEvent* _event)
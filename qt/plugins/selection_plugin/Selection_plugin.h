@@ -61,6 +61,7 @@ public slots:
     void slot_select_all();
     void slot_select_isolated();
     void slot_grow_selection();
+    void slot_grow_selection_radius();
     void slot_load();
     void slot_save();
 
@@ -69,6 +70,7 @@ protected:
 
     Mouse_mode mouse_mode_;
     Lasso_selection_node* lasso_;
+    Selection_plugin_widget* ui_;
 
 
 protected:
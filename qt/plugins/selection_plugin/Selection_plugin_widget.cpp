@@ -16,6 +16,17 @@ setupUi()
     pb5 = new QPushButton("Grow");
     pb6 = new QPushButton("Load");
     pb7 = new QPushButton("Save");
+    pb8 = new QPushButton("Grow by radius");
+
+    sb1 = new QDoubleSpinBox;
+    sb1->setDecimals(3);
+    sb1->setRange(0.001, 1.0);
+    sb1->setSingleStep(0.01);
+    sb1->setValue(0.05);
+
+    hb1 = new QHBoxLayout;
+    hb1->addWidget(pb8);
+    hb1->addWidget(sb1);
 
     vb2 = new QVBoxLayout;
     vb2->addWidget(pb1);
@@ -23,6 +34,7 @@ setupUi()
     vb2->addWidget(pb3);
     vb2->addWidget(pb4);
     vb2->addWidget(pb5);
+    vb2->addLayout(hb1);
     vb2->addWidget(pb6);
     vb2->addWidget(pb7);
     vb2->addStretch(1);
@@ -7,6 +7,8 @@
 #include <QRadioButton>
 #include <QVBoxLayout>
 #include <QGridLayout>
+#include <QHBoxLayout>
+#include <QDoubleSpinBox>
 
 namespace graphene {
 namespace qt {
@@ -30,6 +32,11 @@ public:
     QPushButton* pb5;
     QPushButton* pb6;
     QPushButton* pb7;
+    QPushButton* pb8;
+
+    // geodesic radius for pb8, relative to the bounding box size
+    QDoubleSpinBox* sb1;
+    QHBoxLayout* hb1;
 
     QGridLayout* gl1;
 
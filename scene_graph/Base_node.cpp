@@ -21,7 +21,8 @@ Base_node::
 Base_node(Base_node* parent, const std::string& name)
     : parent_(parent),
       name_(name),
-      is_target_(false)
+      is_target_(false),
+      is_busy_(false)
 {
     if (parent)
         parent->children().push_back(this);
@@ -53,6 +53,10 @@ public:
     bool is_target() const { return is_target_; }
     void set_target(bool _b) { is_target_ = _b; }
 
+    /// a busy node is owned by a running job: do not modify or delete it
+    bool is_busy() const { return is_busy_; }
+    void set_busy(bool _b) { is_busy_ = _b; }
+
     Base_node* parent() { return parent_; }
     const Base_node* parent() const { return parent_; }
 
@@ -67,6 +71,7 @@ protected:
     std::string           fileinfo_;
     Bounding_box          bbox_;
     bool                  is_target_;
+    bool                  is_busy_;
     std::list<Base_node*> children_;
 };
 
@@ -64,6 +64,7 @@ public:
     virtual void select_isolated() {};
     virtual void delete_selected() {};
     virtual void grow_selection() {};
+    virtual void grow_selection(Scalar radius) {};
     virtual void get_selection(std::vector<size_t>& indices) {};
     virtual void set_selection(const std::vector<size_t>& indices) {};
     virtual void clear_selection(const std::vector<size_t>& indices) {};
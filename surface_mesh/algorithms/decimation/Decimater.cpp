@@ -0,0 +1,602 @@
+//== INCLUDES =================================================================
+
+#include "Decimater.h"
+#include <graphene/surface_mesh/algorithms/remeshing/Sizing_field.h>
+#include <graphene/geometry/aspect_ratio.h>
+#include <graphene/macros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+bool decimate(Surface_mesh& mesh,
+              unsigned int n_faces,
+              Scalar max_error,
+              bool parallel,
+              utility::Progress* progress)
+{
+    Decimater decimater(mesh);
+    decimater.set_max_error(max_error);
+    decimater.set_parallel(parallel);
+    decimater.set_progress(progress);
+    return decimater.decimate(n_faces);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Decimater::
+Decimater(Surface_mesh& mesh)
+    : mesh_(mesh), parallel_(false), progress_(NULL), batch_(0),
+      max_error_(0.0), max_normal_deviation_(60.0), max_aspect_ratio_(20.0),
+      min_cos_(0.5), max_cost_(0.0)
+{
+    points_ = mesh_.vertex_property<Point>("v:point");
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+decimate(unsigned int n_faces)
+{
+    if (!mesh_.is_triangle_mesh())
+    {
+        LOG(Log_warning) << "Decimater: not a triangle mesh" << std::endl;
+        return false;
+    }
+
+    preprocessing();
+
+    bool ok = report("preprocessing", 0.0);
+    if (ok)
+    {
+        ok = parallel_ ? decimate_parallel(n_faces) : decimate_queue(n_faces);
+    }
+
+    postprocessing();
+
+    return ok && report("done", 1.0);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+report(const char* stage, float fraction)
+{
+    return progress_ ? progress_->report(stage, fraction) : true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Decimater::
+preprocessing()
+{
+    // properties
+    vfeature_ = mesh_.vertex_property<bool>("v:feature", false);
+    efeature_ = mesh_.edge_property<bool>("e:feature", false);
+    vlocked_  = mesh_.add_vertex_property<bool>("v:locked", false);
+    vquadric_ = mesh_.add_vertex_property<Quadric>("v:quadric");
+
+    min_cos_  = cos(max_normal_deviation_ / 180.0 * M_PI);
+    max_cost_ = 0.0;
+
+
+    // lock unselected vertices if some vertices are selected
+    Surface_mesh::Vertex_property<bool> vselected = mesh_.get_vertex_property<bool>("v:selected");
+    if (vselected)
+    {
+        bool has_selection = false;
+        for (Surface_mesh::Vertex_iterator v_it = mesh_.vertices_begin(); v_it != mesh_.vertices_end(); ++v_it)
+        {
+            if (vselected[*v_it])
+            {
+                has_selection = true;
+                break;
+            }
+        }
+
+        if (has_selection)
+        {
+            for (Surface_mesh::Vertex_iterator v_it = mesh_.vertices_begin(); v_it != mesh_.vertices_end(); ++v_it)
+            {
+                vlocked_[*v_it] = !vselected[*v_it];
+            }
+        }
+    }
+
+
+    // feature vertices lie on feature edges. lock corners, end points of
+    // feature lines and feature vertices without feature edges.
+    Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+    int c;
+    for (Surface_mesh::Vertex_iterator v_it = mesh_.vertices_begin(); v_it != mesh_.vertices_end(); ++v_it)
+    {
+        c = 0;
+        vh_it = vh_end = mesh_.halfedges(*v_it);
+        if (vh_it) do
+        {
+            if (efeature_[mesh_.edge(*vh_it)])
+                ++c;
+        } while (++vh_it != vh_end);
+
+        if (c) vfeature_[*v_it] = true;
+        if (vfeature_[*v_it] && c != 2) vlocked_[*v_it] = true;
+    }
+
+
+    // feature lines refer to faces and vertices of the mesh, keep those
+    Surface_mesh::Vertex_around_face_circulator vf_it, vf_end;
+    Surface_mesh::Face f;
+    Surface_mesh::Vertex v;
+    std::vector<Surface_mesh::Face> faces;
+
+    for (unsigned int i = 0; i < mesh_.fhalfedges_size(); ++i)
+    {
+        Surface_mesh::FeatureHalfedge h(i);
+        if (!mesh_.is_deleted(h))
+            faces.push_back(mesh_.face(h));
+    }
+
+    for (unsigned int i = 0; i < mesh_.endpoint_size(); ++i)
+    {
+        Surface_mesh::EndPoint ep(i);
+        if (mesh_.is_deleted(ep)) continue;
+        faces.push_back(mesh_.face(ep));
+        if ((v = mesh_.mesh_vertex(ep)).is_valid())
+            vlocked_[v] = true;
+    }
+
+    for (unsigned int i = 0; i < mesh_.flines_size(); ++i)
+    {
+        Surface_mesh::FeatureLine l(i);
+        if (mesh_.is_deleted(l)) continue;
+        if ((v = mesh_.mesh_head(l)).is_valid()) vlocked_[v] = true;
+        if ((v = mesh_.mesh_tail(l)).is_valid()) vlocked_[v] = true;
+    }
+
+    for (unsigned int i = 0; i < faces.size(); ++i)
+    {
+        f = faces[i];
+        if (!f.is_valid() || f.idx() >= (int)mesh_.faces_size() || mesh_.is_deleted(f))
+            continue;
+
+        vf_it = vf_end = mesh_.vertices(f);
+        do
+        {
+            vlocked_[*vf_it] = true;
+        } while (++vf_it != vf_end);
+    }
+
+
+    // quadrics: planes of the incident faces, plus planes perpendicular to
+    // the faces along boundary and feature edges. each vertex only writes
+    // its own quadric.
+    const int nv = mesh_.vertices_size();
+
+#pragma omp parallel for
+    for (int i = 0; i < nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+        Surface_mesh::Halfedge h;
+        Surface_mesh::Edge e;
+        Quadric q;
+        Point n, d;
+
+        if (mesh_.is_deleted(v)) continue;
+
+        vh_it = vh_end = mesh_.halfedges(v);
+        if (vh_it) do
+        {
+            h = *vh_it;
+            e = mesh_.edge(h);
+
+            if (!mesh_.is_boundary(h))
+            {
+                q += Quadric(mesh_.compute_face_normal(mesh_.face(h)), points_[v]);
+            }
+
+            if (efeature_[e] || mesh_.is_boundary(e))
+            {
+                d = points_[mesh_.to_vertex(h)] - points_[v];
+                for (int j = 0; j < 2; ++j)
+                {
+                    h = mesh_.halfedge(e, j);
+                    if (mesh_.is_boundary(h)) continue;
+
+                    n = cross(d, mesh_.compute_face_normal(mesh_.face(h)));
+                    if (norm(n) > 0.0)
+                        q += Quadric(n.normalize(), points_[v]);
+                }
+            }
+        } while (++vh_it != vh_end);
+
+        vquadric_[v] = q;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Decimater::
+postprocessing()
+{
+    // remove properties
+    mesh_.remove_vertex_property(vlocked_);
+    mesh_.remove_vertex_property(vquadric_);
+
+    mesh_.garbage_collection();
+
+    // curvature cached for the input does not describe the result
+    Sizing_field(mesh_).clear_cache();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+decimate_queue(unsigned int n_faces)
+{
+    const unsigned int nf = mesh_.n_faces();
+    if (nf <= n_faces) return true;
+
+    std::priority_queue<Collapse_entry> queue;
+    std::vector<unsigned int> version(mesh_.vertices_size(), 0);
+    std::vector<Surface_mesh::Vertex> ring;
+    Surface_mesh::Vertex_around_vertex_circulator vv_it, vv_end;
+    Surface_mesh::Halfedge h;
+    Surface_mesh::Vertex v, v1;
+    unsigned int i, n_collapses(0);
+    double cost;
+
+
+    // initial candidates
+    for (Surface_mesh::Vertex_iterator v_it = mesh_.vertices_begin(); v_it != mesh_.vertices_end(); ++v_it)
+    {
+        if (best_collapse(*v_it, cost).is_valid())
+            queue.push(Collapse_entry(cost, *v_it, 0));
+    }
+
+
+    // cheapest first
+    while (!queue.empty() && mesh_.n_faces() > n_faces)
+    {
+        Collapse_entry entry = queue.top();
+        queue.pop();
+
+        v = entry.vertex;
+        if (mesh_.is_deleted(v) || entry.version != version[v.idx()])
+            continue;
+
+        // changes beyond the one-ring might have made it illegal since,
+        // requeue with the current best collapse
+        h = best_collapse(v, cost);
+        if (!h.is_valid())
+            continue;
+        if (cost > entry.cost)
+        {
+            queue.push(Collapse_entry(cost, v, ++version[v.idx()]));
+            continue;
+        }
+
+        v1 = mesh_.to_vertex(h);
+        collapse(h);
+        max_cost_ = std::max(max_cost_, cost);
+
+
+        // v1 and its neighbors have a new one-ring or a new quadric
+        ring.clear();
+        ring.push_back(v1);
+        vv_it = vv_end = mesh_.vertices(v1);
+        if (vv_it) do
+        {
+            ring.push_back(*vv_it);
+        } while (++vv_it != vv_end);
+
+        for (i = 0; i < ring.size(); ++i)
+        {
+            ++version[ring[i].idx()];
+            if (best_collapse(ring[i], cost).is_valid())
+                queue.push(Collapse_entry(cost, ring[i], version[ring[i].idx()]));
+        }
+
+
+        if (++n_collapses % 10000 == 0 &&
+            !report("collapse", float(nf - mesh_.n_faces()) / float(nf - n_faces)))
+            return false;
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+decimate_parallel(unsigned int n_faces)
+{
+    const unsigned int nf = mesh_.n_faces();
+    if (nf <= n_faces) return true;
+
+    const int nv = mesh_.vertices_size();
+    std::vector<Surface_mesh::Halfedge> best(nv);
+    std::vector<double> cost(nv);
+    std::vector<char> dirty(nv, 1);
+    std::vector<int> candidates;
+    std::vector<Surface_mesh::Vertex> region;
+    Surface_mesh::Vertex_around_vertex_circulator vv_it, vv_end;
+    unsigned int i, n, n_collapses;
+
+    vbatch_.assign(nv, 0);
+    batch_ = 0;
+
+
+    // one round evaluates the dirty vertices in parallel, then applies the
+    // cheapest collapses whose one-rings do not overlap
+    while (mesh_.n_faces() > n_faces)
+    {
+        ++batch_;
+
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int j = 0; j < nv; ++j)
+        {
+            if (dirty[j])
+            {
+                best[j] = best_collapse(Surface_mesh::Vertex(j), cost[j]);
+                dirty[j] = 0;
+            }
+        }
+
+        candidates.clear();
+        for (int j = 0; j < nv; ++j)
+            if (best[j].is_valid())
+                candidates.push_back(j);
+
+        // multiple choice: only the cheaper quarter may be collapsed, the
+        // others have to compete again with updated costs next round
+        n = std::max(1u, (unsigned int)candidates.size() / 4);
+        if (n < candidates.size())
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + n, candidates.end(),
+                             [&cost](int a, int b) { return cost[a] < cost[b]; });
+            candidates.resize(n);
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [&cost](int a, int b) { return cost[a] < cost[b]; });
+
+
+        // neither the one-ring of a collapsed vertex nor the quadric of
+        // its target changes before the next round, the costs stay valid.
+        // afterwards the claimed vertices and their neighbors are dirty:
+        // their one-ring, quadric or the link condition changed.
+        n_collapses = 0;
+        for (i = 0; i < candidates.size() && mesh_.n_faces() > n_faces; ++i)
+        {
+            Surface_mesh::Vertex v(candidates[i]);
+
+            region.clear();
+            region.push_back(v);
+            vv_it = vv_end = mesh_.vertices(v);
+            do
+            {
+                region.push_back(*vv_it);
+            } while (++vv_it != vv_end);
+
+            if (claim(region))
+            {
+                collapse(best[v.idx()]);
+                max_cost_ = std::max(max_cost_, cost[v.idx()]);
+                ++n_collapses;
+
+                dirty[v.idx()] = 1;
+                for (unsigned int k = 1; k < region.size(); ++k)
+                {
+                    dirty[region[k].idx()] = 1;
+                    vv_it = vv_end = mesh_.vertices(region[k]);
+                    do
+                    {
+                        dirty[(*vv_it).idx()] = 1;
+                    } while (++vv_it != vv_end);
+                }
+            }
+        }
+
+        if (!n_collapses)
+            break;
+
+        if (!report("collapse", float(nf - mesh_.n_faces()) / float(nf - n_faces)))
+            return false;
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Decimater::
+collapse(Surface_mesh::Halfedge h)
+{
+    const Surface_mesh::Vertex v0 = mesh_.from_vertex(h);
+    const Surface_mesh::Vertex v1 = mesh_.to_vertex(h);
+
+    vquadric_[v1] += vquadric_[v0];
+    mesh_.collapse(h);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+is_collapse_legal(Surface_mesh::Halfedge h)
+{
+    const Surface_mesh::Vertex v0 = mesh_.from_vertex(h);
+    const Surface_mesh::Vertex v1 = mesh_.to_vertex(h);
+    const Surface_mesh::Edge   e  = mesh_.edge(h);
+    const Surface_mesh::Halfedge o = mesh_.opposite_halfedge(h);
+
+    if (vlocked_[v0])
+        return false;
+
+    // boundary rules: boundary vertices only move along the boundary
+    if (mesh_.is_boundary(v0) && !(mesh_.is_boundary(v1) && mesh_.is_boundary(e)))
+        return false;
+
+    // feature rules: feature vertices only move along the feature line, the
+    // other two edges removed by the collapse must not be features
+    if (vfeature_[v0])
+    {
+        if (!vfeature_[v1] || !efeature_[e])
+            return false;
+        if (!mesh_.is_boundary(h) && efeature_[mesh_.edge(mesh_.prev_halfedge(h))])
+            return false;
+        if (!mesh_.is_boundary(o) && efeature_[mesh_.edge(mesh_.next_halfedge(o))])
+            return false;
+    }
+
+    // topological rules
+    return mesh_.is_collapse_ok(h);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+is_geometry_ok(Surface_mesh::Halfedge h) const
+{
+    const Surface_mesh::Vertex v0 = mesh_.from_vertex(h);
+    const Surface_mesh::Vertex v1 = mesh_.to_vertex(h);
+    const Point& p0 = points_[v0];
+    const Point& p1 = points_[v1];
+
+    Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+    Surface_mesh::Vertex a, b;
+    Point n0, n1;
+
+    // faces around v0 that survive the collapse, with v0 moved to p1
+    vh_it = vh_end = mesh_.halfedges(v0);
+    do
+    {
+        if (mesh_.is_boundary(*vh_it)) continue;
+
+        a = mesh_.to_vertex(*vh_it);
+        b = mesh_.to_vertex(mesh_.next_halfedge(*vh_it));
+        if (a == v1 || b == v1) continue;
+
+        const Point& pa = points_[a];
+        const Point& pb = points_[b];
+
+        // degenerate or flipped
+        n0 = cross(pa - p0, pb - p0);
+        n1 = cross(pa - p1, pb - p1);
+        if (sqrnorm(n1) == 0.0)
+            return false;
+        if (dot(n0, n1) < min_cos_ * norm(n0) * norm(n1))
+            return false;
+
+        // needle or cap, unless it was already that bad
+        if (max_aspect_ratio_ > 0.0)
+        {
+            const Scalar r = geometry::aspect_ratio(p1, pa, pb);
+            if (r > max_aspect_ratio_ && r > geometry::aspect_ratio(p0, pa, pb))
+                return false;
+        }
+    } while (++vh_it != vh_end);
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Surface_mesh::Halfedge
+Decimater::
+best_collapse(Surface_mesh::Vertex v, double& cost)
+{
+    Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+    Surface_mesh::Halfedge best;
+    const double max_cost = (max_error_ > 0.0) ? max_error_ * max_error_
+                                               : std::numeric_limits<double>::max();
+    double c;
+
+    cost = std::numeric_limits<double>::max();
+
+    if (mesh_.is_deleted(v) || vlocked_[v])
+        return best;
+
+    vh_it = vh_end = mesh_.halfedges(v);
+    if (vh_it) do
+    {
+        if (!is_collapse_legal(*vh_it))
+            continue;
+
+        c = collapse_cost(*vh_it);
+        if (c < cost && c <= max_cost && is_geometry_ok(*vh_it))
+        {
+            cost = c;
+            best = *vh_it;
+        }
+    } while (++vh_it != vh_end);
+
+    return best;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Decimater::
+claim(const std::vector<Surface_mesh::Vertex>& region)
+{
+    unsigned int i;
+
+    for (i = 0; i < region.size(); ++i)
+        if (vbatch_[region[i].idx()] == batch_)
+            return false;
+
+    for (i = 0; i < region.size(); ++i)
+        vbatch_[region[i].idx()] = batch_;
+
+    return true;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,154 @@
+//=============================================================================
+
+#ifndef GRAPHENE_DECIMATER_H
+#define GRAPHENE_DECIMATER_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/decimation/Quadric.h>
+#include <graphene/utility/Progress.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Decimate to n_faces faces, stop earlier if the next collapse would move a
+/// vertex farther than max_error from the planes of the faces it replaces
+/// (0 means unlimited).
+/// returns false if stopped early through \c progress
+bool decimate(Surface_mesh& mesh,
+              unsigned int n_faces,
+              Scalar max_error=0.0,
+              bool parallel=false,
+              utility::Progress* progress=NULL);
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Quadric error decimation by halfedge collapses. The surviving vertex keeps
+/// its position, so feature lines and boundaries are never moved. Feature
+/// edges ("e:feature") are only collapsed along the line, feature corners and
+/// the vertices referenced by the feature line containers are locked.
+class Decimater
+{
+public:
+
+    // constructor
+    Decimater(Surface_mesh& mesh);
+
+    // collapse in rounds of independent collapses, candidates are evaluated
+    // in parallel (multiple choice instead of a global queue)
+    void set_parallel(bool parallel) { parallel_ = parallel; }
+
+    // report progress, stop when cancelled or out of time. the mesh is valid
+    // (but not fully decimated) after stopping.
+    void set_progress(utility::Progress* progress) { progress_ = progress; }
+
+    // stop before the quadric error (sum of squared distances to the merged
+    // planes) exceeds max_error^2, 0 disables
+    void set_max_error(Scalar max_error) { max_error_ = max_error; }
+
+    // reject collapses that rotate a face normal by more than degrees
+    void set_max_normal_deviation(Scalar degrees) { max_normal_deviation_ = degrees; }
+
+    // reject collapses creating triangles with a larger aspect ratio (unless
+    // they were worse before), 0 disables
+    void set_max_aspect_ratio(Scalar aspect) { max_aspect_ratio_ = aspect; }
+
+    // decimate to n_faces faces, false if stopped early
+    bool decimate(unsigned int n_faces);
+
+    // bound on the distance of the result to the input: square root of the
+    // largest quadric error of the collapses of the last decimate()
+    Scalar error() const { return sqrt(max_cost_); }
+
+
+private:
+
+    void preprocessing();
+    void postprocessing();
+
+    // forward to progress_, false if we should stop
+    bool report(const char* stage, float fraction);
+
+    bool decimate_queue(unsigned int n_faces);
+    bool decimate_parallel(unsigned int n_faces);
+
+    // collapse v0 into v1, accumulates the quadric
+    void collapse(Surface_mesh::Halfedge h);
+
+    // topology and feature rules for collapsing from(h) into to(h)
+    bool is_collapse_legal(Surface_mesh::Halfedge h);
+
+    // normal flip and aspect ratio test of the faces around from(h)
+    bool is_geometry_ok(Surface_mesh::Halfedge h) const;
+
+    // quadric error of moving from(h) to to(h)
+    double collapse_cost(Surface_mesh::Halfedge h) const
+    {
+        const Surface_mesh::Vertex v0 = mesh_.from_vertex(h);
+        const Surface_mesh::Vertex v1 = mesh_.to_vertex(h);
+        return (vquadric_[v0] + vquadric_[v1])(points_[v1]);
+    }
+
+    // cheapest legal collapse of v, invalid halfedge if there is none
+    Surface_mesh::Halfedge best_collapse(Surface_mesh::Vertex v, double& cost);
+
+    // claim vertices for the current batch, fails if one is already taken
+    bool claim(const std::vector<Surface_mesh::Vertex>& region);
+
+
+    // queue entry of decimate_queue(), outdated if version differs
+    struct Collapse_entry
+    {
+        Collapse_entry(double c, Surface_mesh::Vertex v, unsigned int ver)
+            : cost(c), vertex(v), version(ver) {}
+
+        // std::priority_queue pops the largest element: cheapest first
+        bool operator<(const Collapse_entry& rhs) const { return cost > rhs.cost; }
+
+        double                cost;
+        Surface_mesh::Vertex  vertex;
+        unsigned int          version;
+    };
+
+
+private:
+
+    Surface_mesh&  mesh_;
+
+    bool parallel_;
+    utility::Progress* progress_;
+    std::vector<unsigned int> vbatch_;
+    unsigned int batch_;
+
+    Scalar max_error_;
+    Scalar max_normal_deviation_;
+    Scalar max_aspect_ratio_;
+    Scalar min_cos_;
+    double max_cost_;
+
+    Surface_mesh::Vertex_property<Point>    points_;
+    Surface_mesh::Vertex_property<bool>     vfeature_;
+    Surface_mesh::Edge_property<bool>       efeature_;
+    Surface_mesh::Vertex_property<bool>     vlocked_;
+    Surface_mesh::Vertex_property<Quadric>  vquadric_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_DECIMATER_H
+//=============================================================================
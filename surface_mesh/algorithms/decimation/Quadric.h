@@ -0,0 +1,93 @@
+//=============================================================================
+
+#ifndef GRAPHENE_QUADRIC_H
+#define GRAPHENE_QUADRIC_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Error quadric of Garland and Heckbert: sum of squared distances to a set
+/// of planes, stored as the upper triangle of a symmetric 4x4 matrix. Entries
+/// are kept in double precision, they are sums over many planes.
+class Quadric
+{
+public:
+
+    /// zero quadric
+    Quadric()
+        : a_(0), b_(0), c_(0), d_(0), e_(0), f_(0), g_(0), h_(0), i_(0), j_(0)
+    {}
+
+    /// squared distance to the plane n*x + d = 0 (n normalized), times w
+    Quadric(const Point& n, Scalar d, Scalar w=1.0)
+    {
+        const double a = n[0], b = n[1], c = n[2];
+        a_ = w*a*a;  b_ = w*a*b;  c_ = w*a*c;  d_ = w*a*d;
+                     e_ = w*b*b;  f_ = w*b*c;  g_ = w*b*d;
+                                  h_ = w*c*c;  i_ = w*c*d;
+                                               j_ = w*d*d;
+    }
+
+    /// squared distance to the plane through p with normal n, times w
+    Quadric(const Point& n, const Point& p, Scalar w=1.0)
+    {
+        *this = Quadric(n, -dot(n, p), w);
+    }
+
+
+    Quadric& operator+=(const Quadric& q)
+    {
+        a_ += q.a_;  b_ += q.b_;  c_ += q.c_;  d_ += q.d_;  e_ += q.e_;
+        f_ += q.f_;  g_ += q.g_;  h_ += q.h_;  i_ += q.i_;  j_ += q.j_;
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& q) const
+    {
+        Quadric r(*this);
+        return r += q;
+    }
+
+    Quadric& operator*=(double s)
+    {
+        a_ *= s;  b_ *= s;  c_ *= s;  d_ *= s;  e_ *= s;
+        f_ *= s;  g_ *= s;  h_ *= s;  i_ *= s;  j_ *= s;
+        return *this;
+    }
+
+
+    /// evaluate p^T Q p with homogeneous p = (x,y,z,1)
+    double operator()(const Point& p) const
+    {
+        const double x = p[0], y = p[1], z = p[2];
+        return a_*x*x + 2.0*b_*x*y + 2.0*c_*x*z + 2.0*d_*x
+                      +     e_*y*y + 2.0*f_*y*z + 2.0*g_*y
+                                   +     h_*z*z + 2.0*i_*z
+                                                +     j_;
+    }
+
+
+private:
+
+    double a_, b_, c_, d_, e_, f_, g_, h_, i_, j_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_QUADRIC_H
+//=============================================================================
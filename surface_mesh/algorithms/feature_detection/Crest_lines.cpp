@@ -0,0 +1,392 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/feature_detection/Crest_lines.h>
+#include <graphene/surface_mesh/data_structure/Feature_line_builder.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+namespace {
+
+
+// zero crossing of the extremality coefficient on an edge
+struct Crossing
+{
+    Point   point;
+    Scalar  curvature;
+    bool    valid;
+
+    Crossing() : curvature(0), valid(false) {}
+};
+
+
+// the two crossed edges of a face, -1 if none
+struct Segment
+{
+    int e0, e1;
+
+    Segment() : e0(-1), e1(-1) {}
+};
+
+
+// principal direction d in the tangent plane of normal n. the tensor
+// confuses the normal with the direction of the vanishing curvature on
+// cylindric parts, then the direction is orthogonal to the other one, o.
+Direction tangent_direction(const Normal& n, const Direction& d, const Direction& o)
+{
+    Direction t = d - dot(d, n) * n;
+    if (norm(t) > 0.5)
+        return normalize(t);
+
+    t = cross(n, o - dot(o, n) * n);
+    return (norm(t) > FLT_MIN) ? normalize(t) : t;
+}
+
+
+// crossing on the edge (i,j) of a ridge (sign 1: k is the maximum curvature,
+// positive, dominant and maximal along d) or ravine (sign -1: k is the
+// minimum curvature, negative, dominant and minimal along d). o is the other
+// principal curvature.
+bool edge_crossing(const Point& pi, const Point& pj,
+                   Scalar ki, Scalar kj, Scalar oi, Scalar oj,
+                   const Direction& di, Direction dj,
+                   Scalar ei, Scalar ej, Scalar sign,
+                   Crossing& c)
+{
+    if (sign*ki <= fabs(oi) || sign*kj <= fabs(oj))
+        return false;
+
+    // principal directions have no orientation, e changes sign with d
+    if (dot(di, dj) < 0)
+    {
+        dj = -dj;
+        ej = -ej;
+    }
+
+    if (ei*ej >= 0)
+        return false;
+
+    // extremum of k: e decreases (ridge) or increases (ravine) along d
+    const Point u = pj - pi;
+    if (sign * (ej - ei) * dot(u, di + dj) >= 0)
+        return false;
+
+    const Scalar t = ei / (ei - ej);
+    c.point     = pi + t * u;
+    c.curvature = (1-t) * ki + t * kj;
+    c.valid     = true;
+
+    return true;
+}
+
+
+// connect the crossings within each face. of three crossings the weakest
+// is left out.
+void connect(const Surface_mesh& mesh, const std::vector<Crossing>& crossings,
+             std::vector<Segment>& segments)
+{
+    const int nf = mesh.faces_size();
+    segments.assign(nf, Segment());
+
+#pragma omp parallel for
+    for (int i=0; i<nf; ++i)
+    {
+        Surface_mesh::Face f(i);
+        if (mesh.is_deleted(f)) continue;
+
+        int e[3], n = 0;
+        for (auto h : mesh.halfedges(f))
+        {
+            int k = mesh.edge(h).idx();
+            if (crossings[k].valid && n < 3)
+                e[n++] = k;
+        }
+
+        if (n == 3)
+        {
+            int weakest = 0;
+            for (int j=1; j<3; ++j)
+                if (fabs(crossings[e[j]].curvature) < fabs(crossings[e[weakest]].curvature))
+                    weakest = j;
+            e[weakest] = e[2];
+            n = 2;
+        }
+
+        if (n == 2)
+        {
+            segments[i].e0 = e[0];
+            segments[i].e1 = e[1];
+        }
+    }
+}
+
+
+// trace the segments into lines, add the lines with enough segments and
+// strength to builder. returns the lengths of the added lines.
+void trace(Feature_line_builder& builder,
+           const std::vector<Crossing>& crossings,
+           const std::vector<Segment>& segments,
+           unsigned int min_segments, Scalar threshold, bool is_ridge,
+           std::vector<Scalar>& lengths)
+{
+    const int ne = crossings.size();
+    const int nf = segments.size();
+
+    // every crossing has at most two neighbours, one per face of its edge
+    std::vector<int> next(2*ne, -1), face(2*ne, -1);
+    for (int f=0; f<nf; ++f)
+    {
+        const int a = segments[f].e0, b = segments[f].e1;
+        if (a < 0) continue;
+
+        int sa = (next[2*a] < 0) ? 2*a : 2*a+1;
+        int sb = (next[2*b] < 0) ? 2*b : 2*b+1;
+        if (next[sa] >= 0 || next[sb] >= 0) continue;
+
+        next[sa] = b;  face[sa] = f;
+        next[sb] = a;  face[sb] = f;
+    }
+
+    std::vector<char>   visited(ne, 0);
+    std::vector<int>    nodes, faces;
+    std::vector<Point>  points;
+
+    // open lines first, starting at their ends, then the closed ones
+    for (int pass=0; pass<2; ++pass)
+    {
+        for (int start=0; start<ne; ++start)
+        {
+            if (visited[start] || next[2*start] < 0) continue;
+            if (pass == 0 && next[2*start+1] >= 0) continue;
+
+            nodes.clear();
+            faces.clear();
+            nodes.push_back(start);
+            visited[start] = 1;
+
+            for (int cur=start;;)
+            {
+                int s = 2*cur;
+                if (next[s] < 0 || visited[next[s]]) ++s;
+                if (next[s] < 0 || visited[next[s]]) break;
+
+                faces.push_back(face[s]);
+                cur = next[s];
+                nodes.push_back(cur);
+                visited[cur] = 1;
+            }
+
+            // close the loop through the face not used yet
+            bool closed = false;
+            if (pass == 1 && nodes.size() > 2)
+            {
+                const int last = nodes.back();
+                for (int s=2*last; s<2*last+2; ++s)
+                {
+                    if (next[s] == start && face[s] != faces.back())
+                    {
+                        faces.push_back(face[s]);
+                        closed = true;
+                    }
+                }
+            }
+
+            // length and strength
+            const unsigned int n = nodes.size();
+            Scalar length(0), strength(0);
+            for (unsigned int i=0; i<faces.size(); ++i)
+            {
+                const Crossing& a = crossings[nodes[i]];
+                const Crossing& b = crossings[nodes[(i+1) % n]];
+                const Scalar    l = distance(a.point, b.point);
+                length   += l;
+                strength += 0.5 * (fabs(a.curvature) + fabs(b.curvature)) * l;
+            }
+
+            if (faces.size() < min_segments || strength < threshold)
+                continue;
+
+            points.clear();
+            for (unsigned int i=0; i<n; ++i)
+                points.push_back(crossings[nodes[i]].point);
+
+            builder.add_line(points, faces, length, is_ridge, closed);
+            lengths.push_back(length);
+        }
+    }
+}
+
+
+} // anonymous namespace
+
+
+//-----------------------------------------------------------------------------
+
+
+Crest_lines::
+Crest_lines(Surface_mesh& mesh)
+    : mesh_(mesh), threshold_(1.0), min_segments_(3)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Crest_lines::
+extract(const Curvature_analyzer& analyzer)
+{
+    const int nv = mesh_.vertices_size();
+    const int ne = mesh_.edges_size();
+    const int nf = mesh_.faces_size();
+
+    Surface_mesh::Vertex_property<Point>     points = mesh_.vertex_property<Point>("v:point");
+    Surface_mesh::Vertex_property<Scalar>    kmax   = mesh_.vertex_property<Scalar>("v:max curvature");
+    Surface_mesh::Vertex_property<Scalar>    kmin   = mesh_.vertex_property<Scalar>("v:min curvature");
+    Surface_mesh::Vertex_property<Direction> dmax   = mesh_.vertex_property<Direction>("v:max direction");
+    Surface_mesh::Vertex_property<Direction> dmin   = mesh_.vertex_property<Direction>("v:min direction");
+
+
+    // principal curvatures, also for feature_extension()
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        if (mesh_.is_deleted(v)) continue;
+
+        const Normal n = mesh_.compute_vertex_normal(v);
+        kmax[v] = analyzer.max_curvature(v);
+        kmin[v] = analyzer.min_curvature(v);
+        dmax[v] = tangent_direction(n, analyzer.max_direction(v), analyzer.min_direction(v));
+        dmin[v] = tangent_direction(n, analyzer.min_direction(v), analyzer.max_direction(v));
+    }
+
+
+    // gradients of the principal curvatures per face, area weighted
+    std::vector<Vec3f>   gmax(nf), gmin(nf);
+    std::vector<Scalar>  area(nf, 0);
+
+#pragma omp parallel for
+    for (int i=0; i<nf; ++i)
+    {
+        Surface_mesh::Face f(i);
+        gmax[i] = gmin[i] = Vec3f(0,0,0);
+        if (mesh_.is_deleted(f) || mesh_.valence(f) != 3) continue;
+
+        Surface_mesh::Vertex v[3];
+        int k = 0;
+        for (auto w : mesh_.vertices(f))
+            v[k++] = w;
+
+        const Point& p0 = points[v[0]];
+        const Point& p1 = points[v[1]];
+        const Point& p2 = points[v[2]];
+
+        Normal n  = cross(p1-p0, p2-p0);
+        Scalar a2 = norm(n);
+        if (a2 < FLT_MIN) continue;
+        n /= a2;
+
+        // gradient of the linear interpolant, times twice the area
+        const Vec3f g0 = cross(n, p2-p1);
+        const Vec3f g1 = cross(n, p0-p2);
+        const Vec3f g2 = cross(n, p1-p0);
+
+        gmax[i] = kmax[v[0]]*g0 + kmax[v[1]]*g1 + kmax[v[2]]*g2;
+        gmin[i] = kmin[v[0]]*g0 + kmin[v[1]]*g1 + kmin[v[2]]*g2;
+        area[i] = a2;
+    }
+
+
+    // extremality coefficients from the averaged vertex gradients
+    std::vector<Scalar> emax(nv, 0), emin(nv, 0);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        if (mesh_.is_deleted(v) || mesh_.is_isolated(v)) continue;
+
+        Vec3f  g1(0,0,0), g2(0,0,0);
+        Scalar w(0);
+        for (auto f : mesh_.faces(v))
+        {
+            // area[] is twice the area, the weights cancel
+            g1 += gmax[f.idx()];
+            g2 += gmin[f.idx()];
+            w  += area[f.idx()];
+        }
+        if (w < FLT_MIN) continue;
+
+        emax[i] = dot(g1, dmax[v]) / w;
+        emin[i] = dot(g2, dmin[v]) / w;
+    }
+
+
+    // zero crossings on the edges
+    std::vector<Crossing> ridges(ne), ravines(ne);
+
+#pragma omp parallel for
+    for (int i=0; i<ne; ++i)
+    {
+        Surface_mesh::Edge e(i);
+        if (mesh_.is_deleted(e)) continue;
+
+        Surface_mesh::Vertex a = mesh_.vertex(e, 0);
+        Surface_mesh::Vertex b = mesh_.vertex(e, 1);
+
+        edge_crossing(points[a], points[b], kmax[a], kmax[b], kmin[a], kmin[b],
+                      dmax[a], dmax[b], emax[a.idx()], emax[b.idx()], 1, ridges[i]);
+        edge_crossing(points[a], points[b], kmin[a], kmin[b], kmax[a], kmax[b],
+                      dmin[a], dmin[b], emin[a.idx()], emin[b.idx()], -1, ravines[i]);
+    }
+
+
+    // segments per face, ridges and ravines traced concurrently into lines
+    std::vector<Segment> segments[2];
+    std::vector<Scalar>  lengths[2];
+    std::vector<Feature_line_builder> builders(2);
+
+    connect(mesh_, ridges,  segments[0]);
+    connect(mesh_, ravines, segments[1]);
+
+#pragma omp parallel for
+    for (int i=0; i<2; ++i)
+    {
+        trace(builders[i], (i == 0) ? ridges : ravines, segments[i],
+              min_segments_, threshold_, i == 0, lengths[i]);
+    }
+
+    const unsigned int n_lines = builders[0].n_lines() + builders[1].n_lines();
+    Feature_line_builder::commit(mesh_, builders);
+
+
+    // reference length of the line filters, as read_fld()
+    lengths[0].insert(lengths[0].end(), lengths[1].begin(), lengths[1].end());
+    if (!lengths[0].empty())
+    {
+        std::sort(lengths[0].begin(), lengths[0].end());
+        mesh_.average = lengths[0][lengths[0].size() / 20];
+    }
+
+    return n_lines;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
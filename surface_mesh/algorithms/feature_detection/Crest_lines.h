@@ -0,0 +1,69 @@
+//=============================================================================
+
+#ifndef GRAPHENE_CREST_LINES_H
+#define GRAPHENE_CREST_LINES_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Curvature.h>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Ridge and ravine lines of a triangle mesh from its principal curvatures
+/// (Ohtake, Belyaev, Seidel: Ridge-valley lines on meshes via implicit
+/// surface fitting, 2004), added as feature lines of the mesh.
+///
+/// The extremality coefficient e = <grad k, d> of the dominant principal
+/// curvature k along its direction d is computed per vertex. Its zero
+/// crossings on the edges where k has a maximum (ridges) or minimum
+/// (ravines) along d are connected within each face and traced into lines.
+/// Faces, vertices and edges are processed in parallel. Ridges and ravines
+/// are traced concurrently into one Feature_line_builder each, then added to
+/// the mesh in one commit. Lines whose strength, the integral of |k| along
+/// the line, is below the threshold are dropped.
+class Crest_lines
+{
+public:
+
+    /// constructor
+    Crest_lines(Surface_mesh& mesh);
+
+    /// minimum strength of a line, the integral of the absolute principal
+    /// curvature along it (dimensionless). default 1.
+    void set_threshold(Scalar threshold) { threshold_ = threshold; }
+
+    /// minimum number of segments of a line, default 3
+    void set_min_segments(unsigned int n) { min_segments_ = n; }
+
+    /// extract the lines from the curvature of analyzer, which has to be
+    /// computed by analyze_tensor(). Ridges are added before ravines. The
+    /// curvature is also stored in the vertex properties read from FLD
+    /// files ("v:max curvature", "v:min direction", ...). Returns the
+    /// number of lines added.
+    unsigned int extract(const Curvature_analyzer& analyzer);
+
+
+private:
+
+    Surface_mesh&  mesh_;
+    Scalar         threshold_;
+    unsigned int   min_segments_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_CREST_LINES_H
+//=============================================================================
@@ -0,0 +1,327 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/feature_detection/Line_simplifier.h>
+#include <graphene/surface_mesh/data_structure/Feature_graph.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+namespace {
+
+
+// new points of a line and the faces of its segments
+struct Line_result
+{
+    std::vector<Point>  points;
+    std::vector<int>    faces;
+    Scalar              length;
+    bool                changed;
+
+    Line_result() : length(0), changed(false) {}
+};
+
+
+// queue entry of simplify_line(), outdated if version differs
+struct Removal_entry
+{
+    Removal_entry(Scalar c, int i, unsigned int ver)
+        : cost(c), index(i), version(ver) {}
+
+    // std::priority_queue pops the largest element: cheapest first
+    bool operator<(const Removal_entry& rhs) const { return cost > rhs.cost; }
+
+    Scalar        cost;
+    int           index;
+    unsigned int  version;
+};
+
+
+// distance of p to the segment (a,b)
+Scalar segment_distance(const Point& p, const Point& a, const Point& b)
+{
+    const Point  d  = b - a;
+    const Scalar dd = dot(d, d);
+    Scalar t = (dd > 0) ? dot(p - a, d) / dd : 0;
+    t = std::min(Scalar(1), std::max(Scalar(0), t));
+    return distance(p, a + t * d);
+}
+
+
+// largest distance of the points strictly between i and j to segment (i,j)
+Scalar removal_cost(const Point* p, int i, int j)
+{
+    Scalar cost(0);
+    for (int k=i+1; k<j; ++k)
+        cost = std::max(cost, segment_distance(p[k], p[i], p[j]));
+    return cost;
+}
+
+
+// face index of the segment from point i of line l, -1 if none
+int face_index(const Feature_graph& graph, Surface_mesh::FeatureLine l, unsigned int i)
+{
+    return graph.face(l, i).idx();
+}
+
+
+// face of the chord from a to b that replaces the original segments first
+// to last of line l: the face of the one nearest to the chord midpoint
+int chord_face(const Feature_graph& graph, Surface_mesh::FeatureLine l,
+               unsigned int first, unsigned int last,
+               const Point& a, const Point& b)
+{
+    const Point* p = graph.points(l);
+    const Point  m = 0.5 * (a + b);
+
+    unsigned int nearest = first;
+    Scalar       dmin    = FLT_MAX;
+    for (unsigned int k=first; k<=last; ++k)
+    {
+        const Scalar d = segment_distance(m, p[k], p[k+1]);
+        if (d < dmin)
+        {
+            dmin    = d;
+            nearest = k;
+        }
+    }
+
+    return face_index(graph, l, nearest);
+}
+
+
+// copy the kept points of line l, each new segment lies in the face of the
+// original segment nearest to its midpoint
+void collect(const Feature_graph& graph, Surface_mesh::FeatureLine l,
+             const std::vector<int>& next, Line_result& result)
+{
+    const unsigned int n = graph.size(l);
+    const Point*       p = graph.points(l);
+
+    result.points.clear();
+    result.faces.clear();
+    result.length = 0;
+
+    for (int i=0; i>=0 && i<(int)n; i=next[i])
+    {
+        result.points.push_back(p[i]);
+        if (next[i] >= 0)
+        {
+            result.faces.push_back(chord_face(graph, l, i, next[i]-1, p[i], p[next[i]]));
+            result.length += distance(p[i], p[next[i]]);
+        }
+    }
+}
+
+
+void simplify_line(const Feature_graph& graph, Surface_mesh::FeatureLine l,
+                   Scalar max_error, Line_result& result)
+{
+    const int    n = graph.size(l);
+    const Point* p = graph.points(l);
+    if (n < 3) return;
+
+    std::vector<int>           prev(n), next(n);
+    std::vector<unsigned int>  version(n, 0);
+    std::priority_queue<Removal_entry> queue;
+
+    for (int i=0; i<n; ++i)
+    {
+        prev[i] = i-1;
+        next[i] = (i+1 < n) ? i+1 : -1;
+    }
+
+    for (int i=1; i+1<n; ++i)
+    {
+        Scalar cost = removal_cost(p, i-1, i+1);
+        if (cost <= max_error)
+            queue.push(Removal_entry(cost, i, 0));
+    }
+
+    int removed = 0;
+    while (!queue.empty())
+    {
+        Removal_entry entry = queue.top();
+        queue.pop();
+
+        const int i = entry.index;
+        if (entry.version != version[i])
+            continue;
+
+        const int a = prev[i], b = next[i];
+        next[a] = b;
+        prev[b] = a;
+        ++version[i];
+        ++removed;
+
+        // the neighbors span more of the original line now
+        if (a > 0)
+        {
+            Scalar cost = removal_cost(p, prev[a], b);
+            if (cost <= max_error)
+                queue.push(Removal_entry(cost, a, ++version[a]));
+            else
+                ++version[a];
+        }
+        if (b < n-1)
+        {
+            Scalar cost = removal_cost(p, a, next[b]);
+            if (cost <= max_error)
+                queue.push(Removal_entry(cost, b, ++version[b]));
+            else
+                ++version[b];
+        }
+    }
+
+    if (removed)
+    {
+        collect(graph, l, next, result);
+        result.changed = true;
+    }
+}
+
+
+void resample_line(const Feature_graph& graph, Surface_mesh::FeatureLine l,
+                   Scalar spacing, Line_result& result)
+{
+    const unsigned int n = graph.size(l);
+    const Point*       p = graph.points(l);
+    if (n < 2) return;
+
+    Scalar length(0);
+    for (unsigned int i=0; i+1<n; ++i)
+        length += distance(p[i], p[i+1]);
+
+    const unsigned int m = std::max(1, (int)ceil(length / spacing));
+    const Scalar       step = length / m;
+
+    result.points.clear();
+    result.faces.clear();
+    result.points.push_back(p[0]);
+
+    // original segment of each new point
+    std::vector<unsigned int> segment(1, 0);
+
+    // walk along the original segments, s is the arc length at p[i]
+    unsigned int i = 0;
+    Scalar       s = 0;
+    for (unsigned int j=1; j<m; ++j)
+    {
+        const Scalar t = j * step;
+        while (i+2 < n && s + distance(p[i], p[i+1]) < t)
+        {
+            s += distance(p[i], p[i+1]);
+            ++i;
+        }
+
+        const Scalar d = distance(p[i], p[i+1]);
+        const Scalar u = (d > 0) ? std::min(Scalar(1), (t - s) / d) : 0;
+        result.points.push_back(p[i] + u * (p[i+1] - p[i]));
+        segment.push_back(i);
+    }
+
+    result.points.push_back(p[n-1]);
+    segment.push_back(n-2);
+
+    for (unsigned int j=0; j+1<result.points.size(); ++j)
+        result.faces.push_back(chord_face(graph, l, segment[j], segment[j+1],
+                                          result.points[j], result.points[j+1]));
+
+    result.length = 0;
+    for (unsigned int j=0; j+1<result.points.size(); ++j)
+        result.length += distance(result.points[j], result.points[j+1]);
+
+    result.changed = true;
+}
+
+
+} // anonymous namespace
+
+
+//-----------------------------------------------------------------------------
+
+
+Line_simplifier::
+Line_simplifier(Surface_mesh& mesh)
+    : mesh_(mesh)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Line_simplifier::
+simplify(Scalar max_error)
+{
+    Feature_graph graph(mesh_);
+    const int nl = graph.n_lines();
+    std::vector<Line_result> results(nl);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<nl; ++i)
+        simplify_line(graph, Surface_mesh::FeatureLine(i), max_error, results[i]);
+
+    unsigned int removed = 0;
+    for (int i=0; i<nl; ++i)
+    {
+        if (!results[i].changed) continue;
+
+        Surface_mesh::FeatureLine l(i);
+        removed += graph.size(l) - results[i].points.size();
+        mesh_.set_feature_line(l, results[i].points, results[i].faces, results[i].length);
+    }
+
+    return removed;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Line_simplifier::
+resample(Scalar spacing)
+{
+    Feature_graph graph(mesh_);
+    const int nl = graph.n_lines();
+    std::vector<Line_result> results(nl);
+
+    if (spacing <= 0)
+        return 0;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<nl; ++i)
+        resample_line(graph, Surface_mesh::FeatureLine(i), spacing, results[i]);
+
+    unsigned int points = 0;
+    for (int i=0; i<nl; ++i)
+    {
+        if (!results[i].changed) continue;
+
+        mesh_.set_feature_line(Surface_mesh::FeatureLine(i), results[i].points,
+                               results[i].faces, results[i].length);
+        points += results[i].points.size();
+    }
+
+    return points;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,63 @@
+//=============================================================================
+
+#ifndef GRAPHENE_LINE_SIMPLIFIER_H
+#define GRAPHENE_LINE_SIMPLIFIER_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Simplification and resampling of the feature lines of a mesh.
+///
+/// Each line is processed independently and in parallel on a Feature_graph
+/// copy, the results are written back to the feature containers of the mesh
+/// by Surface_mesh::set_feature_line(), which also updates the line length.
+/// Head and tail of a line keep their position and feature vertex.
+///
+/// New segments are straight chords between points of the original line,
+/// they are not projected onto the surface and may cut through it by up to
+/// the tolerance. Each one is assigned the face of the original segment
+/// nearest to its midpoint.
+class Line_simplifier
+{
+public:
+
+    /// constructor
+    Line_simplifier(Surface_mesh& mesh);
+
+    /// remove points from all lines, the one whose removal changes its line
+    /// least first (Visvalingam-Whyatt with a heap). a point is only removed
+    /// if the removed points stay within max_error of the new segment, so
+    /// the simplified line is within max_error of the original one, which
+    /// lies on the surface. returns the number of removed points.
+    unsigned int simplify(Scalar max_error);
+
+    /// resample all lines with points equally spaced in arc length along the
+    /// original line, at most spacing apart. returns the number of points of
+    /// all lines afterwards.
+    unsigned int resample(Scalar spacing);
+
+
+private:
+
+    Surface_mesh&  mesh_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_LINE_SIMPLIFIER_H
+//=============================================================================
@@ -0,0 +1,109 @@
+//== INCLUDES =================================================================
+
+#include "Parameterization.h"
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Laplace.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+bool harmonic_parameterization(Surface_mesh& mesh)
+{
+    const int nv = mesh.vertices_size();
+
+
+    // find the boundary loop
+    Surface_mesh::Halfedge_iterator hit, hend=mesh.halfedges_end();
+    Surface_mesh::Halfedge hb;
+    unsigned int n_boundary = 0;
+    for (hit=mesh.halfedges_begin(); hit!=hend; ++hit)
+    {
+        if (mesh.is_boundary(*hit))
+        {
+            if (!hb.is_valid()) hb = *hit;
+            ++n_boundary;
+        }
+    }
+    if (!hb.is_valid())
+        return false;
+
+    std::vector<Surface_mesh::Vertex> loop;
+    std::vector<double>               length;
+    double total = 0.0;
+    Surface_mesh::Halfedge h = hb;
+    do
+    {
+        loop.push_back(mesh.to_vertex(h));
+        length.push_back(total);
+        total += mesh.edge_length(mesh.edge(h));
+        h = mesh.next_halfedge(h);
+    }
+    while (h != hb && loop.size() <= n_boundary);
+
+    // more than one loop (or a non-manifold one)
+    if (loop.size() != n_boundary || total <= 0.0)
+        return false;
+
+
+    // boundary on the circle, everything else free
+    std::vector<bool>   fixed(nv, false);
+    std::vector<double> u(nv, 0.5), v(nv, 0.5);
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex vv(i);
+        fixed[i] = (mesh.is_deleted(vv) || mesh.is_isolated(vv));
+    }
+    for (unsigned int i=0; i<loop.size(); ++i)
+    {
+        const double a = 2.0 * M_PI * length[i] / total;
+        const int    k = loop[i].idx();
+        fixed[k] = true;
+        u[k] = 0.5 + 0.5 * cos(a);
+        v[k] = 0.5 - 0.5 * sin(a); // boundary halfedges run clockwise
+    }
+
+
+    // -L x = 0 with Dirichlet boundary
+    Sparse_matrix L;
+    cotan_laplace(mesh, L);
+    L.scale(-1.0);
+
+    std::vector<double> bu(nv, 0.0), bv(nv, 0.0);
+    L.constrain_rhs(fixed, u, bu);
+    L.constrain_rhs(fixed, v, bv);
+    L.constrain(fixed);
+
+    Sparse_cholesky solver;
+    if (!solver.factorize(L))
+        return false;
+
+#pragma omp parallel sections
+    {
+#pragma omp section
+        solver.solve(bu, u);
+#pragma omp section
+        solver.solve(bv, v);
+    }
+
+
+    Surface_mesh::Vertex_property<Texture_coordinate> tex =
+        mesh.vertex_property<Texture_coordinate>("v:texcoord");
+    for (int i=0; i<nv; ++i)
+    {
+        tex[Surface_mesh::Vertex(i)] = Texture_coordinate(u[i], v[i], 0.0);
+    }
+
+    return true;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,34 @@
+//=============================================================================
+
+#ifndef GRAPHENE_PARAMETERIZATION_H
+#define GRAPHENE_PARAMETERIZATION_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//=============================================================================
+
+/** Harmonic parameterization of a topological disk: the boundary loop is
+    mapped by arc length to the circle of radius 0.5 around (0.5,0.5), the
+    interior vertices solve the cotan Laplace equation (both coordinates in
+    parallel, sharing one factorization). The result is stored in vertex
+    property "v:texcoord". Returns false if the mesh does not have exactly
+    one boundary loop or the system could not be factorized. */
+bool harmonic_parameterization(Surface_mesh& mesh);
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_PARAMETERIZATION_H
+//=============================================================================
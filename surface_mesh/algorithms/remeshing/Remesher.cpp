@@ -2,13 +2,14 @@
 
 #include "Remesher.h"
 #include <graphene/surface_mesh/algorithms/surface_mesh_tools/Curvature.h>
-#include <graphene/geometry/bary_coord.h>
 #include <graphene/geometry/distance_point_triangle.h>
 #include <graphene/utility/Stop_watch.h>
 #include <graphene/macros.h>
 
 #include <float.h>
 #include <cmath>
+#include <queue>
+#include <limits>
 
 #define NORMAL_BASED  0
 
@@ -24,26 +25,60 @@ namespace graphene {
 		//== IMPLEMENTATION ==========================================================
 
 
-		void uniform_remeshing(Surface_mesh& mesh,
+		bool uniform_remeshing(Surface_mesh& mesh,
 			Scalar edge_length,
 			unsigned int iterations,
-			bool use_projection)
+			bool use_projection,
+			bool parallel,
+			utility::Progress* progress)
 		{
-			Remesher(mesh).remesh(edge_length, iterations, use_projection);
+			Remesher remesher(mesh);
+			remesher.set_parallel(parallel);
+			remesher.set_progress(progress);
+			return remesher.remesh(edge_length, iterations, use_projection);
 		}
 
 
 		//-----------------------------------------------------------------------------
 
 
-		void adaptive_remeshing(Surface_mesh& mesh,
+		bool adaptive_remeshing(Surface_mesh& mesh,
 			Scalar min_edge_length,
 			Scalar max_edge_length,
 			Scalar approx_error,
 			unsigned int iterations,
-			bool use_projection)
+			bool use_projection,
+			bool parallel,
+			utility::Progress* progress)
 		{
-			Remesher(mesh).remesh(min_edge_length,
+			Remesher remesher(mesh);
+			remesher.set_parallel(parallel);
+			remesher.set_progress(progress);
+			return remesher.remesh(min_edge_length,
+				max_edge_length,
+				approx_error,
+				iterations,
+				use_projection);
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		bool anisotropic_remeshing(Surface_mesh& mesh,
+			Scalar min_edge_length,
+			Scalar max_edge_length,
+			Scalar approx_error,
+			unsigned int iterations,
+			bool use_projection,
+			bool parallel,
+			utility::Progress* progress)
+		{
+			Remesher remesher(mesh);
+			remesher.set_parallel(parallel);
+			remesher.set_progress(progress);
+			remesher.set_anisotropic(true);
+			return remesher.remesh(min_edge_length,
 				max_edge_length,
 				approx_error,
 				iterations,
@@ -56,7 +91,7 @@ namespace graphene {
 
 		Remesher::
 			Remesher(Surface_mesh& mesh)
-			: mesh_(mesh), refmesh_(NULL), kD_tree_(NULL)
+			: mesh_(mesh), reference_(NULL), parallel_(false), progress_(NULL), batch_(0), gradation_(0.0), anisotropic_(false), max_aspect_(10.0)
 		{
 			points_ = mesh_.vertex_property<Point>("v:point");
 			vnormal_ = mesh_.vertex_property<Point>("v:normal");
@@ -75,7 +110,7 @@ namespace graphene {
 		//-----------------------------------------------------------------------------
 
 
-		void
+		bool
 			Remesher::
 			remesh(Scalar edge_length,
 				unsigned int iterations,
@@ -85,68 +120,14 @@ namespace graphene {
 			use_projection_ = use_projection;
 			target_edge_length_ = edge_length;
 
-			double t_pre(0);
-			double t_split(0);
-			double t_collapse(0);
-			double t_flip(0);
-			double t_smooth(0);
-			double t_caps(0);
-			Stop_watch timer;
-
-			timer.start();
-			preprocessing();
-			timer.stop();
-			t_pre = timer.elapsed();
-
-
-			for (unsigned int i = 0; i<iterations; ++i)
-			{
-				timer.start();
-				split_long_edges();
-				timer.stop();
-				t_split += timer.elapsed();
-
-				mesh_.update_vertex_normals();
-
-				timer.start();
-				collapse_short_edges();
-				timer.stop();
-				t_collapse += timer.elapsed();
-
-				timer.start();
-				flip_edges();
-				timer.stop();
-				t_flip += timer.elapsed();
-
-				timer.start();
-				tangential_smoothing(5);
-				timer.stop();
-				t_smooth += timer.elapsed();
-			}
-
-			timer.start();
-			remove_caps();
-			timer.stop();
-			t_caps += timer.elapsed();
-
-			postprocessing();
-
-
-			LOG(Log_info) << "Remeshing times:\n";
-			LOG(Log_info) << "preproc:  " << t_pre << "ms\n";
-			LOG(Log_info) << "sp lit:    " << t_split << "ms\n";
-			LOG(Log_info) << "collapse: " << t_collapse << "ms\n";
-			LOG(Log_info) << "flip:     " << t_flip << "ms\n";
-			LOG(Log_info) << "smooth:   " << t_smooth << "ms\n";
-			LOG(Log_info) << "caps:     " << t_caps << "ms\n";
-			LOG(Log_info) << std::endl;
+			return iterate(iterations);
 		}
 
 
 		//-----------------------------------------------------------------------------
 
 
-		void
+		bool
 			Remesher::
 			remesh(Scalar min_edge_length,
 				Scalar max_edge_length,
@@ -160,6 +141,17 @@ namespace graphene {
 			approx_error_ = approx_error;
 			use_projection_ = use_projection;
 
+			return iterate(iterations);
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		bool
+			Remesher::
+			iterate(unsigned int iterations)
+		{
 			double t_pre(0);
 			double t_split(0);
 			double t_collapse(0);
@@ -167,6 +159,7 @@ namespace graphene {
 			double t_smooth(0);
 			double t_caps(0);
 			Stop_watch timer;
+			bool ok = report("preprocessing", 0.0);
 
 
 			timer.start();
@@ -175,29 +168,38 @@ namespace graphene {
 			t_pre = timer.elapsed();
 
 
-			for (unsigned int i = 0; i<iterations; ++i)
+			// every stage leaves a valid mesh, so we can stop after each one
+			const float step = 1.0 / (4 * std::max(iterations, 1u));
+			for (unsigned int i = 0; ok && i<iterations; ++i)
 			{
 				timer.start();
-				split_long_edges();
+				parallel_ ? split_long_edges_parallel() : split_long_edges();
 				timer.stop();
 				t_split += timer.elapsed();
+				if (!(ok = report("split", (4 * i + 1) * step))) break;
 
 				mesh_.update_vertex_normals();
 
 				timer.start();
-				collapse_short_edges();
+				parallel_ ? collapse_short_edges_parallel() : collapse_short_edges();
 				timer.stop();
 				t_collapse += timer.elapsed();
+				if (!(ok = report("collapse", (4 * i + 2) * step))) break;
 
 				timer.start();
-				flip_edges();
+				parallel_ ? flip_edges_parallel() : flip_edges();
 				timer.stop();
 				t_flip += timer.elapsed();
+				if (!(ok = report("flip", (4 * i + 3) * step))) break;
 
 				timer.start();
 				tangential_smoothing(5);
 				timer.stop();
 				t_smooth += timer.elapsed();
+
+				// the intermediate mesh may be drawn while we wait in report()
+				mesh_.geometry_changed();
+				ok = report("smooth", (4 * i + 4) * step);
 			}
 
 			timer.start();
@@ -216,7 +218,24 @@ namespace graphene {
 			LOG(Log_info) << "flip:     " << t_flip << "ms\n";
 			LOG(Log_info) << "smooth:   " << t_smooth << "ms\n";
 			LOG(Log_info) << "caps:     " << t_caps << "ms\n";
+			if (!ok)
+			{
+				LOG(Log_info) << "stopped early\n";
+			}
 			LOG(Log_info) << std::endl;
+
+			return ok;
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		bool
+			Remesher::
+			report(const char* stage, float fraction)
+		{
+			return progress_ ? progress_->report(stage, fraction) : true;
 		}
 
 
@@ -350,91 +369,26 @@ namespace graphene {
 			}
 			else
 			{
-				// compute curvature for all mesh vertices, using cotan or Cohen-Steiner
-				// do 2 post-smoothing steps to get a smoother sizing field
-				Curvature_analyzer curv(mesh_);
-				//curv.analyze(1);
-				curv.analyze_tensor(1, true);
-
+				// curvature is cached on the mesh, computed in parallel if outdated
+				Sizing_field(mesh_).compute(vsizing_, vfeature_, approx_error_,
+				                            min_edge_length_, max_edge_length_,
+				                            gradation_);
 
-				for (Surface_mesh::Vertex_iterator vit = mesh_.vertices_begin(); vit != mesh_.vertices_end(); ++vit)
+				// the metric is carried along by splits, not projected
+				if (anisotropic_)
 				{
-					// maximum absolute curvature
-					Scalar c = curv.max_abs_curvature(*vit);
-
-
-					// curvature of feature vertices: average of non-feature neighbors
-					if (vfeature_[*vit])
-					{
-						Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
-						Surface_mesh::Vertex v;
-						Scalar w, ww = 0.0;
-						c = 0.0;
-
-						vhit = vhend = mesh_.halfedges(*vit);
-						if (vhit) do
-						{
-							v = mesh_.to_vertex(*vhit);
-							if (!vfeature_[v])
-							{
-								w = std::max(0.0, cotan_weight(mesh_, mesh_.edge(*vhit)));
-								ww += w;
-								c += w * curv.max_abs_curvature(v);
-							}
-						} while (++vhit != vhend);
-
-						c /= ww;
-					}
-
-
-					// get edge length from curvature
-					const Scalar r = 1.0 / c;
-					const Scalar e = approx_error_;
-					Scalar h;
-					if (e < r)
-					{
-						// see mathworld: "circle segment" and "equilateral triangle"
-						//h = sqrt(2.0*r*e-e*e) * 3.0 / sqrt(3.0);
-						h = sqrt(6.0*e*r - 3.0*e*e); // simplified...
-					}
-					else
-					{
-						// this does not really make sense
-						h = e * 3.0 / sqrt(3.0);
-					}
-
-
-					// clamp to min. and max. edge length
-					if (h < min_edge_length_) h = min_edge_length_;
-					else if (h > max_edge_length_) h = max_edge_length_;
-
-
-					// store target edge length
-					vsizing_[*vit] = h;
+					vmetric_ = mesh_.add_vertex_property<Sizing_metric>("v:metric");
+					Sizing_field(mesh_).compute_metric(vmetric_, vfeature_, approx_error_,
+					                                   min_edge_length_, max_edge_length_,
+					                                   max_aspect_);
 				}
 			}
 
 
 			if (use_projection_)
 			{
-				// build reference mesh
-				refmesh_ = new Surface_mesh();
-				refmesh_->assign(mesh_);
-				refmesh_->update_vertex_normals();
-				refpoints_ = refmesh_->vertex_property<Point>("v:point");
-				refnormals_ = refmesh_->vertex_property<Point>("v:normal");
-
-
-				// copy sizing field from mesh_
-				refsizing_ = refmesh_->add_vertex_property<Scalar>("v:sizing");
-				for (Surface_mesh::Vertex_iterator vit = refmesh_->vertices_begin(); vit != refmesh_->vertices_end(); ++vit)
-				{
-					refsizing_[*vit] = vsizing_[*vit];
-				}
-
-
-				// build BSP
-				kD_tree_ = new Triangle_kD_tree(*refmesh_, 0);
+				// snapshot positions, normals and sizing field for projection
+				reference_ = new Reference_surface(mesh_, vsizing_);
 			}
 		}
 
@@ -446,17 +400,23 @@ namespace graphene {
 			Remesher::
 			postprocessing()
 		{
-			// delete BSP and reference mesh
+			// delete reference surface
 			if (use_projection_)
 			{
-				delete kD_tree_;
-				delete refmesh_;
+				delete reference_;
+				reference_ = NULL;
 			}
 
+			// positions and connectivity have changed, drop outdated caches
+			mesh_.geometry_changed();
+			Sizing_field(mesh_).clear_cache();
+
 			// remove properties
 			mesh_.remove_vertex_property(vlocked_);
 			mesh_.remove_edge_property(elocked_);
 			mesh_.remove_vertex_property(vsizing_);
+			if (vmetric_)
+				mesh_.remove_vertex_property(vmetric_);
 		}
 
 
@@ -473,51 +433,18 @@ namespace graphene {
 			}
 
 
-			// find closest triangle of reference mesh
-			Triangle_kD_tree::Nearest_neighbor nn = kD_tree_->nearest(points_[v]);
-			const Point p = nn.nearest;
-			const Surface_mesh::Face  f = nn.face;
-
-
-			// get face data
-			Surface_mesh::Vertex_around_face_circulator fv_it = refmesh_->vertices(f);
-			const Point  p0 = refpoints_[*fv_it];
-			const Point  n0 = refnormals_[*fv_it];
-			const Scalar s0 = refsizing_[*fv_it];
-			++fv_it;
-			const Point  p1 = refpoints_[*fv_it];
-			const Point  n1 = refnormals_[*fv_it];
-			const Scalar s1 = refsizing_[*fv_it];
-			++fv_it;
-			const Point  p2 = refpoints_[*fv_it];
-			const Point  n2 = refnormals_[*fv_it];
-			const Scalar s2 = refsizing_[*fv_it];
-
-			// get barycentric coordinates
-			Point b = geometry::barycentric_coordinates(p, p0, p1, p2);
-
-			// interpolate normal
-			Point n;
-			n = (n0 * b[0]);
-			n += (n1 * b[1]);
-			n += (n2 * b[2]);
-			n.normalize();
+			// closest point, interpolated normal and sizing of reference surface
+			const Reference_surface::Sample s = reference_->project(points_[v]);
 #ifdef _WIN32
-			assert(_finite(n[0]));
+			assert(_finite(s.normal[0]));
 #else
-			assert(!std::isnan(n[0]));
+			assert(!std::isnan(s.normal[0]));
 #endif
 
-			// interpolate sizing field
-			Scalar s;
-			s = (s0 * b[0]);
-			s += (s1 * b[1]);
-			s += (s2 * b[2]);
-
 			// set result
-			points_[v] = p;
-			vnormal_[v] = n;
-			vsizing_[v] = s;
+			points_[v] = s.point;
+			vnormal_[v] = s.normal;
+			vsizing_[v] = s.value;
 		}
 
 
@@ -562,6 +489,12 @@ namespace graphene {
 						//vnormal_[v] = normalize(vnormal_[v0] + vnormal_[v1]);
 						vnormal_[v] = mesh_.compute_vertex_normal(v);
 						vsizing_[v] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
+						if (vmetric_)
+						{
+							vmetric_[v] = vmetric_[v0];
+							vmetric_[v] += vmetric_[v1];
+							vmetric_[v] *= 0.5;
+						}
 
 						if (is_feature)
 						{
@@ -588,128 +521,87 @@ namespace graphene {
 			Remesher::
 			collapse_short_edges()
 		{
-			Surface_mesh::Edge_iterator     e_it, e_end;
-			Surface_mesh::Vertex_around_vertex_circulator vv_it, vv_end;
-			Surface_mesh::Vertex    v0, v1;
-			Surface_mesh::Halfedge  h0, h1, h01, h10;
-			bool  ok, skip, b0, b1, l0, l1, f0, f1;
-			int   i;
-			bool  hcol01, hcol10;
+			std::priority_queue<Collapse_entry>  queue;
+			std::vector<unsigned int>            version(mesh_.edges_size(), 0);
+			std::vector<char>                    queued(mesh_.edges_size(), 0);
+			std::vector<Surface_mesh::Vertex>    ring;
+			Surface_mesh::Edge_iterator          e_it, e_end;
+			Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+			Surface_mesh::Vertex                 v0, v1, vh;
+			Surface_mesh::Edge                   e;
+			unsigned int                         i;
 
 
+			// queue all short edges, shortest (relative to sizing) first
+			for (e_it = mesh_.edges_begin(), e_end = mesh_.edges_end(); e_it != e_end; ++e_it)
+			{
+				v0 = mesh_.vertex(*e_it, 0);
+				v1 = mesh_.vertex(*e_it, 1);
+				if (!elocked_[*e_it] && is_too_short(v0, v1))
+				{
+					queue.push(Collapse_entry(relative_length(v0, v1), *e_it, 0));
+					queued[(*e_it).idx()] = true;
+				}
+			}
 
-			for (ok = false, i = 0; !ok && i<10; ++i)
+
+			while (!queue.empty())
 			{
-				ok = true;
+				Collapse_entry entry = queue.top();
+				queue.pop();
 
-				for (e_it = mesh_.edges_begin(), e_end = mesh_.edges_end(); e_it != e_end; ++e_it)
-				{
-					if (!mesh_.is_deleted(*e_it) && !elocked_[*e_it])
-					{
-						h10 = mesh_.halfedge(*e_it, 0);
-						h01 = mesh_.halfedge(*e_it, 1);
-						v0 = mesh_.to_vertex(h10);
-						v1 = mesh_.to_vertex(h01);
+				// skip deleted edges and outdated entries
+				e = entry.edge;
+				if (mesh_.is_deleted(e) || entry.version != version[e.idx()])
+					continue;
+				queued[e.idx()] = false;
 
-						if (is_too_short(v0, v1))
-						{
-							// get status
-							b0 = mesh_.is_boundary(v0);
-							b1 = mesh_.is_boundary(v1);
-							l0 = vlocked_[v0];
-							l1 = vlocked_[v1];
-							f0 = vfeature_[v0];
-							f1 = vfeature_[v1];
-							hcol01 = hcol10 = true;
-
-							// boundary rules
-							if (b0 && b1) { if (!mesh_.is_boundary(*e_it)) continue; }
-							else if (b0) hcol01 = false;
-							else if (b1) hcol10 = false;
-
-							// locked rules
-							if (l0 && l1) continue;
-							else if (l0) hcol01 = false;
-							else if (l1) hcol10 = false;
-
-							// feature rules
-							if (f0 && f1)
-							{
-								// edge must be feature
-								if (!efeature_[*e_it]) continue;
-
-								// the other two edges removed by collapse must not be features
-								h0 = mesh_.prev_halfedge(h01);
-								h1 = mesh_.next_halfedge(h10);
-								if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
-									hcol01 = false;
-								h0 = mesh_.prev_halfedge(h10);
-								h1 = mesh_.next_halfedge(h01);
-								if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
-									hcol10 = false;
-							}
-							else if (f0) hcol01 = false;
-							else if (f1) hcol10 = false;
+				Surface_mesh::Halfedge h = collapse_candidate(e);
+				if (!h.is_valid())
+					continue;
 
-							// topological rules
-							bool collapse_ok = mesh_.is_collapse_ok(h01);
-							if (hcol01)  hcol01 = collapse_ok;
-							if (hcol10)  hcol10 = collapse_ok;
+				vh = mesh_.to_vertex(h);
+				mesh_.collapse(h);
 
-							// both collapses possible: collapse into vertex w/ higher valence
-							if (hcol01 && hcol10)
-							{
-								if (mesh_.valence(v0) < mesh_.valence(v1))
-									hcol10 = false;
-								else
-									hcol01 = false;
-							}
 
-							// try v1 -> v0
-							if (hcol10)
-							{
-								// don't create too long edges
-								skip = false;
-								vv_it = vv_end = mesh_.vertices(v1);
-								do
-								{
-									if (is_too_long(v0, *vv_it))
-									{
-										hcol10 = false;
-										break;
-									}
-								} while (++vv_it != vv_end);
-
-								if (hcol10)
-								{
-									mesh_.collapse(h10);
-									ok = false;
-								}
-							}
+				// edges incident to vh got a new end point: their entries
+				// are outdated, queue them again with their new length
+				ring.clear();
+				vh_it = vh_end = mesh_.halfedges(vh);
+				if (vh_it) do
+				{
+					e = mesh_.edge(*vh_it);
+					v1 = mesh_.to_vertex(*vh_it);
+					ring.push_back(v1);
+					++version[e.idx()];
+					queued[e.idx()] = false;
+					if (!elocked_[e] && is_too_short(vh, v1))
+					{
+						queue.push(Collapse_entry(relative_length(vh, v1), e, version[e.idx()]));
+						queued[e.idx()] = true;
+					}
+				} while (++vh_it != vh_end);
 
-							// try v0 -> v1
-							else if (hcol01)
+
+				// the one-rings of the neighbors changed: edges around them
+				// that were rejected before might be collapsible now
+				for (i = 0; i < ring.size(); ++i)
+				{
+					vh_it = vh_end = mesh_.halfedges(ring[i]);
+					do
+					{
+						e = mesh_.edge(*vh_it);
+						if (!queued[e.idx()])
+						{
+							v0 = ring[i];
+							v1 = mesh_.to_vertex(*vh_it);
+							if (!elocked_[e] && is_too_short(v0, v1))
 							{
-								// don't create too long edges
-								skip = false;
-								vv_it = vv_end = mesh_.vertices(v0);
-								do
-								{
-									if (is_too_long(v1, *vv_it))
-									{
-										hcol01 = false;
-										break;
-									}
-								} while (++vv_it != vv_end);
-
-								if (hcol01)
-								{
-									mesh_.collapse(h01);
-									ok = false;
-								}
+								queue.push(Collapse_entry(relative_length(v0, v1), e, version[e.idx()]));
+								queued[e.idx()] = true;
 							}
 						}
-					}
+					} while (++vh_it != vh_end);
 				}
 			}
 
@@ -717,6 +609,116 @@ namespace graphene {
 		}
 
 
+		//-----------------------------------------------------------------------------
+
+
+		Surface_mesh::Halfedge
+			Remesher::
+			collapse_candidate(Surface_mesh::Edge e)
+		{
+			Surface_mesh::Vertex_around_vertex_circulator vv_it, vv_end;
+			Surface_mesh::Vertex    v0, v1;
+			Surface_mesh::Halfedge  h0, h1, h01, h10;
+			bool  b0, b1, l0, l1, f0, f1;
+			bool  hcol01, hcol10;
+
+
+			if (elocked_[e])
+				return Surface_mesh::Halfedge();
+
+			h10 = mesh_.halfedge(e, 0);
+			h01 = mesh_.halfedge(e, 1);
+			v0 = mesh_.to_vertex(h10);
+			v1 = mesh_.to_vertex(h01);
+
+			if (!is_too_short(v0, v1))
+				return Surface_mesh::Halfedge();
+
+			// get status
+			b0 = mesh_.is_boundary(v0);
+			b1 = mesh_.is_boundary(v1);
+			l0 = vlocked_[v0];
+			l1 = vlocked_[v1];
+			f0 = vfeature_[v0];
+			f1 = vfeature_[v1];
+			hcol01 = hcol10 = true;
+
+			// boundary rules
+			if (b0 && b1) { if (!mesh_.is_boundary(e)) return Surface_mesh::Halfedge(); }
+			else if (b0) hcol01 = false;
+			else if (b1) hcol10 = false;
+
+			// locked rules
+			if (l0 && l1) return Surface_mesh::Halfedge();
+			else if (l0) hcol01 = false;
+			else if (l1) hcol10 = false;
+
+			// feature rules
+			if (f0 && f1)
+			{
+				// edge must be feature
+				if (!efeature_[e]) return Surface_mesh::Halfedge();
+
+				// the other two edges removed by collapse must not be features
+				h0 = mesh_.prev_halfedge(h01);
+				h1 = mesh_.next_halfedge(h10);
+				if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
+					hcol01 = false;
+				h0 = mesh_.prev_halfedge(h10);
+				h1 = mesh_.next_halfedge(h01);
+				if (efeature_[mesh_.edge(h0)] || efeature_[mesh_.edge(h1)])
+					hcol10 = false;
+			}
+			else if (f0) hcol01 = false;
+			else if (f1) hcol10 = false;
+
+			// topological rules
+			bool collapse_ok = mesh_.is_collapse_ok(h01);
+			if (hcol01)  hcol01 = collapse_ok;
+			if (hcol10)  hcol10 = collapse_ok;
+
+			// both collapses possible: collapse into vertex w/ higher valence
+			if (hcol01 && hcol10)
+			{
+				if (mesh_.valence(v0) < mesh_.valence(v1))
+					hcol10 = false;
+				else
+					hcol01 = false;
+			}
+
+			// try v1 -> v0
+			if (hcol10)
+			{
+				// don't create too long edges
+				vv_it = vv_end = mesh_.vertices(v1);
+				do
+				{
+					if (is_too_long(v0, *vv_it))
+						return Surface_mesh::Halfedge();
+				} while (++vv_it != vv_end);
+
+				return h10;
+			}
+
+			// try v0 -> v1
+			else if (hcol01)
+			{
+				// don't create too long edges
+				vv_it = vv_end = mesh_.vertices(v0);
+				do
+				{
+					if (is_too_long(v1, *vv_it))
+						return Surface_mesh::Halfedge();
+				} while (++vv_it != vv_end);
+
+				return h01;
+			}
+
+			return Surface_mesh::Halfedge();
+		}
+
+
+
 		//-----------------------------------------------------------------------------
 
 
@@ -725,12 +727,8 @@ namespace graphene {
 			flip_edges()
 		{
 			Surface_mesh::Edge_iterator     e_it, e_end;
-			Surface_mesh::Vertex_iterator   v_it, v_end;
 			Surface_mesh::Vertex            v0, v1, v2, v3;
 			Surface_mesh::Halfedge          h;
-			int                          val0, val1, val2, val3;
-			int                          val_opt0, val_opt1, val_opt2, val_opt3;
-			int                          ve0, ve1, ve2, ve3, ve_before, ve_after;
 			bool                         ok;
 			int                          i;
 
@@ -750,7 +748,7 @@ namespace graphene {
 
 				for (e_it = mesh_.edges_begin(), e_end = mesh_.edges_end(); e_it != e_end; ++e_it)
 				{
-					if (!elocked_[*e_it] && !efeature_[*e_it])
+					if (is_flip_beneficial(*e_it, valence))
 					{
 						h = mesh_.halfedge(*e_it, 0);
 						v0 = mesh_.to_vertex(h);
@@ -759,60 +757,106 @@ namespace graphene {
 						v1 = mesh_.to_vertex(h);
 						v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
 
-						if (!vlocked_[v0] && !vlocked_[v1] && !vlocked_[v2] && !vlocked_[v3])
-						{
-							val0 = valence[v0];
-							val1 = valence[v1];
-							val2 = valence[v2];
-							val3 = valence[v3];
+						mesh_.flip(*e_it);
+						--valence[v0];
+						--valence[v1];
+						++valence[v2];
+						++valence[v3];
+						ok = false;
+					}
+				}
+			}
 
-							val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
-							val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
-							val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
-							val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
+			mesh_.remove_vertex_property(valence);
+		}
 
-							ve0 = (val0 - val_opt0);
-							ve1 = (val1 - val_opt1);
-							ve2 = (val2 - val_opt2);
-							ve3 = (val3 - val_opt3);
 
-							ve0 *= ve0;
-							ve1 *= ve1;
-							ve2 *= ve2;
-							ve3 *= ve3;
+		//-----------------------------------------------------------------------------
 
-							ve_before = ve0 + ve1 + ve2 + ve3;
 
-							--val0;  --val1;
-							++val2;  ++val3;
+		bool
+			Remesher::
+			is_flip_beneficial(Surface_mesh::Edge e,
+				const Surface_mesh::Vertex_property<int>& valence) const
+		{
+			Surface_mesh::Vertex            v0, v1, v2, v3;
+			Surface_mesh::Halfedge          h;
+			int                          val0, val1, val2, val3;
+			int                          val_opt0, val_opt1, val_opt2, val_opt3;
+			int                          ve0, ve1, ve2, ve3, ve_before, ve_after;
 
-							ve0 = (val0 - val_opt0);
-							ve1 = (val1 - val_opt1);
-							ve2 = (val2 - val_opt2);
-							ve3 = (val3 - val_opt3);
 
-							ve0 *= ve0;
-							ve1 *= ve1;
-							ve2 *= ve2;
-							ve3 *= ve3;
+			if (elocked_[e] || efeature_[e] || mesh_.is_boundary(e))
+				return false;
 
-							ve_after = ve0 + ve1 + ve2 + ve3;
+			h = mesh_.halfedge(e, 0);
+			v0 = mesh_.to_vertex(h);
+			v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
+			h = mesh_.halfedge(e, 1);
+			v1 = mesh_.to_vertex(h);
+			v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
 
-							if (ve_before > ve_after && mesh_.is_flip_ok(*e_it))
-							{
-								mesh_.flip(*e_it);
-								--valence[v0];
-								--valence[v1];
-								++valence[v2];
-								++valence[v3];
-								ok = false;
-							}
-						}
-					}
-				}
-			}
+			if (vlocked_[v0] || vlocked_[v1] || vlocked_[v2] || vlocked_[v3])
+				return false;
 
-			mesh_.remove_vertex_property(valence);
+			val0 = valence[v0];
+			val1 = valence[v1];
+			val2 = valence[v2];
+			val3 = valence[v3];
+
+			val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
+			val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
+			val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
+			val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
+
+			ve0 = (val0 - val_opt0);
+			ve1 = (val1 - val_opt1);
+			ve2 = (val2 - val_opt2);
+			ve3 = (val3 - val_opt3);
+
+			ve0 *= ve0;
+			ve1 *= ve1;
+			ve2 *= ve2;
+			ve3 *= ve3;
+
+			ve_before = ve0 + ve1 + ve2 + ve3;
+
+			--val0;  --val1;
+			++val2;  ++val3;
+
+			ve0 = (val0 - val_opt0);
+			ve1 = (val1 - val_opt1);
+			ve2 = (val2 - val_opt2);
+			ve3 = (val3 - val_opt3);
+
+			ve0 *= ve0;
+			ve1 *= ve1;
+			ve2 *= ve2;
+			ve3 *= ve3;
+
+			ve_after = ve0 + ve1 + ve2 + ve3;
+
+			return (ve_before > ve_after && mesh_.is_flip_ok(e));
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		bool
+			Remesher::
+			claim(const std::vector<Surface_mesh::Vertex>& region)
+		{
+			unsigned int i;
+
+			for (i = 0; i < region.size(); ++i)
+				if (vbatch_[region[i].idx()] == batch_)
+					return false;
+
+			for (i = 0; i < region.size(); ++i)
+				vbatch_[region[i].idx()] = batch_;
+
+			return true;
 		}
 
 
@@ -821,159 +865,568 @@ namespace graphene {
 
 		void
 			Remesher::
-			tangential_smoothing(unsigned int iterations)
+			edge_region(Surface_mesh::Edge e, std::vector<Surface_mesh::Vertex>& region) const
 		{
-			Surface_mesh::Vertex v1, v2, v3, vv;
-			Surface_mesh::Edge  e;
-			Scalar  w, ww, area;
-			Point   u, n, t, b;
+			Surface_mesh::Halfedge h0 = mesh_.halfedge(e, 0);
+			Surface_mesh::Halfedge h1 = mesh_.halfedge(e, 1);
+
+			region.clear();
+			region.push_back(mesh_.to_vertex(h0));
+			region.push_back(mesh_.to_vertex(h1));
+			if (!mesh_.is_boundary(h0))
+				region.push_back(mesh_.to_vertex(mesh_.next_halfedge(h0)));
+			if (!mesh_.is_boundary(h1))
+				region.push_back(mesh_.to_vertex(mesh_.next_halfedge(h1)));
+		}
 
-			Surface_mesh::Vertex_iterator vit, vend(mesh_.vertices_end());
-			Surface_mesh::Halfedge_around_vertex_circulator hit, hend;
+
+		//-----------------------------------------------------------------------------
 
 
-			// add property
-			Surface_mesh::Vertex_property<Point>  update = mesh_.add_vertex_property<Point>("v:update");
+		void
+			Remesher::
+			split_long_edges_parallel()
+		{
+			std::vector<Surface_mesh::Edge>    work, deferred, batch;
+			std::vector<Surface_mesh::Vertex>  region;
+			std::vector<unsigned int>          eoffset, foffset;
+			std::vector<char>                  too_long;
+			unsigned int                       vfirst, ne, nf, round;
+			int                                i, n;
 
 
-			// project at the beginning to get valid sizing values and normal vectors
-			// for vertices introduced by splitting
-			if (use_projection_)
+			// test all edges in the first round
+			work.reserve(mesh_.n_edges());
+			for (Surface_mesh::Edge_iterator e_it = mesh_.edges_begin(); e_it != mesh_.edges_end(); ++e_it)
+				work.push_back(*e_it);
+
+			vbatch_.assign(mesh_.vertices_size(), 0);
+			batch_ = 0;
+
+
+			for (round = 0; !work.empty() && round<100; ++round)
 			{
-				for (vit = mesh_.vertices_begin(); vit != vend; ++vit)
+				// test edges in parallel
+				n = work.size();
+				too_long.assign(n, 0);
+
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < n; ++i)
+				{
+					too_long[i] = !elocked_[work[i]] &&
+						is_too_long(mesh_.vertex(work[i], 0), mesh_.vertex(work[i], 1));
+				}
+
+
+				// greedily pick splits whose triangles do not share a vertex
+				++batch_;
+				batch.clear();
+				deferred.clear();
+				for (i = 0; i < n; ++i)
+				{
+					if (too_long[i])
+					{
+						edge_region(work[i], region);
+						if (claim(region)) batch.push_back(work[i]);
+						else               deferred.push_back(work[i]);
+					}
+				}
+				if (batch.empty()) break;
+
+
+				// allocate the new elements of all splits at once
+				n = batch.size();
+				eoffset.resize(n + 1);
+				foffset.resize(n + 1);
+				vfirst = mesh_.vertices_size();
+				ne = mesh_.edges_size();
+				nf = mesh_.faces_size();
+				for (i = 0; i < n; ++i)
 				{
-					Surface_mesh::Vertex v(*vit);
+					eoffset[i] = ne;
+					foffset[i] = nf;
+					++ne;
+					if (!mesh_.is_boundary(mesh_.halfedge(batch[i], 0))) { ++ne; ++nf; }
+					if (!mesh_.is_boundary(mesh_.halfedge(batch[i], 1))) { ++ne; ++nf; }
+				}
+				eoffset[n] = ne;
+				foffset[n] = nf;
+				mesh_.allocate(n, ne - mesh_.edges_size(), nf - mesh_.faces_size());
+				vbatch_.resize(mesh_.vertices_size(), 0);
 
-					if (!mesh_.is_boundary(v) && !vlocked_[v])
+
+				// split in parallel, the triangles of the batch are disjoint
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < n; ++i)
+				{
+					Surface_mesh::Edge   e = batch[i];
+					Surface_mesh::Vertex v(vfirst + i);
+					Surface_mesh::Vertex v0 = mesh_.vertex(e, 0);
+					Surface_mesh::Vertex v1 = mesh_.vertex(e, 1);
+
+					points_[v] = (points_[v0] + points_[v1])*0.5;
+					mesh_.split(e, v, Surface_mesh::Edge(eoffset[i]), Surface_mesh::Face(foffset[i]));
+
+					// need normal or sizing for adaptive refinement
+					vnormal_[v] = mesh_.compute_vertex_normal(v);
+					vsizing_[v] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
+					if (vmetric_)
 					{
+						vmetric_[v] = vmetric_[v0];
+						vmetric_[v] += vmetric_[v1];
+						vmetric_[v] *= 0.5;
+					}
+
+					if (!efeature_[e])
 						project_to_reference(v);
+				}
+
+
+				// feature flags (bool properties are bit vectors, so not in
+				// parallel), and collect edges to test in the next round
+				work.swap(deferred);
+				for (i = 0; i < n; ++i)
+				{
+					if (efeature_[batch[i]])
+					{
+						efeature_[Surface_mesh::Edge(eoffset[i])] = true;
+						vfeature_[Surface_mesh::Vertex(vfirst + i)] = true;
 					}
+
+					work.push_back(batch[i]);
+					for (ne = eoffset[i]; ne < eoffset[i + 1]; ++ne)
+						work.push_back(Surface_mesh::Edge(ne));
 				}
 			}
+		}
 
 
-			for (unsigned int iters = 0; iters<iterations; ++iters)
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Remesher::
+			collapse_short_edges_parallel()
+		{
+			std::vector<Surface_mesh::Edge>      work, deferred;
+			std::vector<Surface_mesh::Halfedge>  target, batch;
+			std::vector<Surface_mesh::Vertex>    region, survivors;
+			std::vector<unsigned int>            equeued(mesh_.edges_size(), 0);
+			Surface_mesh::Vertex_around_vertex_circulator   vv_it, vv_end;
+			Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+			Surface_mesh::Vertex                 v0, v1;
+			unsigned int                         round, j;
+			int                                  i, n;
+
+
+			// test all edges in the first round
+			work.reserve(mesh_.n_edges());
+			for (Surface_mesh::Edge_iterator e_it = mesh_.edges_begin(); e_it != mesh_.edges_end(); ++e_it)
+				work.push_back(*e_it);
+
+			vbatch_.assign(mesh_.vertices_size(), 0);
+			batch_ = 0;
+
+
+			for (round = 0; !work.empty() && round<100; ++round)
 			{
-				for (vit = mesh_.vertices_begin(); vit != vend; ++vit)
+				// evaluate collapses in parallel (the expensive part)
+				n = work.size();
+				target.assign(n, Surface_mesh::Halfedge());
+
+#pragma omp parallel for schedule(dynamic, 256)
+				for (i = 0; i < n; ++i)
 				{
-					Surface_mesh::Vertex v(*vit);
+					if (!mesh_.is_deleted(work[i]))
+						target[i] = collapse_candidate(work[i]);
+				}
 
-					if (!mesh_.is_boundary(v) && !vlocked_[v])
+
+				// pick collapses with disjoint closed one-rings, their tests
+				// stay valid while the others are applied
+				++batch_;
+				batch.clear();
+				deferred.clear();
+				for (i = 0; i < n; ++i)
+				{
+					if (!target[i].is_valid()) continue;
+
+					v0 = mesh_.from_vertex(target[i]);
+					v1 = mesh_.to_vertex(target[i]);
+					region.clear();
+					region.push_back(v0);
+					region.push_back(v1);
+					vv_it = vv_end = mesh_.vertices(v0);
+					do { if (*vv_it != v1) region.push_back(*vv_it); } while (++vv_it != vv_end);
+					vv_it = vv_end = mesh_.vertices(v1);
+					do { if (*vv_it != v0) region.push_back(*vv_it); } while (++vv_it != vv_end);
+
+					if (claim(region))
 					{
-						if (vfeature_[v])
-						{
-							u = 0.0;
-							t = 0.0;
-							ww = 0;
-							int c = 0;
+						batch.push_back(target[i]);
+					}
+					else
+					{
+						deferred.push_back(work[i]);
+						equeued[work[i].idx()] = batch_;
+					}
+				}
+				if (batch.empty()) break;
 
-							hit = hend = mesh_.halfedges(v);
-							do
-							{
-								Surface_mesh::Halfedge h = *hit;
-
-								if (efeature_[mesh_.edge(h)])
-								{
-									vv = mesh_.to_vertex(h);
-
-									b = points_[v];
-									b += points_[vv];
-									b *= 0.5;
-
-									w = distance(points_[v], points_[vv]) / (0.5*(vsizing_[v] + vsizing_[vv]));
-									ww += w;
-									u += w * b;
-
-									if (c == 0)
-									{
-										t += normalize(points_[vv] - points_[v]);
-										++c;
-									}
-									else
-									{
-										++c;
-										t -= normalize(points_[vv] - points_[v]);
-									}
-								}
-							} while (++hit != hend);
-
-							assert(c == 2);
-
-							u *= (1.0 / ww);
-							u -= points_[v];
-							t = normalize(t);
-							u = t * dot(u, t);
-						}
-						else
-						{
-							u = 0.0;
-							t = 0.0;
-							ww = 0;
 
-							hit = hend = mesh_.halfedges(v);
-							do
+				// apply, the mesh's deletion bookkeeping is shared
+				survivors.clear();
+				for (j = 0; j < batch.size(); ++j)
+				{
+					survivors.push_back(mesh_.to_vertex(batch[j]));
+					mesh_.collapse(batch[j]);
+				}
+
+
+				// re-test deferred edges and edges around the modified one-rings
+				work.swap(deferred);
+				for (j = 0; j < survivors.size(); ++j)
+				{
+					region.clear();
+					region.push_back(survivors[j]);
+					vv_it = vv_end = mesh_.vertices(survivors[j]);
+					if (vv_it) do { region.push_back(*vv_it); } while (++vv_it != vv_end);
+
+					for (unsigned int k = 0; k < region.size(); ++k)
+					{
+						vh_it = vh_end = mesh_.halfedges(region[k]);
+						if (vh_it) do
+						{
+							Surface_mesh::Edge e = mesh_.edge(*vh_it);
+							if (equeued[e.idx()] != batch_)
 							{
-								Surface_mesh::Halfedge h = *hit;
+								equeued[e.idx()] = batch_;
+								work.push_back(e);
+							}
+						} while (++vh_it != vh_end);
+					}
+				}
+			}
 
-								v1 = v;
-								v2 = mesh_.to_vertex(h);
-								v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
+			mesh_.garbage_collection();
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Remesher::
+			flip_edges_parallel()
+		{
+			std::vector<Surface_mesh::Edge>    work, deferred, batch;
+			std::vector<Surface_mesh::Vertex>  region;
+			std::vector<unsigned int>          equeued(mesh_.edges_size(), 0);
+			std::vector<char>                  do_flip;
+			Surface_mesh::Halfedge_around_vertex_circulator vh_it, vh_end;
+			unsigned int                       round, j, k;
+			int                                i, n;
+
+
+			// precompute valences
+			Surface_mesh::Vertex_property<int> valence = mesh_.add_vertex_property<int>("valence");
+			n = mesh_.vertices_size();
+#pragma omp parallel for schedule(static)
+			for (i = 0; i < n; ++i)
+			{
+				valence[Surface_mesh::Vertex(i)] = mesh_.valence(Surface_mesh::Vertex(i));
+			}
 
-								b = points_[v1];
-								b += points_[v2];
-								b += points_[v3];
-								b *= (1.0 / 3.0);
 
-								area = norm(cross(points_[v2] - points_[v1], points_[v3] - points_[v1]));
-								w = area / pow((vsizing_[v1] + vsizing_[v2] + vsizing_[v3]) / 3.0, 2.0);
+			// test all edges in the first round
+			work.reserve(mesh_.n_edges());
+			for (Surface_mesh::Edge_iterator e_it = mesh_.edges_begin(); e_it != mesh_.edges_end(); ++e_it)
+				work.push_back(*e_it);
 
-								u += w * b;
-								ww += w;
-							} while (++hit != hend);
+			vbatch_.assign(mesh_.vertices_size(), 0);
+			batch_ = 0;
 
-							u /= ww;
-							u -= points_[v];
-							n = vnormal_[v];
-							u -= n*dot(u, n);
 
-							update[v] = u;
+			for (round = 0; !work.empty() && round<100; ++round)
+			{
+				// evaluate flips in parallel
+				n = work.size();
+				do_flip.assign(n, 0);
+
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < n; ++i)
+				{
+					do_flip[i] = is_flip_beneficial(work[i], valence);
+				}
+
+
+				// pick flips whose triangles do not share a vertex
+				++batch_;
+				batch.clear();
+				deferred.clear();
+				for (i = 0; i < n; ++i)
+				{
+					if (do_flip[i])
+					{
+						edge_region(work[i], region);
+						if (claim(region))
+						{
+							batch.push_back(work[i]);
+						}
+						else
+						{
+							deferred.push_back(work[i]);
+							equeued[work[i].idx()] = batch_;
 						}
 					}
 				}
+				if (batch.empty()) break;
 
 
-				// update vertex positions
-				for (vit = mesh_.vertices_begin(); vit != vend; ++vit)
+				// flip in parallel
+				n = batch.size();
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < n; ++i)
 				{
-					Surface_mesh::Vertex v(*vit);
-					if (!mesh_.is_boundary(v) && !vlocked_[v])
+					Surface_mesh::Edge     e  = batch[i];
+					Surface_mesh::Halfedge h0 = mesh_.halfedge(e, 0);
+					Surface_mesh::Halfedge h1 = mesh_.halfedge(e, 1);
+
+					--valence[mesh_.to_vertex(h0)];
+					--valence[mesh_.to_vertex(h1)];
+					++valence[mesh_.to_vertex(mesh_.next_halfedge(h0))];
+					++valence[mesh_.to_vertex(mesh_.next_halfedge(h1))];
+
+					mesh_.flip(e);
+				}
+
+
+				// re-test deferred edges and edges of the triangles around
+				// vertices whose valence changed
+				work.swap(deferred);
+				for (j = 0; j < batch.size(); ++j)
+				{
+					edge_region(batch[j], region);
+					for (k = 0; k < region.size(); ++k)
 					{
-						points_[v] += update[v];
+						vh_it = vh_end = mesh_.halfedges(region[k]);
+						do
+						{
+							Surface_mesh::Edge e0 = mesh_.edge(*vh_it);
+							Surface_mesh::Edge e1 = mesh_.edge(mesh_.next_halfedge(*vh_it));
+							if (equeued[e0.idx()] != batch_)
+							{
+								equeued[e0.idx()] = batch_;
+								work.push_back(e0);
+							}
+							if (!mesh_.is_boundary(*vh_it) && equeued[e1.idx()] != batch_)
+							{
+								equeued[e1.idx()] = batch_;
+								work.push_back(e1);
+							}
+						} while (++vh_it != vh_end);
 					}
 				}
+			}
 
+			mesh_.remove_vertex_property(valence);
+		}
 
-				// update normal vectors (if not done so through projection
-				mesh_.update_vertex_normals();
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Remesher::
+			tangential_smoothing(unsigned int iterations)
+		{
+			const int                  nv = mesh_.vertices_size();
+			std::vector<unsigned int>  offset(nv + 1, 0);
+			std::vector<int>           fan;
+			std::vector<char>          movable(nv), projectable(nv);
+			std::vector<Point>         pos(nv), pos_new(nv), normal(nv);
+			std::vector<Scalar>        sizing(nv);
+			std::vector<Sizing_metric> metric(vmetric_ ? nv : 0);
+			int                        i;
+
+
+			// project at the beginning to get valid sizing values and normal
+			// vectors for vertices introduced by splitting, then take a
+			// snapshot of positions, normals, sizing, and vertex status.
+			// feature vertices are not moved.
+#pragma omp parallel for schedule(dynamic, 1024)
+			for (i = 0; i < nv; ++i)
+			{
+				Surface_mesh::Vertex v(i);
+				Surface_mesh::Halfedge_around_vertex_circulator hit, hend;
+
+				projectable[i] = !mesh_.is_deleted(v) && !mesh_.is_boundary(v) && !vlocked_[v];
+				movable[i] = projectable[i] && !vfeature_[v];
+
+				if (use_projection_ && projectable[i])
+					project_to_reference(v);
+
+				pos[i] = points_[v];
+				normal[i] = vnormal_[v];
+				sizing[i] = vsizing_[v];
+				if (vmetric_) metric[i] = vmetric_[v];
+
+				// count triangles of the fan
+				hit = hend = mesh_.halfedges(v);
+				if (hit) do
+				{
+					if (!mesh_.is_boundary(*hit))
+						++offset[i + 1];
+				} while (++hit != hend);
 			}
 
 
-			// project at the end
-			if (use_projection_)
+			// adjacency snapshot: the triangle fan (v, v2, v3) of each vertex
+			// as pairs of indices. the topology does not change while smoothing.
+			for (i = 0; i < nv; ++i)
+				offset[i + 1] += offset[i];
+			fan.resize(2 * offset[nv]);
+
+#pragma omp parallel for schedule(static)
+			for (i = 0; i < nv; ++i)
 			{
-				for (vit = mesh_.vertices_begin(); vit != vend; ++vit)
+				Surface_mesh::Halfedge_around_vertex_circulator hit, hend;
+				unsigned int k = 2 * offset[i];
+
+				hit = hend = mesh_.halfedges(Surface_mesh::Vertex(i));
+				if (hit) do
 				{
-					Surface_mesh::Vertex v(*vit);
-					if (!mesh_.is_boundary(v) && !vlocked_[v])
+					if (!mesh_.is_boundary(*hit))
 					{
-						project_to_reference(v);
+						fan[k++] = mesh_.to_vertex(*hit).idx();
+						fan[k++] = mesh_.to_vertex(mesh_.next_halfedge(*hit)).idx();
+					}
+				} while (++hit != hend);
+			}
+
+
+			for (unsigned int iters = 0; iters<iterations; ++iters)
+			{
+				// move vertices towards the sizing-weighted barycenter of their
+				// fan, restricted to the tangent plane. read pos, write pos_new.
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < nv; ++i)
+				{
+					if (!movable[i])
+					{
+						pos_new[i] = pos[i];
+						continue;
 					}
+
+					const Point&  p1 = pos[i];
+					const Scalar  s1 = sizing[i];
+					Point   u(0, 0, 0), b, n;
+					Scalar  w, ww(0), area, s;
+
+					// anisotropic: minimize sum_j (p-p_j)^T M_ij (p-p_j) over
+					// the tangent plane, M_ij = (M_i+M_j)/2, i.e. equalize the
+					// metric lengths of the edges to the one-ring
+					if (vmetric_)
+					{
+						n = normal[i];
+						Point t1 = (fabs(n[0]) < 0.9) ? cross(n, Point(1, 0, 0)) : cross(n, Point(0, 1, 0));
+						t1.normalize();
+						const Point t2 = cross(n, t1);
+
+						Sizing_metric A;
+						Point  r(0, 0, 0);
+						for (unsigned int k = 2 * offset[i]; k < 2 * offset[i + 1]; k += 2)
+						{
+							Sizing_metric m = metric[i];
+							m += metric[fan[k]];
+							A += m;
+							r += m * (pos[fan[k]] - p1);
+						}
+
+						// 2x2 system in the tangent basis
+						const Point  At1 = A * t1, At2 = A * t2;
+						const Scalar a11 = dot(t1, At1), a12 = dot(t1, At2), a22 = dot(t2, At2);
+						const Scalar r1 = dot(t1, r), r2 = dot(t2, r);
+						const Scalar det = a11*a22 - a12*a12;
+
+						pos_new[i] = p1;
+						if (fabs(det) > std::numeric_limits<Scalar>::min())
+							pos_new[i] += ((a22*r1 - a12*r2) / det) * t1 + ((a11*r2 - a12*r1) / det) * t2;
+						continue;
+					}
+
+					for (unsigned int k = 2 * offset[i]; k < 2 * offset[i + 1]; k += 2)
+					{
+						const Point& p2 = pos[fan[k]];
+						const Point& p3 = pos[fan[k + 1]];
+
+						b = p1;
+						b += p2;
+						b += p3;
+						b *= (1.0 / 3.0);
+
+						area = norm(cross(p2 - p1, p3 - p1));
+						s = (s1 + sizing[fan[k]] + sizing[fan[k + 1]]) * (1.0 / 3.0);
+						w = area / (s*s);
+
+						u += w * b;
+						ww += w;
+					}
+
+					u /= ww;
+					u -= p1;
+					n = normal[i];
+					u -= n*dot(u, n);
+
+					pos_new[i] = p1 + u;
+				}
+
+				pos.swap(pos_new);
+
+
+				// update normal vectors (same weighting as Surface_mesh)
+#pragma omp parallel for schedule(static)
+				for (i = 0; i < nv; ++i)
+				{
+					const Point& p0 = pos[i];
+					Point   nn(0, 0, 0), n, p1, p2;
+					Scalar  cosine, denom;
+
+					for (unsigned int k = 2 * offset[i]; k < 2 * offset[i + 1]; k += 2)
+					{
+						p1 = pos[fan[k]] - p0;
+						p2 = pos[fan[k + 1]] - p0;
+
+						denom = sqrt(dot(p1, p1)*dot(p2, p2));
+						if (denom > std::numeric_limits<Scalar>::min())
+						{
+							cosine = std::min(Scalar(1.0), std::max(Scalar(-1.0), dot(p1, p2) / denom));
+							n = cross(p1, p2);
+							denom = norm(n);
+							if (denom > std::numeric_limits<Scalar>::min())
+								nn += n * (acos(cosine) / denom);
+						}
+					}
+
+					normal[i] = nn.normalize();
 				}
 			}
 
 
-			// remove property
-			mesh_.remove_vertex_property(update);
+			// write back, and project at the end in the same pass
+#pragma omp parallel for schedule(dynamic, 1024)
+			for (i = 0; i < nv; ++i)
+			{
+				Surface_mesh::Vertex v(i);
+
+				points_[v] = pos[i];
+				if (iterations)
+					vnormal_[v] = normal[i];
+
+				if (use_projection_ && projectable[i])
+					project_to_reference(v);
+			}
 		}
 
 
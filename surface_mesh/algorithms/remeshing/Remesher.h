@@ -7,7 +7,9 @@
 //== INCLUDES =================================================================
 
 #include <graphene/surface_mesh/data_structure/Surface_mesh.h>
-#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Triangle_kD_tree.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Reference_surface.h>
+#include <graphene/surface_mesh/algorithms/remeshing/Sizing_field.h>
+#include <graphene/utility/Progress.h>
 
 
 //== NAMESPACES ===============================================================
@@ -19,17 +21,35 @@ namespace surface_mesh {
 //== CLASS DEFINITION =========================================================
 
 
-void uniform_remeshing(Surface_mesh& mesh,
+/// returns false if stopped early through \c progress
+bool uniform_remeshing(Surface_mesh& mesh,
                        Scalar edge_length,
                        unsigned int iterations=10,
-                       bool use_projection=true);
+                       bool use_projection=true,
+                       bool parallel=false,
+                       utility::Progress* progress=NULL);
 
-void adaptive_remeshing(Surface_mesh& mesh,
+/// returns false if stopped early through \c progress
+bool adaptive_remeshing(Surface_mesh& mesh,
                         Scalar min_edge_length,
                         Scalar max_edge_length,
                         Scalar approx_error,
                         unsigned int iterations=10,
-                        bool use_projection=true);
+                        bool use_projection=true,
+                        bool parallel=false,
+                        utility::Progress* progress=NULL);
+
+/// adaptive remeshing with an anisotropic metric from the curvature tensor,
+/// triangles are stretched along the direction of minimum curvature.
+/// returns false if stopped early through \c progress
+bool anisotropic_remeshing(Surface_mesh& mesh,
+                           Scalar min_edge_length,
+                           Scalar max_edge_length,
+                           Scalar approx_error,
+                           unsigned int iterations=10,
+                           bool use_projection=true,
+                           bool parallel=false,
+                           utility::Progress* progress=NULL);
 
 
 //-----------------------------------------------------------------------------
@@ -45,13 +65,33 @@ public:
     // destructor
     ~Remesher();
 
-    // uniform remeshing with target edge length
-    void remesh(Scalar edge_length,
+    // apply split, collapse and flip in conflict-free parallel batches
+    void set_parallel(bool parallel) { parallel_ = parallel; }
+
+    // report progress after every stage, stop when cancelled or out of time.
+    // the mesh is valid (but not fully remeshed) after stopping.
+    void set_progress(utility::Progress* progress) { progress_ = progress; }
+
+    // limit the change of the adaptive sizing field to gradation times the
+    // edge length, 0 disables
+    void set_gradation(Scalar gradation) { gradation_ = gradation; }
+
+    // adaptive remeshing measures edges in a per-vertex metric tensor
+    // instead of the scalar sizing field, max_aspect limits the stretch
+    void set_anisotropic(bool anisotropic, Scalar max_aspect=10.0)
+    {
+        anisotropic_ = anisotropic;
+        max_aspect_  = max_aspect;
+    }
+
+    // uniform remeshing with target edge length, false if stopped early
+    bool remesh(Scalar edge_length,
                 unsigned int iterations=10,
                 bool use_projection=true);
 
-    // adaptive remeshing with min/max edge length and approximation error
-    void remesh(Scalar min_edge_length,
+    // adaptive remeshing with min/max edge length and approximation error,
+    // false if stopped early
+    bool remesh(Scalar min_edge_length,
                 Scalar max_edge_length,
                 Scalar approx_error,
                 unsigned int iterations=10,
@@ -64,38 +104,96 @@ private:
     void preprocessing();
     void postprocessing();
 
+    // the iterations shared by both modes, false if stopped early
+    bool iterate(unsigned int iterations);
+
+    // forward to progress_, false if we should stop
+    bool report(const char* stage, float fraction);
+
     void split_long_edges();
     void collapse_short_edges();
     void flip_edges();
     void tangential_smoothing(unsigned int iterations);
     void remove_caps();
 
+    void split_long_edges_parallel();
+    void collapse_short_edges_parallel();
+    void flip_edges_parallel();
+
+    // halfedge to collapse for edge e, invalid if e should not be collapsed
+    Surface_mesh::Halfedge collapse_candidate(Surface_mesh::Edge e);
+
+    // does flipping e improve the valences? requires valence property
+    bool is_flip_beneficial(Surface_mesh::Edge e,
+                            const Surface_mesh::Vertex_property<int>& valence) const;
+
+    // claim vertices for the current batch, fails if one is already taken
+    bool claim(const std::vector<Surface_mesh::Vertex>& region);
+
+    // vertices of the triangles incident to edge e
+    void edge_region(Surface_mesh::Edge e, std::vector<Surface_mesh::Vertex>& region) const;
+
     void project_to_reference(Surface_mesh::Vertex v);
-    Triangle_kD_tree::Nearest_neighbor  closest_face(Surface_mesh::Vertex v);
 
     bool is_too_long  (Surface_mesh::Vertex v0, Surface_mesh::Vertex v1) const
     {
-        return distance(points_[v0], points_[v1]) > 4.0/3.0 * std::min(vsizing_[v0], vsizing_[v1]);
+        return relative_length(v0, v1) > 4.0/3.0;
     }
     bool is_too_short (Surface_mesh::Vertex v0, Surface_mesh::Vertex v1) const
     {
-        return distance(points_[v0], points_[v1]) < 4.0/5.0 * std::min(vsizing_[v0], vsizing_[v1]);
+        return relative_length(v0, v1) < 4.0/5.0;
+    }
+
+    // edge length relative to the target length, measured in the averaged
+    // metric of both vertices in anisotropic mode (1 means on target)
+    Scalar relative_length(Surface_mesh::Vertex v0, Surface_mesh::Vertex v1) const
+    {
+        if (vmetric_)
+        {
+            Sizing_metric m = vmetric_[v0];
+            m += vmetric_[v1];
+            m *= 0.5;
+            return sqrt(m.sqrlength(points_[v1] - points_[v0]));
+        }
+        return distance(points_[v0], points_[v1]) / std::min(vsizing_[v0], vsizing_[v1]);
     }
 
 
+    // queue entry of collapse_short_edges(), outdated if version differs
+    struct Collapse_entry
+    {
+        Collapse_entry(Scalar l, Surface_mesh::Edge e, unsigned int v)
+            : length(l), edge(e), version(v) {}
+
+        // std::priority_queue pops the largest element: shortest first
+        bool operator<(const Collapse_entry& rhs) const { return length > rhs.length; }
+
+        Scalar              length;
+        Surface_mesh::Edge  edge;
+        unsigned int        version;
+    };
+
+
 private:
 
     Surface_mesh&  mesh_;
-    Surface_mesh*  refmesh_;
 
     bool use_projection_;
-    Triangle_kD_tree*  kD_tree_;
+    Reference_surface*  reference_;
+
+    bool parallel_;
+    utility::Progress* progress_;
+    std::vector<unsigned int> vbatch_;
+    unsigned int batch_;
 
     bool uniform_;
     Scalar target_edge_length_;
     Scalar min_edge_length_;
     Scalar max_edge_length_;
     Scalar approx_error_;
+    Scalar gradation_;
+    bool   anisotropic_;
+    Scalar max_aspect_;
 
     Surface_mesh::Vertex_property<Point>  points_;
     Surface_mesh::Vertex_property<Point>  vnormal_;
@@ -104,10 +202,7 @@ private:
     Surface_mesh::Vertex_property<bool>   vlocked_;
     Surface_mesh::Edge_property<bool>     elocked_;
     Surface_mesh::Vertex_property<Scalar> vsizing_;
-
-    Surface_mesh::Vertex_property<Point>  refpoints_;
-    Surface_mesh::Vertex_property<Point>  refnormals_;
-    Surface_mesh::Vertex_property<Scalar> refsizing_;
+    Surface_mesh::Vertex_property<Sizing_metric> vmetric_;  // anisotropic mode only
 };
 
 
@@ -0,0 +1,381 @@
+//== INCLUDES =================================================================
+
+#include "Sizing_field.h"
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Curvature.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Geometry_cache.h>
+
+#include <cmath>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+namespace {
+
+// names of the cached properties, also used for their revision stamps
+const std::string curvature_name("v:sizing_curvature");
+const std::string principal_name("v:sizing_principal");
+
+
+// edge length for which a circle of curvature c deviates at most e from
+// the chord, clamped to [hmin, hmax]
+Scalar target_length(Scalar c, Scalar e, Scalar hmin, Scalar hmax)
+{
+    const Scalar r = 1.0 / c;
+    Scalar h;
+    if (e < r)
+    {
+        // see mathworld: "circle segment" and "equilateral triangle"
+        //h = sqrt(2.0*r*e-e*e) * 3.0 / sqrt(3.0);
+        h = sqrt(6.0*e*r - 3.0*e*e); // simplified...
+    }
+    else
+    {
+        // this does not really make sense
+        h = e * 3.0 / sqrt(3.0);
+    }
+
+    // clamp to min. and max. edge length
+    if (h < hmin) h = hmin;
+    else if (h > hmax) h = hmax;
+
+    return h;
+}
+
+
+// remove the cached property name of type T and its stamp
+template <class T>
+void remove_cached(Surface_mesh& mesh, const std::string& name)
+{
+    Surface_mesh::Vertex_property<T> p = mesh.get_vertex_property<T>(name);
+    if (p) mesh.remove_vertex_property(p);
+    mesh.remove_cache_stamp(name);
+}
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sizing_field::
+compute(Surface_mesh::Vertex_property<Scalar> sizing,
+        Surface_mesh::Vertex_property<bool>   feature,
+        Scalar approx_error,
+        Scalar min_length,
+        Scalar max_length,
+        Scalar gradation)
+{
+    Surface_mesh::Vertex_property<Scalar> curv = curvature();
+
+    // cotan weights, already computed by the curvature analysis
+    Geometry_cache cache(mesh_);
+    cache.update();
+
+    const int nv = mesh_.vertices_size();
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        if (mesh_.is_deleted(v)) continue;
+
+        // maximum absolute curvature
+        Scalar c = curv[v];
+
+
+        // curvature of feature vertices: average of non-feature neighbors
+        if (feature[v])
+        {
+            Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+            Surface_mesh::Vertex vv;
+            Scalar w, ww(0.0), cc(0.0);
+
+            vhit = vhend = mesh_.halfedges(v);
+            if (vhit) do
+            {
+                vv = mesh_.to_vertex(*vhit);
+                if (!feature[vv])
+                {
+                    w = std::max(0.0, cache.cotan(mesh_.edge(*vhit)));
+                    ww += w;
+                    cc += w * curv[vv];
+                }
+            } while (++vhit != vhend);
+
+            if (ww > 0.0) c = cc / ww;
+        }
+
+
+        // get edge length from curvature
+        sizing[v] = target_length(c, approx_error, min_length, max_length);
+    }
+
+
+    if (gradation > 0.0)
+    {
+        limit_gradation(sizing, gradation);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sizing_field::
+compute_metric(Surface_mesh::Vertex_property<Sizing_metric> metric,
+               Surface_mesh::Vertex_property<bool>   feature,
+               Scalar approx_error,
+               Scalar min_length,
+               Scalar max_length,
+               Scalar max_aspect)
+{
+    Surface_mesh::Vertex_property<Principal_curvature> pc = principal_curvature();
+
+    Geometry_cache cache(mesh_);
+    cache.update();
+
+    const int nv = mesh_.vertices_size();
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        if (mesh_.is_deleted(v)) continue;
+
+        const Principal_curvature& k = pc[v];
+
+        // short edges across the strong curvature, long ones along the weak
+        const Scalar h1 = target_length(std::max(fabs(k.kmin), fabs(k.kmax)),
+                                        approx_error, min_length, max_length);
+        const Scalar h2 = std::min(max_aspect * h1,
+                                   target_length(std::min(fabs(k.kmin), fabs(k.kmax)),
+                                                 approx_error, min_length, max_length));
+
+        // orthonormal frame: d1 across, d2 along, n normal
+        Point d1 = (fabs(k.kmax) >= fabs(k.kmin)) ? k.dmax : k.dmin;
+        Point d2 = (fabs(k.kmax) >= fabs(k.kmin)) ? k.dmin : k.dmax;
+        Sizing_metric m;
+
+        if (norm(d1) > 0.0 && norm(d2) > 0.0)
+        {
+            d1.normalize();
+            d2 -= dot(d2, d1) * d1;
+            d2.normalize();
+            m.add(d1, h1);
+            m.add(d2, h2);
+            m.add(normalize(cross(d1, d2)), h1);
+        }
+        else
+        {
+            // no directions (e.g. isolated vertex), isotropic
+            m.add(Point(1,0,0), h1);
+            m.add(Point(0,1,0), h1);
+            m.add(Point(0,0,1), h1);
+        }
+
+        metric[v] = m;
+    }
+
+
+    // metric of feature vertices: average of non-feature neighbors. read
+    // from a copy, neighbors might be feature vertices being updated.
+    std::vector<Sizing_metric> m(nv);
+    for (int i=0; i<nv; ++i)
+        m[i] = metric[Surface_mesh::Vertex(i)];
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        if (mesh_.is_deleted(v) || !feature[v]) continue;
+
+        Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+        Surface_mesh::Vertex vv;
+        Sizing_metric mm, mw;
+        Scalar w, ww(0.0);
+
+        vhit = vhend = mesh_.halfedges(v);
+        if (vhit) do
+        {
+            vv = mesh_.to_vertex(*vhit);
+            if (!feature[vv])
+            {
+                w = std::max(0.0, cache.cotan(mesh_.edge(*vhit)));
+                ww += w;
+                mw = m[vv.idx()];
+                mw *= w;
+                mm += mw;
+            }
+        } while (++vhit != vhend);
+
+        if (ww > 0.0)
+        {
+            mm *= 1.0 / ww;
+            metric[v] = mm;
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sizing_field::
+clear_cache()
+{
+    remove_cached<Scalar>(mesh_, curvature_name);
+    remove_cached<Principal_curvature>(mesh_, principal_name);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Surface_mesh::Vertex_property<Scalar>
+Sizing_field::
+curvature()
+{
+    Surface_mesh::Vertex_property<Scalar> curv = mesh_.vertex_property<Scalar>(curvature_name);
+    if (mesh_.is_cache_current(curvature_name)) return curv;
+
+    mesh_.stamp_cache(curvature_name);
+
+    // compute curvature for all mesh vertices, using Cohen-Steiner
+    // do 1 post-smoothing step to get a smoother sizing field
+    Curvature_analyzer analyzer(mesh_);
+    analyzer.analyze_tensor(1, true);
+
+    const int nv = mesh_.vertices_size();
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        curv[Surface_mesh::Vertex(i)] = analyzer.max_abs_curvature(Surface_mesh::Vertex(i));
+    }
+
+    return curv;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Surface_mesh::Vertex_property<Sizing_field::Principal_curvature>
+Sizing_field::
+principal_curvature()
+{
+    Surface_mesh::Vertex_property<Principal_curvature> pc =
+        mesh_.vertex_property<Principal_curvature>(principal_name);
+    if (mesh_.is_cache_current(principal_name)) return pc;
+
+    mesh_.stamp_cache(principal_name);
+    const int nv = mesh_.vertices_size();
+
+
+    // principal curvatures loaded from a .fld file
+    Surface_mesh::Vertex_property<Scalar>    kmin = mesh_.get_vertex_property<Scalar>("v:min curvature");
+    Surface_mesh::Vertex_property<Scalar>    kmax = mesh_.get_vertex_property<Scalar>("v:max curvature");
+    Surface_mesh::Vertex_property<Direction> dmin = mesh_.get_vertex_property<Direction>("v:min direction");
+    Surface_mesh::Vertex_property<Direction> dmax = mesh_.get_vertex_property<Direction>("v:max direction");
+
+    if (kmin && kmax && dmin && dmax)
+    {
+#pragma omp parallel for
+        for (int i=0; i<nv; ++i)
+        {
+            Surface_mesh::Vertex v(i);
+            Principal_curvature& k = pc[v];
+            k.kmin = kmin[v];  k.kmax = kmax[v];
+            k.dmin = dmin[v];  k.dmax = dmax[v];
+        }
+        return pc;
+    }
+
+
+    // otherwise analyze the curvature tensor
+    Curvature_analyzer analyzer(mesh_);
+    analyzer.analyze_tensor(1, true);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        Principal_curvature& k = pc[v];
+        k.kmin = analyzer.min_curvature(v);
+        k.kmax = analyzer.max_curvature(v);
+        k.dmin = analyzer.min_direction(v);
+        k.dmax = analyzer.max_direction(v);
+    }
+
+    return pc;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sizing_field::
+limit_gradation(Surface_mesh::Vertex_property<Scalar> sizing, Scalar gradation)
+{
+    const int nv = mesh_.vertices_size();
+    std::vector<Scalar> h(nv), h_new(nv);
+    for (int i=0; i<nv; ++i)
+        h[i] = sizing[Surface_mesh::Vertex(i)];
+
+
+    // Jacobi sweeps: h(v) = min(h(v), h(w) + gradation * |v-w|), converges
+    // after at most (graph diameter) sweeps, usually much earlier
+    for (unsigned int iter=0; iter<100; ++iter)
+    {
+        int changed = 0;
+
+#pragma omp parallel for reduction(+:changed)
+        for (int i=0; i<nv; ++i)
+        {
+            Surface_mesh::Vertex v(i);
+            Scalar hv = h[i];
+
+            if (!mesh_.is_deleted(v))
+            {
+                Surface_mesh::Vertex_around_vertex_circulator vvit, vvend;
+                vvit = vvend = mesh_.vertices(v);
+                if (vvit) do
+                {
+                    const Scalar hw = h[(*vvit).idx()] +
+                        gradation * distance(mesh_.position(v), mesh_.position(*vvit));
+                    if (hw < hv)
+                    {
+                        hv = hw;
+                        ++changed;
+                    }
+                } while (++vvit != vvend);
+            }
+
+            h_new[i] = hv;
+        }
+
+        h.swap(h_new);
+        if (!changed) break;
+    }
+
+
+    for (int i=0; i<nv; ++i)
+        sizing[Surface_mesh::Vertex(i)] = h[i];
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,136 @@
+//=============================================================================
+
+#ifndef GRAPHENE_SIZING_FIELD_H
+#define GRAPHENE_SIZING_FIELD_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Symmetric 3x3 metric tensor M, an edge vector d has length sqrt(d^T M d).
+/// M = I/h^2 describes isotropic target edge length h.
+struct Sizing_metric
+{
+    Sizing_metric() : xx(0), xy(0), xz(0), yy(0), yz(0), zz(0) {}
+
+    /// add d d^T / h^2
+    void add(const Point& d, Scalar h)
+    {
+        const Scalar w = 1.0 / (h*h);
+        xx += w*d[0]*d[0]; xy += w*d[0]*d[1]; xz += w*d[0]*d[2];
+        yy += w*d[1]*d[1]; yz += w*d[1]*d[2]; zz += w*d[2]*d[2];
+    }
+
+    /// M d
+    Point operator*(const Point& d) const
+    {
+        return Point(xx*d[0] + xy*d[1] + xz*d[2],
+                     xy*d[0] + yy*d[1] + yz*d[2],
+                     xz*d[0] + yz*d[1] + zz*d[2]);
+    }
+
+    Sizing_metric& operator+=(const Sizing_metric& m)
+    {
+        xx += m.xx; xy += m.xy; xz += m.xz; yy += m.yy; yz += m.yz; zz += m.zz;
+        return *this;
+    }
+
+    Sizing_metric& operator*=(Scalar s)
+    {
+        xx *= s; xy *= s; xz *= s; yy *= s; yz *= s; zz *= s;
+        return *this;
+    }
+
+    /// squared length of d measured in this metric
+    Scalar sqrlength(const Point& d) const { return dot(d, (*this)*d); }
+
+    Scalar xx, xy, xz, yy, yz, zz;
+};
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Curvature adapted target edge lengths for adaptive remeshing.
+/// The maximum absolute curvature is the expensive part, it is stored on the
+/// mesh as vertex property "v:sizing_curvature" (principal curvatures for
+/// the metric: "v:sizing_principal"), stamped with Surface_mesh::stamp_cache()
+/// and reused as long as Surface_mesh::revision() does not change. Copies of
+/// the mesh inherit the cache: call curvature() on the input once, then
+/// remeshing copies of it with different approximation errors skips the
+/// curvature analysis.
+class Sizing_field
+{
+public:
+
+    /// construct with mesh
+    Sizing_field(Surface_mesh& mesh) : mesh_(mesh) {}
+
+    /// Compute target edge lengths h with circle segment height approx_error,
+    /// clamped to [min_length, max_length]. Feature vertices take the
+    /// cotan-weighted curvature of their non-feature neighbors. If gradation
+    /// is positive, h is limited to |h(v)-h(w)| <= gradation * |v-w| along edges.
+    void compute(Surface_mesh::Vertex_property<Scalar> sizing,
+                 Surface_mesh::Vertex_property<bool>   feature,
+                 Scalar approx_error,
+                 Scalar min_length,
+                 Scalar max_length,
+                 Scalar gradation=0.0);
+
+    /// Compute anisotropic metric: target length along each principal
+    /// direction from its curvature as in compute(), the ratio of the two
+    /// lengths limited to max_aspect. Uses the curvatures and directions
+    /// of a .fld file if present, the curvature tensor otherwise.
+    void compute_metric(Surface_mesh::Vertex_property<Sizing_metric> metric,
+                        Surface_mesh::Vertex_property<bool>   feature,
+                        Scalar approx_error,
+                        Scalar min_length,
+                        Scalar max_length,
+                        Scalar max_aspect=10.0);
+
+    /// maximum absolute curvature, cached on the mesh, recomputed if outdated
+    Surface_mesh::Vertex_property<Scalar> curvature();
+
+    /// principal curvatures and directions
+    struct Principal_curvature
+    {
+        Scalar     kmin, kmax;
+        Direction  dmin, dmax;
+    };
+
+    /// principal curvatures, cached on the mesh like curvature()
+    Surface_mesh::Vertex_property<Principal_curvature> principal_curvature();
+
+    /// remove the cached curvature from the mesh
+    void clear_cache();
+
+
+private:
+
+    // smooth out jumps larger than gradation times edge length
+    void limit_gradation(Surface_mesh::Vertex_property<Scalar> sizing, Scalar gradation);
+
+
+private:
+
+    Surface_mesh& mesh_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif
+//=============================================================================
@@ -0,0 +1,136 @@
+//== INCLUDES =================================================================
+
+#include "Fairing.h"
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Laplace.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+Fairing::Fairing(Surface_mesh& mesh)
+    : mesh_(mesh), initialized_(false), timestep_(0.0), revision_(0)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Fairing::
+setup(Scalar timestep)
+{
+    const int nv = mesh_.vertices_size();
+
+    Surface_mesh::Vertex_property<bool> vfeature  = mesh_.get_vertex_property<bool>("v:feature");
+    Surface_mesh::Vertex_property<bool> vselected = mesh_.get_vertex_property<bool>("v:selected");
+
+    bool has_selection = false;
+    if (vselected)
+    {
+        for (int i=0; i<nv; ++i)
+        {
+            if (vselected[Surface_mesh::Vertex(i)])
+            {
+                has_selection = true;
+                break;
+            }
+        }
+    }
+
+
+    // locked vertices
+    fixed_.resize(nv);
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        fixed_[i] = (mesh_.is_deleted(v) ||
+                     mesh_.is_isolated(v) ||
+                     mesh_.is_boundary(v) ||
+                     (vfeature && vfeature[v]) ||
+                     (has_selection && !vselected[v]));
+    }
+
+
+    // A = M - t L
+    const Scalar h = mean_edge_length(mesh_);
+    cotan_laplace(mesh_, A_);
+    A_.scale(-timestep * h * h);
+    mass_matrix(mesh_, mass_);
+    A_.add_diagonal(mass_);
+
+    Sparse_matrix A = A_;
+    A.constrain(fixed_);
+    solver_.factorize(A);
+
+
+    initialized_ = true;
+    timestep_    = timestep;
+    revision_    = mesh_.revision();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Fairing::
+implicit_smoothing(Scalar timestep, unsigned int iterations)
+{
+    if (!initialized_ ||
+        timestep != timestep_ ||
+        revision_ != mesh_.revision() ||
+        A_.rows() != mesh_.vertices_size())
+    {
+        setup(timestep);
+    }
+
+
+    const int nv = mesh_.vertices_size();
+    Surface_mesh::Vertex_property<Point> points = mesh_.vertex_property<Point>("v:point");
+    bool ok = true;
+
+    for (unsigned int iter=0; iter<iterations; ++iter)
+    {
+        // solve for the three coordinates in parallel
+#pragma omp parallel for reduction(&&:ok)
+        for (int c=0; c<3; ++c)
+        {
+            std::vector<double> x(nv), b(nv);
+            for (int i=0; i<nv; ++i)
+            {
+                x[i] = points[Surface_mesh::Vertex(i)][c];
+                b[i] = mass_[i] * x[i];
+            }
+            A_.constrain_rhs(fixed_, x, b);
+
+            // current positions are a good initial guess
+            ok = solver_.solve(b, x) && ok;
+
+            for (int i=0; i<nv; ++i)
+            {
+                if (!fixed_[i])
+                    points[Surface_mesh::Vertex(i)][c] = x[i];
+            }
+        }
+    }
+
+
+    // moved the vertices, but keep the factorization
+    mesh_.geometry_changed();
+    revision_ = mesh_.revision();
+
+    return ok;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
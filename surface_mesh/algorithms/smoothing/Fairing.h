@@ -0,0 +1,68 @@
+//=============================================================================
+
+#ifndef GRAPHENE_FAIRING_H
+#define GRAPHENE_FAIRING_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Sparse_matrix.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Implicit fairing (Desbrun et al. 1999): backward Euler steps of the
+/// curvature flow, (M - t L) x' = M x with cotan Laplace L and mass matrix
+/// M. Boundary and feature vertices stay fixed, as do unselected vertices
+/// if there is a selection ("v:selected").
+/// The system is assembled and factorized for the first step and reused
+/// by further steps with the same time step, the weights are kept from the
+/// first step. It is rebuilt if somebody else changed the mesh revision.
+class Fairing
+{
+public:
+
+    /// construct with mesh to be smoothed
+    Fairing(Surface_mesh& mesh);
+
+    /// smooth with iterations steps of size timestep * (mean edge length)^2.
+    /// false if the solver did not converge.
+    bool implicit_smoothing(Scalar timestep, unsigned int iterations=1);
+
+
+private:
+
+    // assemble and factorize M - t L
+    void setup(Scalar timestep);
+
+
+private:
+
+    Surface_mesh&  mesh_;
+
+    bool           initialized_;
+    Scalar         timestep_;
+    unsigned int   revision_;
+
+    Sparse_matrix      A_;        // M - t L, unconstrained
+    Sparse_cg          solver_;   // for constrained A_
+    std::vector<double> mass_;
+    std::vector<bool>  fixed_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_FAIRING_H
+//=============================================================================
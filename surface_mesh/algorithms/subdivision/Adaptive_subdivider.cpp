@@ -0,0 +1,530 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/Adaptive_subdivider.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Curvature.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Geodesics.h>
+
+#include <algorithm>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+Adaptive_subdivider::
+Adaptive_subdivider(Surface_mesh& mesh)
+    : mesh_(mesh),
+      curvature_angle_(0.0),
+      width_(0), height_(0), max_pixels_(0.0),
+      feature_distance_(0.0),
+      min_edge_length_(0.0)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Adaptive_subdivider::
+refine(unsigned int max_steps)
+{
+    unsigned int steps = 0;
+    while (steps < max_steps && refine())
+        ++steps;
+    return steps;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Adaptive_subdivider::
+refine()
+{
+    typedef Surface_mesh::Vertex    Vertex;
+    typedef Surface_mesh::Halfedge  Halfedge;
+    typedef Surface_mesh::Edge      Edge;
+
+    if (!mesh_.is_triangle_mesh())
+        return false;
+
+    points_   = mesh_.vertex_property<Point>("v:point");
+    vfeature_ = mesh_.get_vertex_property<bool>("v:feature");
+    efeature_ = mesh_.get_edge_property<bool>("e:feature");
+    hgreen_   = mesh_.halfedge_property<bool>("adapt:green", false);
+    esplit_   = mesh_.add_edge_property<bool>("adapt:split", false);
+
+    if (efeature_ && !vfeature_)
+        vfeature_ = mesh_.add_vertex_property<bool>("v:feature", false);
+
+
+    // which edges to split
+    std::vector<char> marked;
+    mark_faces(marked);
+    closure(marked);
+
+
+    // positions of the new vertices, before the mesh changes
+    const int nv = mesh_.vertices_size();
+    const int ne = mesh_.edges_size();
+    std::vector<Point> epoints(ne);
+
+#pragma omp parallel for
+    for (int i=0; i<ne; ++i)
+    {
+        Edge e(i);
+        if (!mesh_.is_deleted(e) && esplit_[e])
+            epoints[i] = edge_point(e);
+    }
+
+
+    // split edges. the edges from the new vertices to the opposite corners
+    // are the candidates for flips and green bisections.
+    std::vector<Edge> cross;
+    bool refined = false;
+
+    for (int i=0; i<ne; ++i)
+    {
+        Edge e(i);
+        if (mesh_.is_deleted(e) || !esplit_[e]) continue;
+
+        const Vertex a       = mesh_.vertex(e, 0);
+        const Vertex b       = mesh_.vertex(e, 1);
+        const bool   feature = efeature_ && efeature_[e];
+
+        Vertex v = mesh_.add_vertex(epoints[i]);
+        mesh_.split(e, v);
+
+        for (auto h: mesh_.halfedges(v))
+        {
+            const Vertex w = mesh_.to_vertex(h);
+            if (w == a || w == b)
+            {
+                if (feature) efeature_[mesh_.edge(h)] = true;
+            }
+            else
+            {
+                cross.push_back(mesh_.edge(h));
+            }
+        }
+
+        if (feature) vfeature_[v] = true;
+        refined = true;
+    }
+
+    mesh_.remove_edge_property(esplit_);
+
+
+    // flip the edge between the new vertices of a red face. for a green
+    // pair whose parent is refined this removes the old bisection.
+    std::vector<Edge> flips(cross);
+    for (auto h: mesh_.halfedges())
+    {
+        if (hgreen_[h])
+            flips.push_back(mesh_.edge(h));
+    }
+
+    std::vector<bool> flipped(mesh_.edges_size(), false);
+    for (unsigned int i=0; i<flips.size(); ++i)
+    {
+        const Edge e = flips[i];
+        if (flipped[e.idx()] || mesh_.is_boundary(e)) continue;
+
+        const Halfedge h0 = mesh_.halfedge(e, 0);
+        const Halfedge h1 = mesh_.halfedge(e, 1);
+        const Vertex   c0 = mesh_.to_vertex(mesh_.next_halfedge(h0));
+        const Vertex   c1 = mesh_.to_vertex(mesh_.next_halfedge(h1));
+
+        if (c0.idx() >= nv && c1.idx() >= nv && mesh_.is_flip_ok(e))
+        {
+            mesh_.flip(e);
+            hgreen_[h0] = hgreen_[h1] = false;
+            flipped[e.idx()] = true;
+        }
+    }
+
+
+    // the remaining edges from a new vertex to an old one bisect a green pair
+    for (unsigned int i=0; i<cross.size(); ++i)
+    {
+        const Edge e = cross[i];
+        if (flipped[e.idx()]) continue;
+
+        const Halfedge h0 = mesh_.halfedge(e, 0);
+        const Halfedge h1 = mesh_.halfedge(e, 1);
+        const bool     n0 = mesh_.to_vertex(h0).idx() >= nv;
+        const bool     n1 = mesh_.to_vertex(h1).idx() >= nv;
+
+        if (n0 != n1 && !mesh_.is_boundary(e))
+        {
+            hgreen_[h0] = n1;
+            hgreen_[h1] = n0;
+        }
+    }
+
+
+    if (refined)
+        mesh_.geometry_changed();
+
+    return refined;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Adaptive_subdivider::
+mark_faces(std::vector<char>& marked)
+{
+    const int nv = mesh_.vertices_size();
+    const int nf = mesh_.faces_size();
+
+    marked.assign(nf, false);
+
+
+    // curvature of the current mesh
+    Curvature_analyzer curvature(mesh_);
+    if (curvature_angle_ > 0.0)
+        curvature.analyze(1);
+
+
+    // vertices close to feature lines
+    std::vector<char> near(nv, false);
+    if (feature_distance_ > 0.0)
+    {
+        std::vector<bool> source(nv, false);
+        for (auto h: mesh_.fhalfedges())
+        {
+            Surface_mesh::Face f = mesh_.face(h);
+            if (f.is_valid() && f.idx() < nf && !mesh_.is_deleted(f))
+            {
+                for (auto v: mesh_.vertices(f))
+                    source[v.idx()] = true;
+            }
+        }
+        if (efeature_)
+        {
+            for (auto e: mesh_.edges())
+            {
+                if (efeature_[e])
+                    source[mesh_.vertex(e,0).idx()] = source[mesh_.vertex(e,1).idx()] = true;
+            }
+        }
+
+        std::vector<Surface_mesh::Vertex> sources, vertices;
+        for (int i=0; i<nv; ++i)
+            if (source[i])
+                sources.push_back(Surface_mesh::Vertex(i));
+
+        Geodesics(mesh_).ball(sources, feature_distance_, vertices);
+        for (unsigned int i=0; i<vertices.size(); ++i)
+            near[vertices[i].idx()] = true;
+    }
+
+
+    const Scalar max_angle = curvature_angle_ / 180.0 * M_PI;
+
+#pragma omp parallel for
+    for (int i=0; i<nf; ++i)
+    {
+        Surface_mesh::Face f(i);
+        if (mesh_.is_deleted(f)) continue;
+
+        Surface_mesh::Vertex_around_face_circulator fvit = mesh_.vertices(f);
+        const Surface_mesh::Vertex v0 = *fvit;
+        const Surface_mesh::Vertex v1 = *(++fvit);
+        const Surface_mesh::Vertex v2 = *(++fvit);
+        const Point p[3] = { points_[v0], points_[v1], points_[v2] };
+
+        const Scalar l = std::max(distance(p[0], p[1]),
+                                  std::max(distance(p[1], p[2]), distance(p[2], p[0])));
+        if (l <= min_edge_length_) continue;
+
+
+        // curvature
+        if (curvature_angle_ > 0.0)
+        {
+            const Scalar k = std::max(curvature.max_abs_curvature(v0),
+                                      std::max(curvature.max_abs_curvature(v1),
+                                               curvature.max_abs_curvature(v2)));
+            if (k * l > max_angle)
+            {
+                marked[i] = true;
+                continue;
+            }
+        }
+
+
+        // screen-space size, corners behind the viewer are ignored
+        if (max_pixels_ > 0.0)
+        {
+            Vec2f  q[3];
+            bool   visible[3];
+            for (int j=0; j<3; ++j)
+            {
+                const Vec4f c = modelviewproj_ * Vec4f(p[j][0], p[j][1], p[j][2], 1.0);
+                visible[j] = (c[3] > 0.0);
+                if (visible[j])
+                    q[j] = Vec2f(0.5 * width_ * c[0] / c[3], 0.5 * height_ * c[1] / c[3]);
+            }
+
+            for (int j=0; j<3; ++j)
+            {
+                if (visible[j] && visible[(j+1)%3] && norm(q[j] - q[(j+1)%3]) > max_pixels_)
+                    marked[i] = true;
+            }
+            if (marked[i]) continue;
+        }
+
+
+        // proximity to feature lines
+        if (near[v0.idx()] || near[v1.idx()] || near[v2.idx()])
+            marked[i] = true;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Adaptive_subdivider::
+closure(const std::vector<char>& marked)
+{
+    std::vector<Surface_mesh::Face> queue;
+
+
+    // red faces, or the parents of marked green faces
+    for (unsigned int i=0; i<marked.size(); ++i)
+    {
+        if (!marked[i]) continue;
+
+        Surface_mesh::Face f(i);
+        Surface_mesh::Halfedge g = green_halfedge(f);
+        if (g.is_valid())
+        {
+            mark_edge(mesh_.edge(mesh_.next_halfedge(g)), queue);
+            mark_edge(mesh_.edge(mesh_.prev_halfedge(mesh_.opposite_halfedge(g))), queue);
+        }
+        else
+        {
+            for (auto h: mesh_.halfedges(f))
+                mark_edge(mesh_.edge(h), queue);
+        }
+    }
+
+
+    // faces with two split edges become red, green pairs with any split
+    // edge are replaced by their parent
+    while (!queue.empty())
+    {
+        Surface_mesh::Face f = queue.back();
+        queue.pop_back();
+
+        Surface_mesh::Halfedge g = green_halfedge(f);
+        Surface_mesh::Edge     ge;
+        if (g.is_valid()) ge = mesh_.edge(g);
+
+        int n = 0;
+        for (auto h: mesh_.halfedges(f))
+        {
+            if (esplit_[mesh_.edge(h)] && mesh_.edge(h) != ge)
+                ++n;
+        }
+
+        if (g.is_valid() && n > 0)
+        {
+            mark_edge(mesh_.edge(mesh_.next_halfedge(g)), queue);
+            mark_edge(mesh_.edge(mesh_.prev_halfedge(mesh_.opposite_halfedge(g))), queue);
+        }
+
+        if (n >= 2)
+        {
+            for (auto h: mesh_.halfedges(f))
+            {
+                if (mesh_.edge(h) != ge)
+                    mark_edge(mesh_.edge(h), queue);
+            }
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Adaptive_subdivider::
+mark_edge(Surface_mesh::Edge e, std::vector<Surface_mesh::Face>& queue)
+{
+    if (esplit_[e]) return;
+    esplit_[e] = true;
+
+    for (int i=0; i<2; ++i)
+    {
+        Surface_mesh::Face f = mesh_.face(e, i);
+        if (f.is_valid())
+            queue.push_back(f);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Surface_mesh::Halfedge
+Adaptive_subdivider::
+green_halfedge(Surface_mesh::Face f) const
+{
+    for (auto h: mesh_.halfedges(f))
+    {
+        if (hgreen_[h])
+            return h;
+        if (hgreen_[mesh_.opposite_halfedge(h)])
+            return mesh_.opposite_halfedge(h);
+    }
+    return Surface_mesh::Halfedge();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Point
+Adaptive_subdivider::
+edge_point(Surface_mesh::Edge e) const
+{
+    typedef Surface_mesh::Vertex    Vertex;
+    typedef Surface_mesh::Halfedge  Halfedge;
+
+    const Halfedge h = mesh_.halfedge(e, 0);   // a -> b
+    const Halfedge o = mesh_.halfedge(e, 1);   // b -> a
+    const Vertex   a = mesh_.to_vertex(o);
+    const Vertex   b = mesh_.to_vertex(h);
+
+    if (is_curve(e))
+        return curve_point(h);
+
+
+    // endpoints with a full, smooth one-ring
+    bool regular[2], usable[2];
+    const Vertex ab[2] = { a, b };
+    for (int i=0; i<2; ++i)
+    {
+        usable[i]  = !mesh_.is_boundary(ab[i]) && !(vfeature_ && vfeature_[ab[i]]);
+        regular[i] = usable[i] && mesh_.valence(ab[i]) == 6;
+    }
+
+
+    // 8-point butterfly between regular vertices
+    if (regular[0] && regular[1])
+    {
+        const Halfedge wings[4] = { mesh_.next_halfedge(h), mesh_.prev_halfedge(h),
+                                    mesh_.next_halfedge(o), mesh_.prev_halfedge(o) };
+        bool ok = true;
+        for (int i=0; i<4; ++i)
+            ok = ok && !mesh_.is_boundary(mesh_.opposite_halfedge(wings[i]));
+
+        if (ok)
+        {
+            Point p = 0.5   * (points_[a] + points_[b]);
+            p      += 0.125 * (points_[mesh_.to_vertex(wings[0])] + points_[mesh_.to_vertex(wings[2])]);
+            for (int i=0; i<4; ++i)
+                p  -= 0.0625 * points_[mesh_.to_vertex(mesh_.next_halfedge(mesh_.opposite_halfedge(wings[i])))];
+            return p;
+        }
+    }
+
+
+    // otherwise average the rules of the irregular (or usable) endpoints
+    Point p(0,0,0);
+    int   n = 0;
+    const Halfedge start[2] = { h, o };
+    for (int i=0; i<2; ++i)
+    {
+        if (!usable[i]) continue;
+
+        const unsigned int k = mesh_.valence(ab[i]);
+        Point q = 0.75 * points_[ab[i]];
+        Halfedge hh = start[i];
+        for (unsigned int j=0; j<k; ++j, hh=mesh_.ccw_rotated_halfedge(hh))
+        {
+            Scalar s;
+            if (k == 3)
+                s = (j == 0) ? 5.0/12.0 : -1.0/12.0;
+            else if (k == 4)
+                s = (j == 0) ? 0.375 : (j == 2 ? -0.125 : 0.0);
+            else
+                s = (0.25 + ::cos(2.0*M_PI*j/k) + 0.5*::cos(4.0*M_PI*j/k)) / k;
+
+            q += s * points_[mesh_.to_vertex(hh)];
+        }
+
+        p += q;
+        ++n;
+    }
+
+    if (n)
+        return p / Scalar(n);
+
+    return 0.5 * (points_[a] + points_[b]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Point
+Adaptive_subdivider::
+curve_point(Surface_mesh::Halfedge h) const
+{
+    const Surface_mesh::Vertex a  = mesh_.from_vertex(h);
+    const Surface_mesh::Vertex b  = mesh_.to_vertex(h);
+    const Surface_mesh::Vertex aa = curve_neighbor(a, b);
+    const Surface_mesh::Vertex bb = curve_neighbor(b, a);
+
+    if (aa.is_valid() && bb.is_valid())
+    {
+        return 0.5625 * (points_[a] + points_[b]) - 0.0625 * (points_[aa] + points_[bb]);
+    }
+
+    return 0.5 * (points_[a] + points_[b]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Surface_mesh::Vertex
+Adaptive_subdivider::
+curve_neighbor(Surface_mesh::Vertex v, Surface_mesh::Vertex w) const
+{
+    Surface_mesh::Vertex result;
+    int n = 0;
+
+    for (auto h: mesh_.halfedges(v))
+    {
+        if (is_curve(mesh_.edge(h)))
+        {
+            ++n;
+            if (mesh_.to_vertex(h) != w)
+                result = mesh_.to_vertex(h);
+        }
+    }
+
+    return (n == 2) ? result : Surface_mesh::Vertex();
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,130 @@
+//=============================================================================
+
+#ifndef GRAPHENE_ADAPTIVE_SUBDIVIDER_H
+#define GRAPHENE_ADAPTIVE_SUBDIVIDER_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/geometry/Matrix4x4.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Adaptive interpolating subdivision of triangle meshes. Only faces that
+/// fail one of the criteria are split 1-to-4 (red), their neighbours are
+/// bisected (green) to keep the mesh conforming. Before a green pair is
+/// refined further its bisection is removed again, so the triangle quality
+/// does not degrade over several steps. Green bisections are remembered in
+/// the halfedge property "adapt:green", on the halfedge from the edge
+/// midpoint to the opposite corner.
+///
+/// New vertices are placed by the modified butterfly scheme, old vertices
+/// never move. Boundaries and feature edges ("e:feature") are refined by
+/// the 4-point rule along the curve.
+class Adaptive_subdivider
+{
+public:
+
+    /// constructor
+    Adaptive_subdivider(Surface_mesh& mesh);
+
+    /// refine faces whose longest edge times the largest absolute curvature
+    /// at their corners, i.e. the angle the edge spans on the osculating
+    /// circle, exceeds angle (in degrees). 0 disables.
+    void set_curvature_threshold(Scalar angle) { curvature_angle_ = angle; }
+
+    /// refine faces with an edge longer than max_pixels on screen, for the
+    /// given modelview-projection matrix and viewport size. 0 disables.
+    void set_view(const Mat4f& modelviewproj,
+                  unsigned int width, unsigned int height,
+                  Scalar max_pixels)
+    {
+        modelviewproj_ = modelviewproj;
+        width_         = width;
+        height_        = height;
+        max_pixels_    = max_pixels;
+    }
+
+    /// refine faces within geodesic distance radius of the ridge and ravine
+    /// lines and feature edges. 0 disables.
+    void set_feature_distance(Scalar radius) { feature_distance_ = radius; }
+
+    /// faces whose edges are all shorter than length are not refined by the
+    /// criteria (only to keep the mesh conforming)
+    void set_min_edge_length(Scalar length) { min_edge_length_ = length; }
+
+    /// one step of refinement, false if no face was refined
+    bool refine();
+
+    /// refine until no face fails the criteria, at most max_steps steps.
+    /// returns the number of steps.
+    unsigned int refine(unsigned int max_steps);
+
+
+private:
+
+    // faces failing one of the criteria
+    void mark_faces(std::vector<char>& marked);
+
+    // mark edges such that every face has 0, 1 or 3 split edges, resolves
+    // green pairs whose parent has to be refined
+    void closure(const std::vector<char>& marked);
+
+    // the green bisection of f (from the midpoint to the corner), invalid
+    // if f is not half of a green pair
+    Surface_mesh::Halfedge green_halfedge(Surface_mesh::Face f) const;
+
+    // mark e for splitting, queue the adjacent faces
+    void mark_edge(Surface_mesh::Edge e, std::vector<Surface_mesh::Face>& queue);
+
+    // butterfly point of e
+    Point edge_point(Surface_mesh::Edge e) const;
+
+    // along a boundary or feature curve
+    Point curve_point(Surface_mesh::Halfedge h) const;
+
+    // other curve neighbour of v, coming from w. invalid if not unique.
+    Surface_mesh::Vertex curve_neighbor(Surface_mesh::Vertex v, Surface_mesh::Vertex w) const;
+
+    // whether e is a boundary or feature edge
+    bool is_curve(Surface_mesh::Edge e) const
+    {
+        return mesh_.is_boundary(e) || (efeature_ && efeature_[e]);
+    }
+
+
+private:
+
+    Surface_mesh&  mesh_;
+
+    Scalar        curvature_angle_;
+    Mat4f         modelviewproj_;
+    unsigned int  width_, height_;
+    Scalar        max_pixels_;
+    Scalar        feature_distance_;
+    Scalar        min_edge_length_;
+
+    Surface_mesh::Vertex_property<Point>  points_;
+    Surface_mesh::Vertex_property<bool>   vfeature_;
+    Surface_mesh::Edge_property<bool>     efeature_;
+    Surface_mesh::Edge_property<bool>     esplit_;
+    Surface_mesh::Halfedge_property<bool> hgreen_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_ADAPTIVE_SUBDIVIDER_H
+//=============================================================================
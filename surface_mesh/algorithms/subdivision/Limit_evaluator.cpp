@@ -0,0 +1,1255 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/Limit_evaluator.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <map>
+#include <utility>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+namespace {
+
+typedef Surface_mesh::Vertex    Vertex;
+typedef Surface_mesh::Halfedge  Halfedge;
+typedef Surface_mesh::Face      Face;
+
+typedef std::vector< std::pair<unsigned int, Scalar> > Stencil;
+
+
+// one-sided masks up to this number of faces are precomputed
+const unsigned int max_cross_masks = 32;
+
+// local refinement steps of evaluate() before the limit points of the
+// sub-face corners are interpolated
+const unsigned int max_levels = 10;
+
+
+// true if the mesh has no deleted elements
+bool is_compact(const Surface_mesh& mesh)
+{
+    return (mesh.n_vertices() == mesh.vertices_size() &&
+            mesh.n_edges()    == mesh.edges_size()    &&
+            mesh.n_faces()    == mesh.faces_size());
+}
+
+
+// boundary or feature edge
+bool is_curve(const Surface_mesh& mesh,
+              Surface_mesh::Edge_property<bool> efeature,
+              Surface_mesh::Edge e)
+{
+    return mesh.is_boundary(e) || (efeature && efeature[e]);
+}
+
+
+// sum up the weights of the same vertex
+void compress(Stencil& s)
+{
+    std::sort(s.begin(), s.end());
+
+    unsigned int n = 0;
+    for (unsigned int i=0; i<s.size(); ++i)
+    {
+        if (n && s[n-1].first == s[i].first)
+            s[n-1].second += s[i].second;
+        else
+            s[n++] = s[i];
+    }
+    s.resize(n);
+}
+
+
+// append w times s to result
+void add(Stencil& result, double w, const Stencil& s)
+{
+    for (unsigned int i=0; i<s.size(); ++i)
+        result.push_back(std::make_pair(s[i].first, Scalar(w * s[i].second)));
+}
+
+
+// centroid of f
+void add_face_point(const Surface_mesh& mesh, Face f, Scalar w, Stencil& s)
+{
+    const Scalar n = mesh.valence(f);
+    for (auto v: mesh.vertices(f))
+        s.push_back(std::make_pair(v.idx(), w/n));
+}
+
+
+// apply a stencil to points
+template <class Table>
+Point apply_stencil(const Table& table, unsigned int i, const std::vector<Point>& points)
+{
+    Point p(0,0,0);
+    for (unsigned int j=table.offset[i]; j<table.offset[i+1]; ++j)
+        p += table.weight[j] * points[table.index[j]];
+    return p;
+}
+
+Point apply_stencil(const Stencil& s, const std::vector<Point>& points)
+{
+    Point p(0,0,0);
+    for (unsigned int j=0; j<s.size(); ++j)
+        p += s[j].second * points[s[j].first];
+    return p;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// cross tangent mask of a one-sided ring with k faces, laid out as in
+// ring_stencils(): the symmetric eigenvector of the subdivision matrix with
+// the largest eigenvalue below 1, pointing into the faces
+void cross_mask(bool catmull_clark, unsigned int k, std::vector<double>& mask)
+{
+    typedef std::vector< std::pair<unsigned int, double> > Row;
+
+    const unsigned int n = catmull_clark ? 2*k+2 : k+2;
+    std::vector<Row> rows(n);
+
+
+    // the ring as function of the ring of the previous level
+    rows[0].push_back(std::make_pair(0,   0.75));
+    rows[0].push_back(std::make_pair(1,   0.125));
+    rows[0].push_back(std::make_pair(n-1, 0.125));
+
+    rows[1].push_back(std::make_pair(0, 0.5));
+    rows[1].push_back(std::make_pair(1, 0.5));
+    rows[n-1].push_back(std::make_pair(0,   0.5));
+    rows[n-1].push_back(std::make_pair(n-1, 0.5));
+
+    if (catmull_clark)
+    {
+        // edge points 1+2i, face points 2+2i
+        for (unsigned int i=0; i<k; ++i)
+        {
+            const unsigned int face[4] = { 0, 1+2*i, 2+2*i, 3+2*i };
+            for (unsigned int j=0; j<4; ++j)
+            {
+                rows[2+2*i].push_back(std::make_pair(face[j], 0.25));
+                if (i > 0)   rows[1+2*i].push_back(std::make_pair(face[j], 0.0625));
+                if (i+1 < k) rows[3+2*i].push_back(std::make_pair(face[j], 0.0625));
+            }
+        }
+        for (unsigned int i=1; i<k; ++i)
+        {
+            rows[1+2*i].push_back(std::make_pair(0,     0.25));
+            rows[1+2*i].push_back(std::make_pair(1+2*i, 0.25));
+        }
+    }
+    else
+    {
+        for (unsigned int i=1; i<k; ++i)
+        {
+            rows[1+i].push_back(std::make_pair(0,   0.375));
+            rows[1+i].push_back(std::make_pair(1+i, 0.375));
+            rows[1+i].push_back(std::make_pair(i,   0.125));
+            rows[1+i].push_back(std::make_pair(2+i, 0.125));
+        }
+    }
+
+
+    // power iteration on the symmetric vectors that sum to zero, the
+    // tangent along the curve is antisymmetric. both properties are
+    // restored in every step, otherwise round-off grows into the limit
+    // position mask (eigenvalue 1) or the curve tangent (eigenvalue 1/2).
+    // ring entry i is mirrored to n-i.
+    mask.assign(n, 1.0/(n-1));
+    mask[0] = -1.0;
+
+    std::vector<double> next(n);
+    for (unsigned int iter=0; iter<10000; ++iter)
+    {
+        std::fill(next.begin(), next.end(), 0.0);
+        for (unsigned int i=0; i<n; ++i)
+            for (unsigned int j=0; j<rows[i].size(); ++j)
+                next[rows[i][j].first] += mask[i] * rows[i][j].second;
+
+        for (unsigned int i=1; 2*i<=n; ++i)
+            next[i] = next[n-i] = 0.5 * (next[i] + next[n-i]);
+
+        double mean = 0.0;
+        for (unsigned int i=0; i<n; ++i)
+            mean += next[i];
+        mean /= n;
+
+        double l = 0.0, d = 0.0;
+        for (unsigned int i=0; i<n; ++i)
+        {
+            next[i] -= mean;
+            l += next[i]*next[i];
+        }
+        l = sqrt(l);
+        for (unsigned int i=0; i<n; ++i)
+        {
+            next[i] /= l;
+            d = std::max(d, fabs(next[i]-mask[i]));
+        }
+
+        mask.swap(next);
+        if (d < 1e-12) break;
+    }
+
+
+    // orient such that the tangent along the curve, ring entry 1 minus entry
+    // n-1, cross this one gives the normal on the side from which the ring
+    // is ccw. the ring is laid out ccw on a quarter disk, where the curve
+    // tangent is (1,-1); on a half disk a single face would be degenerate.
+    double tx = 0.0, ty = 0.0;
+    for (unsigned int i=1; i<n; ++i)
+    {
+        const double a = 0.5 * M_PI * (i-1) / (n-2);
+        tx += mask[i] * cos(a);
+        ty += mask[i] * sin(a);
+    }
+    if (tx + ty < 0.0)
+    {
+        for (unsigned int i=0; i<n; ++i)
+            mask[i] = -mask[i];
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// the ring of v, split into sectors at boundaries and at the feature edges
+// of crease vertices. a sector lists the outgoing halfedges in ccw order,
+// the face of each halfedge lies between it and the next one. returns
+// false for corners, whose sectors are the single faces.
+bool ring_sectors(const Surface_mesh& mesh,
+                  Surface_mesh::Vertex_property<bool> vfeature,
+                  Surface_mesh::Edge_property<bool> efeature,
+                  Vertex v, bool& closed,
+                  std::vector< std::vector<Halfedge> >& sectors)
+{
+    sectors.clear();
+    closed = false;
+
+    if (mesh.is_isolated(v))
+        return false;
+
+
+    // boundary vertex, from the boundary halfedge back to it
+    if (mesh.is_boundary(v))
+    {
+        const Halfedge h0 = mesh.halfedge(v);
+        sectors.resize(1);
+        Halfedge h = h0;
+        do
+        {
+            h = mesh.ccw_rotated_halfedge(h);
+            sectors[0].push_back(h);
+        }
+        while (h != h0);
+        return true;
+    }
+
+
+    std::vector<Halfedge> ring;
+    for (auto h: mesh.halfedges(v))
+        ring.push_back(h);
+
+
+    // smooth vertex
+    if (!vfeature || !vfeature[v])
+    {
+        sectors.push_back(ring);
+        closed = true;
+        return true;
+    }
+
+
+    std::vector<unsigned int> features;
+    for (unsigned int i=0; i<ring.size(); ++i)
+    {
+        if (efeature && efeature[mesh.edge(ring[i])])
+            features.push_back(i);
+    }
+
+
+    // crease vertex, two sectors between the feature edges
+    if (features.size() == 2)
+    {
+        const unsigned int n = ring.size();
+        sectors.resize(2);
+        for (unsigned int s=0; s<2; ++s)
+        {
+            unsigned int i = features[s];
+            sectors[s].push_back(ring[i]);
+            do
+            {
+                i = (i+1) % n;
+                sectors[s].push_back(ring[i]);
+            }
+            while (i != features[1-s]);
+        }
+        return true;
+    }
+
+
+    // corner
+    for (unsigned int i=0; i<ring.size(); ++i)
+    {
+        std::vector<Halfedge> face(2);
+        face[0] = ring[i];
+        face[1] = ring[(i+1) % ring.size()];
+        sectors.push_back(face);
+    }
+    return false;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// stencils of the ring of a sector around v: the center, followed per
+// halfedge by the other vertex of its edge (Loop). For Catmull-Clark the
+// ring after one step, which only has quads: the center, followed per
+// halfedge by the edge point and the face point.
+void ring_stencils(const Surface_mesh& mesh, bool catmull_clark,
+                   Surface_mesh::Edge_property<bool> efeature,
+                   Vertex v, bool closed,
+                   const std::vector<Halfedge>& sector,
+                   std::vector<Stencil>& ring)
+{
+    const unsigned int n = sector.size();
+    ring.clear();
+
+    if (!catmull_clark)
+    {
+        ring.resize(n+1);
+        ring[0].push_back(std::make_pair(v.idx(), 1.0));
+        for (unsigned int i=0; i<n; ++i)
+            ring[1+i].push_back(std::make_pair(mesh.to_vertex(sector[i]).idx(), 1.0));
+        return;
+    }
+
+    const unsigned int nf = closed ? n : n-1;
+    ring.resize(1 + n + nf);
+
+
+    // vertex point
+    Stencil& c = ring[0];
+    if (closed)
+    {
+        const Scalar k = n;
+        c.push_back(std::make_pair(v.idx(), (k-3)/k));
+        for (unsigned int i=0; i<n; ++i)
+        {
+            add_face_point(mesh, mesh.face(sector[i]), 1.0/(k*k), c);
+            c.push_back(std::make_pair(v.idx(),                        1.0/(k*k)));
+            c.push_back(std::make_pair(mesh.to_vertex(sector[i]).idx(), 1.0/(k*k)));
+        }
+    }
+    else
+    {
+        c.push_back(std::make_pair(v.idx(), 0.75));
+        c.push_back(std::make_pair(mesh.to_vertex(sector[0]).idx(),   0.125));
+        c.push_back(std::make_pair(mesh.to_vertex(sector[n-1]).idx(), 0.125));
+    }
+
+
+    // edge and face points
+    for (unsigned int i=0; i<n; ++i)
+    {
+        const Halfedge h = sector[i];
+
+        Stencil& e = ring[1+2*i];
+        e.push_back(std::make_pair(v.idx(),                0.5));
+        e.push_back(std::make_pair(mesh.to_vertex(h).idx(), 0.5));
+        if (!is_curve(mesh, efeature, mesh.edge(h)))
+        {
+            e[0].second = e[1].second = 0.25;
+            add_face_point(mesh, mesh.face(h), 0.25, e);
+            add_face_point(mesh, mesh.face(mesh.opposite_halfedge(h)), 0.25, e);
+        }
+
+        if (i < nf)
+            add_face_point(mesh, mesh.face(h), 1.0, ring[2+2*i]);
+    }
+
+    for (unsigned int i=0; i<ring.size(); ++i)
+        compress(ring[i]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// stencils of the limit position of v and of two limit tangents per sector
+void vertex_limit(const Surface_mesh& mesh, bool catmull_clark,
+                  Surface_mesh::Vertex_property<bool> vfeature,
+                  Surface_mesh::Edge_property<bool> efeature,
+                  const std::vector< std::vector<double> >& cross_masks,
+                  Vertex v, Stencil& position, std::vector<Stencil>& tangents)
+{
+    position.clear();
+    tangents.clear();
+
+    bool closed;
+    std::vector< std::vector<Halfedge> > sectors;
+
+
+    // corners and isolated vertices are fixed, the normal is the average
+    // of the face normals
+    if (!ring_sectors(mesh, vfeature, efeature, v, closed, sectors))
+    {
+        position.push_back(std::make_pair(v.idx(), 1.0));
+
+        for (unsigned int s=0; s<sectors.size(); ++s)
+        {
+            for (unsigned int i=0; i<2; ++i)
+            {
+                Stencil t;
+                t.push_back(std::make_pair(mesh.to_vertex(sectors[s][i]).idx(), 1.0));
+                t.push_back(std::make_pair(v.idx(), -1.0));
+                tangents.push_back(t);
+            }
+        }
+        return;
+    }
+
+
+    std::vector<Stencil> ring;
+    std::vector<double>  pmask, tmask0, tmask1;
+
+    for (unsigned int s=0; s<sectors.size(); ++s)
+    {
+        ring_stencils(mesh, catmull_clark, efeature, v, closed, sectors[s], ring);
+
+        const unsigned int n = ring.size();
+        pmask.assign(n, 0.0);
+        tmask0.assign(n, 0.0);
+        tmask1.assign(n, 0.0);
+
+        if (closed)
+        {
+            const unsigned int k = sectors[s].size();
+
+            if (catmull_clark)
+            {
+                // Halstead et al. 93
+                const double a = 1.0 + cos(2.0*M_PI/k) + cos(M_PI/k) * sqrt(2.0*(9.0 + cos(2.0*M_PI/k)));
+
+                pmask[0] = double(k) / (k+5);
+                for (unsigned int i=0; i<k; ++i)
+                {
+                    const double a0 = 2.0*M_PI*i/k, a1 = 2.0*M_PI*(i+1)/k;
+
+                    pmask[1+2*i]  = 4.0 / (k*(k+5));
+                    pmask[2+2*i]  = 1.0 / (k*(k+5));
+                    tmask0[1+2*i] = a * cos(a0);
+                    tmask0[2+2*i] = cos(a0) + cos(a1);
+                    tmask1[1+2*i] = a * sin(a0);
+                    tmask1[2+2*i] = sin(a0) + sin(a1);
+                }
+            }
+            else
+            {
+                // Loop's vertex rule has weight beta for each neighbour
+                const double alpha = 0.625 - pow(0.375 + 0.25*cos(2.0*M_PI/k), 2.0);
+                const double beta  = alpha / k;
+                const double chi   = 1.0 / (3.0/(8.0*beta) + k);
+
+                pmask[0] = 1.0 - k*chi;
+                for (unsigned int i=0; i<k; ++i)
+                {
+                    pmask[1+i]  = chi;
+                    tmask0[1+i] = cos(2.0*M_PI*i/k);
+                    tmask1[1+i] = sin(2.0*M_PI*i/k);
+                }
+            }
+        }
+        else
+        {
+            // cubic B-spline along the curve, cross tangent into the sector
+            const unsigned int k = sectors[s].size() - 1;
+
+            pmask[0]    = 2.0/3.0;
+            pmask[1]    = 1.0/6.0;
+            pmask[n-1]  = 1.0/6.0;
+            tmask0[1]   =  1.0;
+            tmask0[n-1] = -1.0;
+
+            if (k < cross_masks.size())
+                tmask1 = cross_masks[k];
+            else
+                cross_mask(catmull_clark, k, tmask1);
+        }
+
+        Stencil t0, t1;
+        for (unsigned int i=0; i<n; ++i)
+        {
+            if (s == 0 && pmask[i] != 0.0) add(position, pmask[i], ring[i]);
+            if (tmask0[i] != 0.0)          add(t0, tmask0[i], ring[i]);
+            if (tmask1[i] != 0.0)          add(t1, tmask1[i], ring[i]);
+        }
+        compress(t0);
+        compress(t1);
+        tangents.push_back(t0);
+        tangents.push_back(t1);
+    }
+
+    compress(position);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// normalized sum of the normals of the sectors, tangents are given in pairs
+template <class Tangent>
+Normal sector_normal(unsigned int n, Tangent tangent)
+{
+    Normal normal(0,0,0);
+    for (unsigned int s=0; s<n; ++s)
+    {
+        const Normal ns = cross(tangent(2*s), tangent(2*s+1));
+        const Scalar l  = norm(ns);
+        if (l > FLT_MIN) normal += ns / l;
+    }
+
+    const Scalar l = norm(normal);
+    return (l > FLT_MIN) ? normal / l : normal;
+}
+
+
+// limit point of vertex v of mesh and its normal on the side of face f
+void vertex_limit(const Surface_mesh& mesh, bool catmull_clark,
+                  const std::vector< std::vector<double> >& cross_masks,
+                  Vertex v, Face f, Point& point, Normal& normal)
+{
+    Surface_mesh::Vertex_property<bool> vfeature = mesh.get_vertex_property<bool>("v:feature");
+    Surface_mesh::Edge_property<bool>   efeature = mesh.get_edge_property<bool>("e:feature");
+
+    Stencil position;
+    std::vector<Stencil> tangents;
+    vertex_limit(mesh, catmull_clark, vfeature, efeature, cross_masks, v, position, tangents);
+
+
+    // the sector containing f
+    bool closed;
+    std::vector< std::vector<Halfedge> > sectors;
+    ring_sectors(mesh, vfeature, efeature, v, closed, sectors);
+
+    unsigned int side = 0;
+    for (unsigned int s=0; s<sectors.size(); ++s)
+    {
+        const unsigned int nf = closed ? sectors[s].size() : sectors[s].size()-1;
+        for (unsigned int i=0; i<nf; ++i)
+        {
+            if (mesh.face(sectors[s][i]) == f)
+                side = s;
+        }
+    }
+
+
+    const std::vector<Point>& points = mesh.get_vertex_property<Point>("v:point").vector();
+
+    point  = apply_stencil(position, points);
+    normal = sector_normal(1, [&](unsigned int i) { return apply_stencil(tangents[2*side + i], points); });
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// whether the face of h is a regular patch: its corners are smooth and
+// have valence 6 (Loop) or 4 with only quads around (Catmull-Clark)
+bool is_regular(const Surface_mesh& mesh, bool catmull_clark, Halfedge h)
+{
+    Surface_mesh::Vertex_property<bool> vfeature = mesh.get_vertex_property<bool>("v:feature");
+    Surface_mesh::Edge_property<bool>   efeature = mesh.get_edge_property<bool>("e:feature");
+
+    const unsigned int valence = catmull_clark ? 4 : 6;
+
+    Halfedge g = h;
+    do
+    {
+        const Vertex c = mesh.from_vertex(g);
+        if (mesh.is_boundary(c) || (vfeature && vfeature[c]) || mesh.valence(c) != valence)
+            return false;
+
+        for (auto hh: mesh.halfedges(c))
+        {
+            if (efeature && efeature[mesh.edge(hh)])
+                return false;
+            if (catmull_clark && mesh.valence(mesh.face(hh)) != 4)
+                return false;
+        }
+
+        g = mesh.next_halfedge(g);
+    }
+    while (g != h);
+
+    return true;
+}
+
+
+// Stam's basis of the regular Loop patch at barycentric coordinates (u,v,w)
+void loop_basis(double u, double v, double w, double N[12])
+{
+    const double u2 = u*u, u3 = u2*u, u4 = u3*u;
+    const double v2 = v*v, v3 = v2*v, v4 = v3*v;
+    const double w2 = w*w, w3 = w2*w, w4 = w3*w;
+
+    N[0]  = u4 + 2*u3*v;
+    N[1]  = u4 + 2*u3*w;
+    N[2]  = u4 + 2*u3*w + 6*u3*v + 6*u2*v*w + 12*u2*v2 + 6*u*v2*w + 6*u*v3 + 2*v3*w + v4;
+    N[3]  = 6*u4 + 24*u3*w + 24*u2*w2 + 8*u*w3 + w4 + 24*u3*v + 60*u2*v*w + 36*u*v*w2
+          + 6*v*w3 + 24*u2*v2 + 36*u*v2*w + 12*v2*w2 + 8*u*v3 + 6*v3*w + v4;
+    N[4]  = u4 + 6*u3*w + 12*u2*w2 + 6*u*w3 + w4 + 2*u3*v + 6*u2*v*w + 6*u*v*w2 + 2*v*w3;
+    N[5]  = 2*u*v3 + v4;
+    N[6]  = u4 + 6*u3*w + 12*u2*w2 + 6*u*w3 + w4 + 8*u3*v + 36*u2*v*w + 36*u*v*w2 + 8*v*w3
+          + 24*u2*v2 + 60*u*v2*w + 24*v2*w2 + 24*u*v3 + 24*v3*w + 6*v4;
+    N[7]  = u4 + 8*u3*w + 24*u2*w2 + 24*u*w3 + 6*w4 + 6*u3*v + 36*u2*v*w + 60*u*v*w2
+          + 24*v*w3 + 12*u2*v2 + 36*u*v2*w + 24*v2*w2 + 6*u*v3 + 8*v3*w + v4;
+    N[8]  = 2*u*w3 + w4;
+    N[9]  = 2*v3*w + v4;
+    N[10] = 2*u*w3 + w4 + 6*u*v*w2 + 6*v*w3 + 6*u*v2*w + 12*v2*w2 + 2*u*v3 + 6*v3*w + v4;
+    N[11] = w4 + 2*v*w3;
+
+    for (int i=0; i<12; ++i)
+        N[i] /= 12.0;
+}
+
+
+// point of the regular Loop patch with control points q at parameter (s,t)
+Point loop_point(const Point q[12], double s, double t)
+{
+    double N[12];
+    loop_basis(1.0-s-t, s, t, N);
+
+    Point p(0,0,0);
+    for (int i=0; i<12; ++i)
+        p += N[i] * q[i];
+    return p;
+}
+
+
+// uniform cubic B-spline basis and derivatives
+void bspline_basis(double t, double B[4], double D[4])
+{
+    const double s = 1.0 - t;
+    B[0] = s*s*s / 6.0;
+    B[1] = (3.0*t*t*t - 6.0*t*t + 4.0) / 6.0;
+    B[2] = (-3.0*t*t*t + 3.0*t*t + 3.0*t + 1.0) / 6.0;
+    B[3] = t*t*t / 6.0;
+    D[0] = -0.5*s*s;
+    D[1] = (3.0*t*t - 4.0*t) / 2.0;
+    D[2] = (-3.0*t*t + 2.0*t + 1.0) / 2.0;
+    D[3] = 0.5*t*t;
+}
+
+
+// evaluate the regular patch of the face of h, whose first corner is the
+// from-vertex of h
+void regular_patch(const Surface_mesh& mesh, bool catmull_clark, Halfedge h,
+                   double s, double t, Point& point, Normal& normal)
+{
+    // control points on the lattice [-1,2]^2, the face corners are at
+    // (0,0), (1,0), (0,1) (Loop) or (0,0), (1,0), (1,1), (0,1)
+    // (Catmull-Clark). for each corner its position and the directions to
+    // the next and the previous corner.
+    static const int loop_frames[3][6] = { { 0,0,  1, 0,  0, 1 },
+                                           { 1,0, -1, 1, -1, 0 },
+                                           { 0,1,  0,-1,  1,-1 } };
+    static const int cc_frames[4][6]   = { { 0,0,  1, 0,  0, 1 },
+                                           { 1,0,  0, 1, -1, 0 },
+                                           { 1,1, -1, 0,  0,-1 },
+                                           { 0,1,  0,-1,  1, 0 } };
+
+    // neighbours around a corner in ccw order, in the frame of the corner
+    static const int loop_ring[6][2] = { {1,0}, {0,1}, {-1,1}, {-1,0}, {0,-1}, {1,-1} };
+    static const int cc_ring[4][4]   = { {1,0,  1, 1}, {0,1, -1, 1}, {-1,0, -1,-1}, {0,-1,  1,-1} };
+
+    const std::vector<Point>& points = mesh.get_vertex_property<Point>("v:point").vector();
+
+    Point grid[4][4];
+    Halfedge g = h;
+    for (int k=0; k<(catmull_clark ? 4 : 3); ++k, g=mesh.next_halfedge(g))
+    {
+        const int* f = catmull_clark ? cc_frames[k] : loop_frames[k];
+        grid[f[0]+1][f[1]+1] = points[mesh.from_vertex(g).idx()];
+
+        Halfedge r = g;
+        for (int i=0; i<(catmull_clark ? 4 : 6); ++i, r=mesh.ccw_rotated_halfedge(r))
+        {
+            const int* o = catmull_clark ? cc_ring[i] : loop_ring[i];
+            const int  x = f[0] + o[0]*f[2] + o[1]*f[4];
+            const int  y = f[1] + o[0]*f[3] + o[1]*f[5];
+            grid[x+1][y+1] = points[mesh.to_vertex(r).idx()];
+
+            if (catmull_clark)
+            {
+                const int xd = f[0] + o[2]*f[2] + o[3]*f[4];
+                const int yd = f[1] + o[2]*f[3] + o[3]*f[5];
+                grid[xd+1][yd+1] = points[mesh.to_vertex(mesh.next_halfedge(r)).idx()];
+            }
+        }
+    }
+
+
+    if (catmull_clark)
+    {
+        double Bu[4], Du[4], Bv[4], Dv[4];
+        bspline_basis(s, Bu, Du);
+        bspline_basis(t, Bv, Dv);
+
+        Point p(0,0,0), ps(0,0,0), pt(0,0,0);
+        for (int i=0; i<4; ++i)
+        {
+            for (int j=0; j<4; ++j)
+            {
+                p  += (Bu[i]*Bv[j]) * grid[i][j];
+                ps += (Du[i]*Bv[j]) * grid[i][j];
+                pt += (Bu[i]*Dv[j]) * grid[i][j];
+            }
+        }
+
+        point  = p;
+        normal = normalize(cross(ps, pt));
+    }
+    else
+    {
+        // lattice positions of the control points in Stam's order
+        static const int stam[12][2] = { { 0,-1}, {-1, 0}, { 1,-1}, { 0, 0}, {-1, 1}, { 2,-1},
+                                         { 1, 0}, { 0, 1}, {-1, 2}, { 2, 0}, { 1, 1}, { 0, 2} };
+        Point q[12];
+        for (int i=0; i<12; ++i)
+            q[i] = grid[stam[i][0]+1][stam[i][1]+1];
+
+        // the patch is a quartic polynomial, for which the five-point
+        // difference is exact
+        const double d = 0.5;
+        const Point ps = (8.0 * (loop_point(q, s+d, t) - loop_point(q, s-d, t)) -
+                          (loop_point(q, s+2*d, t) - loop_point(q, s-2*d, t))) / (12.0*d);
+        const Point pt = (8.0 * (loop_point(q, s, t+d) - loop_point(q, s, t-d)) -
+                          (loop_point(q, s, t+2*d) - loop_point(q, s, t-2*d))) / (12.0*d);
+
+        point  = loop_point(q, s, t);
+        normal = normalize(cross(ps, pt));
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// copy the faces around the corners of the face of h into patch, h becomes
+// the corresponding halfedge of patch. false if the faces do not form a
+// manifold patch.
+bool extract_patch(const Surface_mesh& mesh, Halfedge& h, Surface_mesh& patch)
+{
+    patch.clear();
+
+    std::vector<Face> faces;
+    Halfedge g = h;
+    do
+    {
+        for (auto hh: mesh.halfedges(mesh.from_vertex(g)))
+        {
+            const Face f = mesh.face(hh);
+            if (f.is_valid() && std::find(faces.begin(), faces.end(), f) == faces.end())
+                faces.push_back(f);
+        }
+        g = mesh.next_halfedge(g);
+    }
+    while (g != h);
+
+
+    Surface_mesh::Vertex_property<bool> vfeature = mesh.get_vertex_property<bool>("v:feature");
+    Surface_mesh::Edge_property<bool>   efeature = mesh.get_edge_property<bool>("e:feature");
+
+    std::map<Vertex, Vertex> vmap;
+    std::vector<Vertex> origin;
+    std::vector<Vertex> vertices;
+
+    for (unsigned int i=0; i<faces.size(); ++i)
+    {
+        vertices.clear();
+        for (auto v: mesh.vertices(faces[i]))
+        {
+            std::map<Vertex, Vertex>::iterator it = vmap.find(v);
+            if (it == vmap.end())
+            {
+                it = vmap.insert(std::make_pair(v, patch.add_vertex(mesh.position(v)))).first;
+                origin.push_back(v);
+            }
+            vertices.push_back(it->second);
+        }
+
+        if (!patch.add_face(vertices).is_valid())
+            return false;
+    }
+
+
+    // features
+    if (vfeature)
+    {
+        Surface_mesh::Vertex_property<bool> pfeature = patch.vertex_property<bool>("v:feature", false);
+        for (auto v: patch.vertices())
+            pfeature[v] = vfeature[origin[v.idx()]];
+    }
+    if (efeature)
+    {
+        Surface_mesh::Edge_property<bool> pfeature = patch.edge_property<bool>("e:feature", false);
+        for (auto e: patch.edges())
+        {
+            const Halfedge he = mesh.find_halfedge(origin[patch.vertex(e,0).idx()],
+                                                   origin[patch.vertex(e,1).idx()]);
+            pfeature[e] = efeature[mesh.edge(he)];
+        }
+    }
+
+    h = patch.find_halfedge(vmap[mesh.from_vertex(h)], vmap[mesh.to_vertex(h)]);
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+// limit point at a corner of the face of h of patch, or, at the last
+// level, interpolated from the corners. false otherwise.
+bool corner_point(const Surface_mesh& patch, bool catmull_clark,
+                  const std::vector< std::vector<double> >& cross_masks,
+                  Halfedge h, double s, double t, bool last,
+                  Point& point, Normal& normal)
+{
+    static const double corners[4][2] = { {0,0}, {1,0}, {1,1}, {0,1} };
+
+    const unsigned int n = catmull_clark ? 4 : 3;
+    const Face         f = patch.face(h);
+
+    Vertex c[4];
+    Halfedge g = h;
+    for (unsigned int i=0; i<n; ++i, g=patch.next_halfedge(g))
+        c[i] = patch.from_vertex(g);
+
+    for (unsigned int i=0; i<n; ++i)
+    {
+        const unsigned int j = (!catmull_clark && i == 2) ? 3 : i;
+        if (s == corners[j][0] && t == corners[j][1])
+        {
+            vertex_limit(patch, catmull_clark, cross_masks, c[i], f, point, normal);
+            return true;
+        }
+    }
+
+    if (!last)
+        return false;
+
+    double w[4];
+    if (catmull_clark)
+    {
+        w[0] = (1-s)*(1-t);  w[1] = s*(1-t);  w[2] = s*t;  w[3] = (1-s)*t;
+    }
+    else
+    {
+        w[0] = 1-s-t;  w[1] = s;  w[2] = t;
+    }
+
+    point  = Point(0,0,0);
+    normal = Normal(0,0,0);
+    for (unsigned int i=0; i<n; ++i)
+    {
+        Point  p;
+        Normal nn;
+        vertex_limit(patch, catmull_clark, cross_masks, c[i], f, p, nn);
+        point  += w[i] * p;
+        normal += w[i] * nn;
+    }
+    normal = normalize(normal);
+
+    return true;
+}
+
+
+// subdivide patch once, c and m are the corners and edge vertices of the
+// face of h in the refined patch. old vertices keep their index, the vertex
+// of edge e is nv+e and the vertex of face f is nv+ne+f.
+void refine_patch(Surface_mesh& patch, bool catmull_clark, Halfedge h,
+                  Vertex c[4], Vertex m[4])
+{
+    const unsigned int n = catmull_clark ? 4 : 3;
+
+    Halfedge g = h;
+    for (unsigned int i=0; i<n; ++i, g=patch.next_halfedge(g))
+    {
+        c[i] = patch.from_vertex(g);
+        m[i] = Vertex(patch.vertices_size() + patch.edge(g).idx());
+    }
+
+    Subdivider subdivider(catmull_clark ? Subdivider::CATMULL_CLARK : Subdivider::LOOP);
+    subdivider.setup(patch, 1);
+    subdivider.refine(patch);
+}
+
+
+// the child containing (s,t) of the face with corners c and edge vertices
+// m, given by the halfedge from its first to its second corner. (s,t)
+// becomes the parameter relative to the child.
+Halfedge child(const Surface_mesh& patch, bool catmull_clark,
+               const Vertex c[4], const Vertex m[4],
+               double& s, double& t)
+{
+    const double w = 1.0 - s - t;
+    Vertex a, b;
+    double s1, t1;
+
+    if (catmull_clark)
+    {
+        if (s < 0.5 && t < 0.5)
+        {
+            a = c[0];  b = m[0];  s1 = 2*s;      t1 = 2*t;
+        }
+        else if (t < 0.5)
+        {
+            a = c[1];  b = m[1];  s1 = 2*t;      t1 = 2*(1-s);
+        }
+        else if (s >= 0.5)
+        {
+            a = c[2];  b = m[2];  s1 = 2*(1-s);  t1 = 2*(1-t);
+        }
+        else
+        {
+            a = c[3];  b = m[3];  s1 = 2*(1-t);  t1 = 2*s;
+        }
+    }
+    else
+    {
+        if (w >= 0.5)
+        {
+            a = c[0];  b = m[0];  s1 = 2*s;      t1 = 2*t;
+        }
+        else if (s >= 0.5)
+        {
+            a = c[1];  b = m[1];  s1 = 2*t;      t1 = 2*w;
+        }
+        else if (t >= 0.5)
+        {
+            a = c[2];  b = m[2];  s1 = 2*w;      t1 = 2*s;
+        }
+        else
+        {
+            a = m[0];  b = m[1];  s1 = 1-2*w;    t1 = 1-2*s;
+        }
+    }
+
+    s = s1;
+    t = t1;
+
+    return patch.find_halfedge(a, b);
+}
+
+
+// refine patch around the face of h, following the sub-face containing
+// (s,t), until it is a regular patch. level is the number of steps done.
+void descend(Surface_mesh& patch, bool catmull_clark,
+             const std::vector< std::vector<double> >& cross_masks,
+             Halfedge h, double s, double t, unsigned int level,
+             Point& point, Normal& normal)
+{
+    Surface_mesh next;
+    Vertex       c[4], m[4];
+
+    for (;; ++level)
+    {
+        if (corner_point(patch, catmull_clark, cross_masks, h, s, t,
+                         level == max_levels, point, normal))
+            return;
+
+        refine_patch(patch, catmull_clark, h, c, m);
+        h = child(patch, catmull_clark, c, m, s, t);
+
+        if (is_regular(patch, catmull_clark, h))
+        {
+            regular_patch(patch, catmull_clark, h, s, t, point, normal);
+            return;
+        }
+
+        // keep only the neighbourhood of the child
+        if (extract_patch(patch, h, next))
+            patch = next;
+    }
+}
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Limit_evaluator::
+Limit_evaluator(Subdivider::Scheme scheme)
+    : scheme_(scheme)
+{
+    cross_masks_.resize(max_cross_masks);
+    for (unsigned int k=1; k<max_cross_masks; ++k)
+        cross_mask(scheme_ == Subdivider::CATMULL_CLARK, k, cross_masks_[k]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Limit_evaluator::
+setup(const Surface_mesh& control)
+{
+    positions_ = tangents_ = Stencil_table();
+    sector_offset_.clear();
+
+    if (!is_compact(control) ||
+        (scheme_ == Subdivider::LOOP && !control.is_triangle_mesh()))
+        return false;
+
+    Surface_mesh::Vertex_property<bool> vfeature = control.get_vertex_property<bool>("v:feature");
+    Surface_mesh::Edge_property<bool>   efeature = control.get_edge_property<bool>("e:feature");
+
+    const int nv = control.vertices_size();
+    std::vector<Stencil> positions(nv);
+    std::vector< std::vector<Stencil> > tangents(nv);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        vertex_limit(control, scheme_ == Subdivider::CATMULL_CLARK, vfeature, efeature,
+                     cross_masks_, Vertex(i), positions[i], tangents[i]);
+    }
+
+
+    // pack into tables
+    positions_.offset.push_back(0);
+    tangents_.offset.push_back(0);
+    sector_offset_.push_back(0);
+
+    for (int i=0; i<nv; ++i)
+    {
+        for (unsigned int j=0; j<positions[i].size(); ++j)
+        {
+            positions_.index.push_back(positions[i][j].first);
+            positions_.weight.push_back(positions[i][j].second);
+        }
+        positions_.offset.push_back(positions_.index.size());
+
+        for (unsigned int t=0; t<tangents[i].size(); ++t)
+        {
+            for (unsigned int j=0; j<tangents[i][t].size(); ++j)
+            {
+                tangents_.index.push_back(tangents[i][t][j].first);
+                tangents_.weight.push_back(tangents[i][t][j].second);
+            }
+            tangents_.offset.push_back(tangents_.index.size());
+        }
+        sector_offset_.push_back(sector_offset_.back() + tangents[i].size()/2);
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Limit_evaluator::
+limit_points(const std::vector<Point>& control,
+             std::vector<Point>& points,
+             std::vector<Normal>& normals) const
+{
+    const int n = positions_.offset.empty() ? 0 : positions_.offset.size() - 1;
+    points.resize(n);
+    normals.resize(n);
+
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
+    {
+        const unsigned int first = sector_offset_[i];
+
+        points[i]  = apply_stencil(positions_, i, control);
+        normals[i] = sector_normal(sector_offset_[i+1] - first, [&](unsigned int j)
+        {
+            return apply_stencil(tangents_, 2*first + j, control);
+        });
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Limit_evaluator::
+project(Surface_mesh& control) const
+{
+    if (sector_offset_.empty() ||
+        control.vertices_size() != sector_offset_.size()-1 ||
+        !is_compact(control))
+        return false;
+
+    Surface_mesh::Vertex_property<Point>  points  = control.vertex_property<Point>("v:point");
+    Surface_mesh::Vertex_property<Normal> normals = control.vertex_property<Normal>("v:normal");
+
+    std::vector<Point> limit;
+    limit_points(points.vector(), limit, normals.vector());
+    points.vector() = limit;
+
+    control.geometry_changed();
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Limit_evaluator::
+evaluate(const Surface_mesh& control, Surface_mesh::Face f,
+         Scalar u, Scalar v, Point& point, Normal& normal) const
+{
+    const bool catmull_clark = (scheme_ == Subdivider::CATMULL_CLARK);
+
+    if (!f.is_valid() || control.is_deleted(f) ||
+        control.valence(f) != (catmull_clark ? 4u : 3u))
+        return false;
+
+    // from the first to the second vertex of f
+    Halfedge h = control.next_halfedge(control.halfedge(f));
+
+    if (is_regular(control, catmull_clark, h))
+    {
+        regular_patch(control, catmull_clark, h, u, v, point, normal);
+        return true;
+    }
+
+    Surface_mesh patch;
+    if (!extract_patch(control, h, patch))
+        patch = control;
+
+    descend(patch, catmull_clark, cross_masks_, h, u, v, 0, point, normal);
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Limit_evaluator::
+evaluate(const Surface_mesh& control,
+         const std::vector<Surface_mesh::Face>& faces,
+         const std::vector<Vec2f>& parameters,
+         std::vector<Point>& points,
+         std::vector<Normal>& normals) const
+{
+    const bool catmull_clark = (scheme_ == Subdivider::CATMULL_CLARK);
+
+    const unsigned int n = std::min(faces.size(), parameters.size());
+    points.assign(n, Point(0,0,0));
+    normals.assign(n, Normal(0,0,0));
+
+
+    // queries of the same face share the first refinement step
+    std::vector< std::pair<int, unsigned int> > order(n);
+    for (unsigned int i=0; i<n; ++i)
+        order[i] = std::make_pair(faces[i].idx(), i);
+    std::sort(order.begin(), order.end());
+
+    std::vector<unsigned int> groups;
+    for (unsigned int i=0; i<n; ++i)
+    {
+        if (i == 0 || order[i].first != order[i-1].first)
+            groups.push_back(i);
+    }
+    groups.push_back(n);
+
+    const int ng = groups.size() - 1;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int g=0; g<ng; ++g)
+    {
+        const unsigned int first = groups[g], last = groups[g+1];
+        const Face f = faces[order[first].second];
+
+        if (!f.is_valid() || control.is_deleted(f) ||
+            control.valence(f) != (catmull_clark ? 4u : 3u))
+            continue;
+
+        Halfedge h = control.next_halfedge(control.halfedge(f));
+
+        if (is_regular(control, catmull_clark, h))
+        {
+            for (unsigned int i=first; i<last; ++i)
+            {
+                const unsigned int q = order[i].second;
+                regular_patch(control, catmull_clark, h, parameters[q][0], parameters[q][1],
+                              points[q], normals[q]);
+            }
+            continue;
+        }
+
+        Surface_mesh patch, refined;
+        if (!extract_patch(control, h, patch))
+            patch = control;
+
+        bool refine = false;
+        for (unsigned int i=first; i<last; ++i)
+        {
+            const unsigned int q = order[i].second;
+            if (!corner_point(patch, catmull_clark, cross_masks_, h,
+                              parameters[q][0], parameters[q][1], false,
+                              points[q], normals[q]))
+                refine = true;
+        }
+        if (!refine) continue;
+
+        Vertex c[4], m[4];
+        refined = patch;
+        refine_patch(refined, catmull_clark, h, c, m);
+
+        for (unsigned int i=first; i<last; ++i)
+        {
+            const unsigned int q = order[i].second;
+            double s = parameters[q][0], t = parameters[q][1];
+
+            if (corner_point(patch, catmull_clark, cross_masks_, h, s, t, false, points[q], normals[q]))
+                continue;
+
+            Halfedge hc = child(refined, catmull_clark, c, m, s, t);
+
+            if (is_regular(refined, catmull_clark, hc))
+            {
+                regular_patch(refined, catmull_clark, hc, s, t, points[q], normals[q]);
+            }
+            else
+            {
+                Surface_mesh sub;
+                if (!extract_patch(refined, hc, sub))
+                    sub = refined;
+                descend(sub, catmull_clark, cross_masks_, hc, s, t, 1, points[q], normals[q]);
+            }
+        }
+    }
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,109 @@
+//=============================================================================
+
+#ifndef GRAPHENE_LIMIT_EVALUATOR_H
+#define GRAPHENE_LIMIT_EVALUATOR_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/Subdivider.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Points and normals of the Loop and Catmull-Clark limit surfaces, without
+/// refining the mesh.
+///
+/// setup() precomputes for every control vertex the stencils of its limit
+/// position and of the limit tangents: the closed-form eigenvector masks at
+/// smooth vertices, and at boundary and crease vertices (see Subdivider for
+/// the feature rules) masks of the cubic B-spline curve and a cross tangent
+/// from the eigen-analysis of the one-sided subdivision matrix. At creases
+/// and corners the normal is the average of the one-sided normals.
+///
+/// evaluate() gives the limit point of a face at parameter (u,v). Regular
+/// patches are evaluated directly as quartic box spline (Loop, see Stam 98)
+/// or bicubic B-spline (Catmull-Clark). Otherwise only the neighbourhood of
+/// the face is subdivided until the sub-face containing (u,v) is regular.
+class Limit_evaluator
+{
+public:
+
+    /// constructor
+    Limit_evaluator(Subdivider::Scheme scheme);
+
+    /// precompute the limit stencils of the vertices of control, only
+    /// depends on its connectivity and feature flags. false if mesh has
+    /// deleted elements, or non-triangles for Loop subdivision.
+    bool setup(const Surface_mesh& control);
+
+    /// limit positions and normals of the control vertices from the control
+    /// points of the mesh given to setup(), indexed by vertex index
+    void limit_points(const std::vector<Point>& control,
+                      std::vector<Point>& points,
+                      std::vector<Normal>& normals) const;
+
+    /// move the vertices of control, the mesh given to setup(), to their
+    /// limit positions and store the limit normals in "v:normal"
+    bool project(Surface_mesh& control) const;
+
+    /// limit point and normal of face f of control at parameter (u,v). The
+    /// parameter is relative to the vertices of f in the order of
+    /// control.vertices(f): (1-u-v, u, v) are barycentric coordinates for
+    /// triangles, (u,v) in [0,1]^2 bilinear coordinates for quads. false for
+    /// other faces. Does not need setup().
+    bool evaluate(const Surface_mesh& control, Surface_mesh::Face f,
+                  Scalar u, Scalar v, Point& point, Normal& normal) const;
+
+    /// evaluate() for many (face, parameter) pairs in parallel. points and
+    /// normals of failed queries are set to zero.
+    void evaluate(const Surface_mesh& control,
+                  const std::vector<Surface_mesh::Face>& faces,
+                  const std::vector<Vec2f>& parameters,
+                  std::vector<Point>& points,
+                  std::vector<Normal>& normals) const;
+
+
+private:
+
+    // stencil i gives the sum of weight[j] times control vertex index[j],
+    // j in [offset[i], offset[i+1])
+    struct Stencil_table
+    {
+        std::vector<unsigned int>  offset;
+        std::vector<unsigned int>  index;
+        std::vector<Scalar>        weight;
+    };
+
+
+private:
+
+    Subdivider::Scheme  scheme_;
+
+    // cross tangent masks of one-sided rings with k faces, index k
+    std::vector< std::vector<double> >  cross_masks_;
+
+    // limit position of vertex i
+    Stencil_table  positions_;
+
+    // two tangents per sector, the sectors of vertex i are
+    // [sector_offset_[i], sector_offset_[i+1])
+    Stencil_table              tangents_;
+    std::vector<unsigned int>  sector_offset_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_LIMIT_EVALUATOR_H
+//=============================================================================
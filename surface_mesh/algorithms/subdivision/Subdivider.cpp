@@ -0,0 +1,563 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/Subdivider.h>
+
+#include <algorithm>
+#include <utility>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+namespace {
+
+typedef std::vector< std::pair<unsigned int, Scalar> > Stencil;
+
+
+// true if the mesh has no deleted elements
+bool is_compact(const Surface_mesh& mesh)
+{
+    return (mesh.n_vertices() == mesh.vertices_size() &&
+            mesh.n_edges()    == mesh.edges_size()    &&
+            mesh.n_faces()    == mesh.faces_size());
+}
+
+
+// centroid of f
+void add_face_point(const Surface_mesh& mesh, Surface_mesh::Face f,
+                    Scalar w, Stencil& s)
+{
+    const Scalar n = mesh.valence(f);
+    for (auto v: mesh.vertices(f))
+        s.push_back(std::make_pair(v.idx(), w/n));
+}
+
+
+// new position of an old vertex
+void vertex_stencil(const Surface_mesh& mesh, bool catmull_clark,
+                    Surface_mesh::Vertex_property<bool> vfeature,
+                    Surface_mesh::Edge_property<bool> efeature,
+                    Surface_mesh::Vertex v, Stencil& s)
+{
+    const unsigned int i = v.idx();
+
+    // isolated vertex?
+    if (mesh.is_isolated(v))
+    {
+        s.push_back(std::make_pair(i, 1.0));
+    }
+
+    // boundary vertex?
+    else if (mesh.is_boundary(v))
+    {
+        Surface_mesh::Halfedge h1 = mesh.halfedge(v);
+        Surface_mesh::Halfedge h0 = mesh.prev_halfedge(h1);
+
+        s.push_back(std::make_pair(i, 0.75));
+        s.push_back(std::make_pair(mesh.to_vertex(h1).idx(),   0.125));
+        s.push_back(std::make_pair(mesh.from_vertex(h0).idx(), 0.125));
+    }
+
+    // interior feature vertex?
+    else if (vfeature && vfeature[v])
+    {
+        const unsigned int n = s.size();
+        for (auto h: mesh.halfedges(v))
+        {
+            if (efeature && efeature[mesh.edge(h)])
+                s.push_back(std::make_pair(mesh.to_vertex(h).idx(), 0.125));
+        }
+
+        // vertex is on a feature line, otherwise keep it fixed
+        if (s.size() == n+2)
+        {
+            s.push_back(std::make_pair(i, 0.75));
+        }
+        else
+        {
+            s.resize(n);
+            s.push_back(std::make_pair(i, 1.0));
+        }
+    }
+
+    // interior vertex, Catmull-Clark: (F + 2R + (k-3)P) / k with the
+    // average F of the face points and R of the edge midpoints
+    else if (catmull_clark)
+    {
+        const Scalar k = mesh.valence(v);
+
+        s.push_back(std::make_pair(i, (k-3)/k));
+        for (auto h: mesh.halfedges(v))
+        {
+            add_face_point(mesh, mesh.face(h), 1.0/(k*k), s);
+            s.push_back(std::make_pair(i,                       1.0/(k*k)));
+            s.push_back(std::make_pair(mesh.to_vertex(h).idx(), 1.0/(k*k)));
+        }
+    }
+
+    // interior vertex, Loop
+    else
+    {
+        const Scalar k    = mesh.valence(v);
+        const Scalar beta = (0.625 - pow(0.375 + 0.25*cos(2.0*M_PI/k), 2.0));
+
+        s.push_back(std::make_pair(i, 1.0-beta));
+        for (auto vv: mesh.vertices(v))
+            s.push_back(std::make_pair(vv.idx(), beta/k));
+    }
+}
+
+
+// new vertex on e
+void edge_stencil(const Surface_mesh& mesh, bool catmull_clark,
+                  Surface_mesh::Edge_property<bool> efeature,
+                  Surface_mesh::Edge e, Stencil& s)
+{
+    // boundary or feature edge?
+    if (mesh.is_boundary(e) || (efeature && efeature[e]))
+    {
+        s.push_back(std::make_pair(mesh.vertex(e,0).idx(), 0.5));
+        s.push_back(std::make_pair(mesh.vertex(e,1).idx(), 0.5));
+    }
+
+    // interior edge, Catmull-Clark
+    else if (catmull_clark)
+    {
+        s.push_back(std::make_pair(mesh.vertex(e,0).idx(), 0.25));
+        s.push_back(std::make_pair(mesh.vertex(e,1).idx(), 0.25));
+        add_face_point(mesh, mesh.face(e,0), 0.25, s);
+        add_face_point(mesh, mesh.face(e,1), 0.25, s);
+    }
+
+    // interior edge, Loop
+    else
+    {
+        Surface_mesh::Halfedge h0 = mesh.halfedge(e, 0);
+        Surface_mesh::Halfedge h1 = mesh.halfedge(e, 1);
+        s.push_back(std::make_pair(mesh.to_vertex(h0).idx(), 0.375));
+        s.push_back(std::make_pair(mesh.to_vertex(h1).idx(), 0.375));
+        s.push_back(std::make_pair(mesh.to_vertex(mesh.next_halfedge(h0)).idx(), 0.125));
+        s.push_back(std::make_pair(mesh.to_vertex(mesh.next_halfedge(h1)).idx(), 0.125));
+    }
+}
+
+
+// sum up the weights of the same vertex
+void compress(Stencil& s)
+{
+    // rows are short
+    for (unsigned int i=1; i<s.size(); ++i)
+        for (unsigned int j=i; j>0 && s[j].first < s[j-1].first; --j)
+            std::swap(s[j], s[j-1]);
+
+    unsigned int n = 0;
+    for (unsigned int i=0; i<s.size(); ++i)
+    {
+        if (n && s[n-1].first == s[i].first)
+            s[n-1].second += s[i].second;
+        else
+            s[n++] = s[i];
+    }
+    s.resize(n);
+}
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Subdivider::
+Subdivider(Scheme scheme)
+    : scheme_(scheme), n_vertices_(0), n_edges_(0), n_faces_(0)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Subdivider::
+setup(const Surface_mesh& control, unsigned int levels)
+{
+    levels_.clear();
+
+    if (!is_compact(control) || (scheme_ == LOOP && !control.is_triangle_mesh()))
+        return false;
+
+    n_vertices_ = control.vertices_size();
+    n_edges_    = control.edges_size();
+    n_faces_    = control.faces_size();
+
+    levels_.resize(levels);
+    if (levels == 0) return true;
+
+    compute_stencils(control, levels_[0]);
+
+
+    // refine a copy of the connectivity for the following levels
+    if (levels > 1)
+    {
+        Surface_mesh mesh(control);
+
+        for (unsigned int l=1; l<levels; ++l)
+        {
+            refine_connectivity(mesh);
+            compute_stencils(mesh, levels_[l]);
+        }
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Subdivider::
+refine(Surface_mesh& mesh) const
+{
+    if (mesh.vertices_size() != n_vertices_ ||
+        mesh.edges_size()    != n_edges_    ||
+        mesh.faces_size()    != n_faces_    ||
+        !is_compact(mesh))
+        return false;
+
+    std::vector<Point> points;
+    evaluate(mesh.vertex_property<Point>("v:point").vector(), points);
+
+    for (unsigned int l=0; l<levels_.size(); ++l)
+        refine_connectivity(mesh);
+
+    mesh.vertex_property<Point>("v:point").vector() = points;
+    mesh.geometry_changed();
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivider::
+evaluate(const std::vector<Point>& control, std::vector<Point>& points) const
+{
+    std::vector<Point> input;
+
+    points = control;
+    for (unsigned int l=0; l<levels_.size(); ++l)
+    {
+        const Stencil_table& table = levels_[l];
+        const int n = table.offset.size() - 1;
+
+        input.swap(points);
+        points.resize(n);
+
+#pragma omp parallel for
+        for (int i=0; i<n; ++i)
+        {
+            Point p(0,0,0);
+            for (unsigned int j=table.offset[i], jend=table.offset[i+1]; j<jend; ++j)
+                p += table.weight[j] * input[table.index[j]];
+            points[i] = p;
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Subdivider::
+update(const Surface_mesh& control, Surface_mesh& refined) const
+{
+    if (levels_.empty() ||
+        control.vertices_size() != n_vertices_ ||
+        refined.vertices_size() != levels_.back().offset.size() - 1)
+        return false;
+
+    auto cpoints = control.get_vertex_property<Point>("v:point");
+    auto rpoints = refined.vertex_property<Point>("v:point");
+    evaluate(cpoints.vector(), rpoints.vector());
+    refined.geometry_changed();
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivider::
+compute_stencils(const Surface_mesh& mesh, Stencil_table& table) const
+{
+    const int nv = mesh.vertices_size();
+    const int ne = mesh.edges_size();
+    const int nf = mesh.faces_size();
+    const int n  = nv + ne + (scheme_ == CATMULL_CLARK ? nf : 0);
+
+    auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+    auto efeature = mesh.get_edge_property<bool>("e:feature");
+
+
+    // rows in blocks, each block is collected in its own arrays
+    const int block    = 4096;
+    const int n_blocks = (n + block - 1) / block;
+    std::vector< std::vector<unsigned int> > bindex(n_blocks);
+    std::vector< std::vector<Scalar> >       bweight(n_blocks);
+
+    table.n_input = nv;
+    table.offset.resize(n+1);
+    table.offset[0] = 0;
+
+#pragma omp parallel
+    {
+        Stencil s;
+
+#pragma omp for schedule(dynamic)
+        for (int b=0; b<n_blocks; ++b)
+        {
+            for (int i=b*block, iend=std::min(n, (b+1)*block); i<iend; ++i)
+            {
+                s.clear();
+                if (i < nv)
+                    vertex_stencil(mesh, scheme_ == CATMULL_CLARK, vfeature, efeature, Surface_mesh::Vertex(i), s);
+                else if (i < nv+ne)
+                    edge_stencil(mesh, scheme_ == CATMULL_CLARK, efeature, Surface_mesh::Edge(i-nv), s);
+                else
+                    add_face_point(mesh, Surface_mesh::Face(i-nv-ne), 1.0, s);
+                compress(s);
+
+                table.offset[i+1] = s.size();
+                for (unsigned int j=0; j<s.size(); ++j)
+                {
+                    bindex[b].push_back(s[j].first);
+                    bweight[b].push_back(s[j].second);
+                }
+            }
+        }
+    }
+
+
+    // concatenate the blocks
+    for (int i=0; i<n; ++i)
+        table.offset[i+1] += table.offset[i];
+
+    table.index.resize(table.offset[n]);
+    table.weight.resize(table.offset[n]);
+
+#pragma omp parallel for
+    for (int b=0; b<n_blocks; ++b)
+    {
+        std::copy(bindex[b].begin(),  bindex[b].end(),  table.index.begin()  + table.offset[b*block]);
+        std::copy(bweight[b].begin(), bweight[b].end(), table.weight.begin() + table.offset[b*block]);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivider::
+refine_connectivity(Surface_mesh& mesh) const
+{
+    typedef Surface_mesh::Vertex    Vertex;
+    typedef Surface_mesh::Halfedge  Halfedge;
+    typedef Surface_mesh::Face      Face;
+
+    const bool quads = (scheme_ == CATMULL_CLARK);
+    const int  nv    = mesh.vertices_size();
+    const int  ne    = mesh.edges_size();
+    const int  nf    = mesh.faces_size();
+    const int  nh    = 2*ne;
+
+
+    // old connectivity, overwritten below
+    std::vector<Vertex>    to(nh);
+    std::vector<Halfedge>  next(nh);
+    std::vector<Face>      face(nh);
+    std::vector<Halfedge>  vhalfedge(nv);
+    std::vector<Halfedge>  fhalfedge(nf);
+    std::vector<int>       foffset(nf+1);
+
+#pragma omp parallel for
+    for (int i=0; i<nh; ++i)
+    {
+        Halfedge h(i);
+        to[i]   = mesh.to_vertex(h);
+        next[i] = mesh.next_halfedge(h);
+        face[i] = mesh.face(h);
+    }
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+        vhalfedge[i] = mesh.halfedge(Vertex(i));
+
+    foffset[0] = 0;
+
+#pragma omp parallel for
+    for (int i=0; i<nf; ++i)
+    {
+        fhalfedge[i] = mesh.halfedge(Face(i));
+        foffset[i+1] = quads ? mesh.valence(Face(i)) : 3;
+    }
+
+    for (int i=0; i<nf; ++i)
+        foffset[i+1] += foffset[i];
+
+
+    // old halfedge h of edge e is split into first(h) and second(h). edge e
+    // keeps the halves at vertex(e,0), its other halves get the edge ne+e.
+    // the edges between the new vertices of face f start at 2ne+foffset[f].
+    auto first  = [ne](Halfedge h) { return (h.idx() & 1) ? h : Halfedge(2*(ne + (h.idx()>>1))); };
+    auto second = [ne](Halfedge h) { return (h.idx() & 1) ? Halfedge(2*(ne + (h.idx()>>1)) + 1) : h; };
+    auto inner  = [ne](int j)      { return Halfedge(2*(2*ne + j)); };
+
+    const int n_vertices = nv + ne + (quads ? nf : 0);
+    const int n_edges    = 2*ne + foffset[nf];
+    const int n_faces    = quads ? foffset[nf] : 4*nf;
+    mesh.resize(n_vertices, n_edges, n_faces);
+
+
+    // split edges
+#pragma omp parallel for
+    for (int i=0; i<nh; ++i)
+    {
+        Halfedge h(i);
+        Vertex   m(nv + (i>>1));
+
+        mesh.set_vertex(first(h), m);
+        mesh.set_vertex(second(h), to[i]);
+
+        // boundary halfedges stay connected to each other
+        if (!face[i].is_valid())
+        {
+            mesh.set_face(first(h), Face());
+            mesh.set_face(second(h), Face());
+            mesh.set_next_halfedge(first(h), second(h));
+            mesh.set_next_halfedge(second(h), first(next[i]));
+        }
+    }
+
+
+    // split faces
+#pragma omp parallel
+    {
+        std::vector<Halfedge> hf;
+
+#pragma omp for
+        for (int i=0; i<nf; ++i)
+        {
+            const int n = foffset[i+1] - foffset[i];
+
+            hf.resize(n);
+            hf[0] = fhalfedge[i];
+            for (int k=1; k<n; ++k)
+                hf[k] = next[hf[k-1].idx()];
+
+            // the children are face i and [nf + foffset[i] - i, ...) for
+            // Catmull-Clark, [nf + 3i, ...) for Loop. child k sits at the
+            // corner to_vertex(hf[k-1]).
+            const int fbase = quads ? nf + foffset[i] - i - 1 : nf + 3*i - 1;
+
+            for (int k=0; k<n; ++k)
+            {
+                const Halfedge hp = hf[(k+n-1) % n];
+                const Halfedge hk = hf[k];
+                const Vertex   mp(nv + (hp.idx()>>1));
+                const Vertex   mk(nv + (hk.idx()>>1));
+                const Face     fk = k ? Face(fbase + k) : Face(i);
+
+                // Catmull-Clark: inner(k) runs from edge vertex k to the
+                // face vertex, Loop: from edge vertex k to edge vertex k-1
+                const Halfedge hin  = inner(foffset[i] + k);
+                const Halfedge hout = quads
+                    ? mesh.opposite_halfedge(inner(foffset[i] + (k+n-1) % n))
+                    : Halfedge();
+
+                mesh.set_vertex(hin, quads ? Vertex(nv + ne + i) : mp);
+                mesh.set_vertex(mesh.opposite_halfedge(hin), mk);
+
+                mesh.set_next_halfedge(second(hp), first(hk));
+                mesh.set_next_halfedge(first(hk),  hin);
+                mesh.set_face(second(hp), fk);
+                mesh.set_face(first(hk),  fk);
+                mesh.set_face(hin,        fk);
+                mesh.set_halfedge(fk, first(hk));
+
+                if (quads)
+                {
+                    mesh.set_next_halfedge(hin,  hout);
+                    mesh.set_next_halfedge(hout, second(hp));
+                    mesh.set_face(hout, fk);
+                }
+                else
+                {
+                    // the opposite halfedges bound the center triangle
+                    const Halfedge o = mesh.opposite_halfedge(hin);
+                    mesh.set_next_halfedge(hin, second(hp));
+                    mesh.set_next_halfedge(o, mesh.opposite_halfedge(inner(foffset[i] + (k+1) % n)));
+                    mesh.set_face(o, Face(fbase + 3));
+                }
+            }
+
+            const Halfedge h0 = mesh.opposite_halfedge(inner(foffset[i]));
+            if (quads)
+                mesh.set_halfedge(Vertex(nv + ne + i), h0);
+            else
+                mesh.set_halfedge(Face(fbase + 3), h0);
+        }
+    }
+
+
+    // outgoing halfedges, boundary halfedges for boundary vertices
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        if (vhalfedge[i].is_valid())
+            mesh.set_halfedge(Vertex(i), first(vhalfedge[i]));
+    }
+
+#pragma omp parallel for
+    for (int i=0; i<ne; ++i)
+    {
+        Halfedge h0(2*i), h1(2*i+1);
+        mesh.set_halfedge(Vertex(nv+i), face[h0.idx()].is_valid() ? second(h1) : second(h0));
+    }
+
+
+    // feature edges are split into feature edges. the properties are bit
+    // vectors, neighbouring flags must not be written concurrently.
+    auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+    auto efeature = mesh.get_edge_property<bool>("e:feature");
+    if (efeature)
+    {
+        if (!vfeature)
+            vfeature = mesh.add_vertex_property<bool>("v:feature", false);
+
+        for (int i=0; i<ne; ++i)
+        {
+            const bool feature = efeature[Surface_mesh::Edge(i)];
+            efeature[Surface_mesh::Edge(ne+i)] = feature;
+            vfeature[Vertex(nv+i)] = feature;
+        }
+    }
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
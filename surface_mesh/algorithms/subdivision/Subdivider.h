@@ -0,0 +1,100 @@
+//=============================================================================
+
+#ifndef GRAPHENE_SUBDIVIDER_H
+#define GRAPHENE_SUBDIVIDER_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Table-driven Loop and Catmull-Clark subdivision.
+///
+/// The refined connectivity follows a fixed numbering: old vertices keep
+/// their index, the vertex of edge e is nv+e and the vertex of face f is
+/// nv+ne+f (Catmull-Clark). Old edges and faces keep their index for one of
+/// their children, so existing properties stay attached to a part of their
+/// element. The whole refined mesh is allocated at once and connected in
+/// parallel, without split operations.
+///
+/// setup() precomputes for each level a stencil table that gives every
+/// refined vertex as weighted sum of vertices of the previous level. The
+/// tables only depend on the connectivity and the feature flags ("v:feature",
+/// "e:feature"), so moving the control points only needs update(). All
+/// meshes have to be free of deleted elements (see garbage_collection()).
+class Subdivider
+{
+public:
+
+    enum Scheme { LOOP, CATMULL_CLARK };
+
+    /// constructor
+    Subdivider(Scheme scheme);
+
+    /// precompute the tables for levels subdivision steps of the connectivity
+    /// of control. false if mesh has deleted elements, or non-triangles for
+    /// Loop subdivision.
+    bool setup(const Surface_mesh& control, unsigned int levels=1);
+
+    /// number of levels of the last setup()
+    unsigned int levels() const { return levels_.size(); }
+
+    /// replace mesh, which has the connectivity given to setup(), by its
+    /// subdivision. feature flags are propagated to the new elements.
+    bool refine(Surface_mesh& mesh) const;
+
+    /// refined vertex positions from control points, indexed by vertex index
+    void evaluate(const std::vector<Point>& control, std::vector<Point>& points) const;
+
+    /// move the vertices of refined, a result of refine(), to the subdivision
+    /// of the current positions of control
+    bool update(const Surface_mesh& control, Surface_mesh& refined) const;
+
+
+private:
+
+    // stencils of one level: refined vertex i is the sum of weight[j] times
+    // vertex index[j] of the previous level, j in [offset[i], offset[i+1])
+    struct Stencil_table
+    {
+        unsigned int               n_input;
+        std::vector<unsigned int>  offset;
+        std::vector<unsigned int>  index;
+        std::vector<Scalar>        weight;
+    };
+
+    // stencils for one step on mesh
+    void compute_stencils(const Surface_mesh& mesh, Stencil_table& table) const;
+
+    // one step of subdivision of the connectivity of mesh
+    void refine_connectivity(Surface_mesh& mesh) const;
+
+
+private:
+
+    Scheme  scheme_;
+
+    std::vector<Stencil_table> levels_;
+
+    // size of the control mesh
+    unsigned int n_vertices_, n_edges_, n_faces_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_SUBDIVIDER_H
+//=============================================================================
@@ -0,0 +1,29 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/adapt_subdivision.h>
+#include <graphene/surface_mesh/algorithms/subdivision/Adaptive_subdivider.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Laplace.h>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+void adapt_subdivision(Surface_mesh& mesh)
+{
+    Adaptive_subdivider subdivider(mesh);
+    subdivider.set_curvature_threshold(10.0);
+    subdivider.set_feature_distance(mean_edge_length(mesh));
+    subdivider.refine();
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -9,7 +9,9 @@ namespace surface_mesh {
 /// adapt mid subdivision 
 /// @{
 
-/// Perform one step of adapt midpoint subdivision on Surface_mesh \a mesh.
+/// Perform one step of adaptive subdivision on Surface_mesh \a mesh. Faces
+/// whose edges span more than 10 degrees of curvature or that lie within one
+/// mean edge length of a feature line are refined, see Adaptive_subdivider.
 void adapt_subdivision(Surface_mesh& mesh);
 
 /// @}
@@ -7,6 +7,7 @@
 //== INCLUDES =================================================================
 
 #include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/utility/Progress.h>
 
 
 //== NAMESPACE ================================================================
@@ -21,8 +22,10 @@ namespace surface_mesh {
 /// \addtogroup subdivision subdivision
 /// @{
 
-/// Perform one step of Loop subdivision on Surface_mesh \a mesh.
-void catmull_clark_subdivision(Surface_mesh& mesh);
+/// Perform one step of Catmull-Clark subdivision on Surface_mesh \a mesh.
+/// \a progress can stop it before the mesh is modified, returns false then.
+/// Uses a Subdivider, deleted elements are garbage collected first.
+bool catmull_clark_subdivision(Surface_mesh& mesh, utility::Progress* progress=NULL);
 
 /// @}
 
@@ -2,8 +2,16 @@
 
 #include <graphene/surface_mesh/algorithms/subdivision/feature extension.h>
 #include <graphene/surface_mesh/algorithms/surface_mesh_tools/diffgeo.h>
+#include <graphene/surface_mesh/data_structure/Feature_graph.h>
+#include <graphene/surface_mesh/data_structure/Segment_boundaries.h>
 #include <cmath>
+#include <cfloat>
+#include <cstdio>
 #include <graphene/macros.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 //== NAMESPACE ================================================================
 
@@ -13,173 +21,242 @@ namespace graphene {
 		//== IMPLEMENTATION ==========================================================
 
 		const Scalar PI = 3.1415926;
-		void feature_extension(Surface_mesh& mesh)
-		{
-			auto  vsa_pro = mesh.vertex_property<Scalar>("v:VSA segmentation propablitiy", 0);
-			auto  k_max = mesh.vertex_property<Scalar>("v:max curvature");
-			auto  k_min = mesh.vertex_property<Scalar>("v:min curvature");
-			auto  dir_min = mesh.vertex_property<Direction>("v:min direction");
-			auto  dir_max = mesh.vertex_property<Direction>("v:max direction");
-			auto  ldeleted = mesh.get_line_property<bool>("l:deleted");
 
-			FILE *clr = NULL;
-			clr = fopen("input_high.clr", "r");
-			
-			int num_high(0),num_low(0), vertex_n, patch_n, patchID, seed, patch_fN, faceID;
-			double R, G, B;
-			fscanf(clr, "%d", &num_high);
 
-			for (int k = 0; k < num_high; ++k)
+		namespace {
+
+
+		// the vertices of face f (group) and the other vertices of its edge
+		// neighbours (goals), each vertex once. false if f is invalid.
+		bool endpoint_candidates(const Surface_mesh& mesh, Surface_mesh::Face f,
+			std::vector<Endpoint>& group, std::vector<Endpoint>& goals)
+		{
+			group.clear();
+			goals.clear();
+			if (!f.is_valid()) return false;
+
+			std::unordered_set<int> seen;
+			for (auto v : mesh.vertices(f))
+			{
+				seen.insert(v.idx());
+				group.push_back({ v,0,0,0 });
+			}
+			for (auto h : mesh.halfedges(f))
 			{
-				auto VSA_seg2 = mesh.add_face_property<int>("f:vsa segment", -1);  //read VSA segmentation data
-				auto vsa_visited = mesh.add_vertex_property<bool>("v:vsa visited", false);
+				Surface_mesh::Face g = mesh.face(mesh.opposite_halfedge(h));
+				if (!g.is_valid()) continue;
+				for (auto v : mesh.vertices(g))
+				{
+					if (seen.insert(v.idx()).second)
+						goals.push_back({ v,0,0,0 });
+				}
+			}
+			return true;
+		}
 
-				fscanf(clr, "%d", &vertex_n);
 
-				if (vertex_n != mesh.n_vertices())
+		// hash grid over the feature vertices, answers the closest vertex of a
+		// given line without walking the line
+		class Feature_grid
+		{
+		public:
+
+			Feature_grid(Scalar cell_size) : cell_size_(cell_size) {}
+
+			void insert(Surface_mesh::FeatureVertex v, const Point& p, Surface_mesh::FeatureLine l)
+			{
+				int c[3];
+				cell(p, c);
+				if (cells_.empty())
 				{
-					std::cerr << "This *.clr file is not mathing mesh!" << std::endl;
-					break;
+					for (int i = 0; i < 3; ++i) min_[i] = max_[i] = c[i];
 				}
-				fscanf(clr, "%d", &patch_n);
-				int i, j;
-				for (i = 0; i < patch_n; ++i)
+				for (int i = 0; i < 3; ++i)
 				{
-					fscanf(clr, "%d %d %d", &patchID, &seed, &patch_fN);
-					for (j = 0; j < patch_fN; ++j)
-					{
-						fscanf(clr, "%d", &faceID);
-						VSA_seg2[Surface_mesh::Face(faceID)] = patchID;
-					}
-					fscanf(clr, "%lf %lf %lf", &R, &G, &B);
+					min_[i] = std::min(min_[i], c[i]);
+					max_[i] = std::max(max_[i], c[i]);
 				}
+				cells_[key(c[0], c[1], c[2])].push_back({ v, l.idx(), p });
+			}
+
+			// closest vertex of line l to p, searching shells of cells around p
+			// until no closer vertex is possible. invalid if l has no vertex.
+			Surface_mesh::FeatureVertex closest(const Point& p, Surface_mesh::FeatureLine l) const
+			{
+				Surface_mesh::FeatureVertex  best;
+				Scalar                       best_dist = FLT_MAX;
+				if (cells_.empty()) return best;
+
+				int c[3];
+				cell(p, c);
 
-				Surface_mesh::Edge_iterator eit, eend;
-				Surface_mesh::Face          f0, f1;
-				Normal n0, n1;
-				for (eit = mesh.edges_begin(), eend = mesh.edges_end(); eit != eend; ++eit)
+				for (int r = 0;; ++r)
 				{
-					if (!mesh.is_boundary(*eit))
+					// vertices outside the shells searched so far are at least
+					// (r-1) cells away, p can be anywhere in its cell
+					if (best.is_valid() && best_dist <= (r - 1) * cell_size_) break;
+					if (c[0] - r < min_[0] && c[0] + r > max_[0] &&
+						c[1] - r < min_[1] && c[1] + r > max_[1] &&
+						c[2] - r < min_[2] && c[2] + r > max_[2]) break;
+
+					for (int i = c[0] - r; i <= c[0] + r; ++i)
+					for (int j = c[1] - r; j <= c[1] + r; ++j)
+					for (int k = c[2] - r; k <= c[2] + r; ++k)
 					{
-						f0 = mesh.face(mesh.halfedge(*eit, 0));
-						f1 = mesh.face(mesh.halfedge(*eit, 1));
+						// only the boundary of the shell
+						if (std::abs(i - c[0]) != r && std::abs(j - c[1]) != r && std::abs(k - c[2]) != r) continue;
+
+						auto it = cells_.find(key(i, j, k));
+						if (it == cells_.end()) continue;
 
-						if (VSA_seg2[f0] != VSA_seg2[f1])
+						for (const Entry& e : it->second)
 						{
-							if (!vsa_visited[mesh.to_vertex(mesh.halfedge(*eit, 0))])
-							{
-								vsa_pro[mesh.to_vertex(mesh.halfedge(*eit, 0))] += 1;
-								vsa_visited[mesh.to_vertex(mesh.halfedge(*eit, 0))] = true;
-							}
-							if (!vsa_visited[mesh.from_vertex(mesh.halfedge(*eit, 0))])
+							if (e.line != l.idx()) continue;
+							Scalar d = dist(e.point, p);
+							if (d < best_dist)
 							{
-								vsa_pro[mesh.from_vertex(mesh.halfedge(*eit, 0))] += 1;
-								vsa_visited[mesh.from_vertex(mesh.halfedge(*eit, 0))] = true;
+								best_dist = d;
+								best = e.vertex;
 							}
 						}
 					}
 				}
-				mesh.remove_face_property(VSA_seg2);
-				mesh.remove_vertex_property(vsa_visited);
 
+				return best;
 			}
 
-			FILE *clr1 = NULL;
-			clr1 = fopen("input_low.clr", "r");
-			fscanf(clr1, "%d", &num_low);
-			for (int k = 0; k < num_low; ++k)
+		private:
+
+			struct Entry
+			{
+				Surface_mesh::FeatureVertex  vertex;
+				int                          line;
+				Point                        point;
+			};
+
+			void cell(const Point& p, int c[3]) const
+			{
+				for (int i = 0; i < 3; ++i)
+					c[i] = (int)std::floor(p[i] / cell_size_);
+			}
+
+			static long long key(int i, int j, int k)
 			{
-				auto VSA_seg2 = mesh.add_face_property<int>("f:vsa segment", -1);  //read VSA segmentation data
-				auto vsa_visited = mesh.add_vertex_property<bool>("v:vsa visited", false);
+				return (((long long)(i & 0x1fffff)) << 42) | (((long long)(j & 0x1fffff)) << 21) | (long long)(k & 0x1fffff);
+			}
+
+			Scalar                                              cell_size_;
+			int                                                 min_[3], max_[3];
+			std::unordered_map< long long, std::vector<Entry> > cells_;
+		};
+
+
+		// closest vertex of line l to p, updates the extension state of l like
+		// Surface_mesh::find_shortest_distance_point() when it is an end point
+		Surface_mesh::FeatureVertex connection_point(Surface_mesh& mesh, const Feature_grid& grid,
+			Surface_mesh::FeatureLine l, const Point& p)
+		{
+			Surface_mesh::FeatureVertex v = grid.closest(p, l);
 
-				fscanf(clr1, "%d", &vertex_n);
+			if (v == mesh.head(l))
+			{
+				if (mesh.get_exten(l) == 3)
+					mesh.set_exten(l, 2);
+				else mesh.set_exten(l, 0);
+			}
+			else if (v == mesh.tail(l))
+			{
+				if (mesh.get_exten(l) == 3)
+					mesh.set_exten(l, 1);
+				else mesh.set_exten(l, 0);
+			}
 
+			return v;
+		}
+
+
+
+		// read the VSA segmentations of a *.clr vote file into new face
+		// properties, appended to labels. stops at the first one not matching
+		// mesh. returns the number of segmentations the file declares.
+		int read_segmentations(Surface_mesh& mesh, const char* filename,
+			std::vector<Surface_mesh::Face_property<int> >& labels)
+		{
+			FILE* clr = fopen(filename, "r");
+			if (!clr) return 0;
+
+			int num(0), vertex_n, patch_n, patchID, seed, patch_fN, faceID;
+			double R, G, B;
+			fscanf(clr, "%d", &num);
+
+			for (int k = 0; k < num; ++k)
+			{
+				fscanf(clr, "%d", &vertex_n);
 				if (vertex_n != mesh.n_vertices())
 				{
 					std::cerr << "This *.clr file is not mathing mesh!" << std::endl;
 					break;
 				}
-				fscanf(clr1, "%d", &patch_n);
-				int i, j;
-				for (i = 0; i < patch_n; ++i)
+
+				auto VSA_seg2 = mesh.add_face_property<int>("f:vsa segment " + std::to_string(labels.size()), -1);
+				fscanf(clr, "%d", &patch_n);
+				for (int i = 0; i < patch_n; ++i)
 				{
-					fscanf(clr1, "%d %d %d", &patchID, &seed, &patch_fN);
-					for (j = 0; j < patch_fN; ++j)
+					fscanf(clr, "%d %d %d", &patchID, &seed, &patch_fN);
+					for (int j = 0; j < patch_fN; ++j)
 					{
-						fscanf(clr1, "%d", &faceID);
+						fscanf(clr, "%d", &faceID);
 						VSA_seg2[Surface_mesh::Face(faceID)] = patchID;
 					}
-					fscanf(clr1, "%lf %lf %lf", &R, &G, &B);
+					fscanf(clr, "%lf %lf %lf", &R, &G, &B);
 				}
+				labels.push_back(VSA_seg2);
+			}
 
-				Surface_mesh::Edge_iterator eit, eend;
-				Surface_mesh::Face          f0, f1;
-				Normal n0, n1;
-				for (eit = mesh.edges_begin(), eend = mesh.edges_end(); eit != eend; ++eit)
-				{
-					if (!mesh.is_boundary(*eit))
-					{
-						f0 = mesh.face(mesh.halfedge(*eit, 0));
-						f1 = mesh.face(mesh.halfedge(*eit, 1));
+			fclose(clr);
+			return num;
+		}
 
-						if (VSA_seg2[f0] != VSA_seg2[f1])
-						{
-							if (!vsa_visited[mesh.to_vertex(mesh.halfedge(*eit, 0))])
-							{
-								vsa_pro[mesh.to_vertex(mesh.halfedge(*eit, 0))] += 1;
-								vsa_visited[mesh.to_vertex(mesh.halfedge(*eit, 0))] = true;
-							}
-							if (!vsa_visited[mesh.from_vertex(mesh.halfedge(*eit, 0))])
-							{
-								vsa_pro[mesh.from_vertex(mesh.halfedge(*eit, 0))] += 1;
-								vsa_visited[mesh.from_vertex(mesh.halfedge(*eit, 0))] = true;
-							}
-						}
-					}
-				}
-				mesh.remove_face_property(VSA_seg2);
-				mesh.remove_vertex_property(vsa_visited);
+		} // anonymous namespace
 
-			}
 
-			for (int i = 0; i < mesh.n_vertices(); i++)
+		void feature_extension(Surface_mesh& mesh)
+		{
+			auto  vsa_pro = mesh.vertex_property<Scalar>("v:VSA segmentation propablitiy", 0);
+			auto  k_max = mesh.vertex_property<Scalar>("v:max curvature");
+			auto  k_min = mesh.vertex_property<Scalar>("v:min curvature");
+			auto  dir_min = mesh.vertex_property<Direction>("v:min direction");
+			auto  dir_max = mesh.vertex_property<Direction>("v:max direction");
+			auto  ldeleted = mesh.get_line_property<bool>("l:deleted");
+
+			// one vote per segmentation for each vertex on one of its boundaries,
+			// all boundaries found in one pass over the edges
+			std::vector<Surface_mesh::Face_property<int> > segmentations;
+			const int num_high = read_segmentations(mesh, "input_high.clr", segmentations);
+			const int num_low = read_segmentations(mesh, "input_low.clr", segmentations);
+
+			std::vector<Segment_boundaries> boundaries = segment_boundaries(mesh, segmentations);
+			for (unsigned int k = 0; k < boundaries.size(); ++k)
 			{
-				vsa_pro[Surface_mesh::Vertex(i)] =vsa_pro[Surface_mesh::Vertex(i)] / (num_high+num_low);
+				for (auto v : boundaries[k].vertices)
+					vsa_pro[v] += 1;
+				mesh.remove_face_property(segmentations[k]);
 			}
 
-			auto lineface = mesh.add_face_property<int>("f:line face", -1);
-			auto visted = mesh.add_vertex_property<int>("v:used", -1);    //߽
-			for (auto l : mesh.lines())
+			if (num_high + num_low > 0)
 			{
-				if (ldeleted[l]) continue;
-				Surface_mesh::Halfedge_around_line_circulator  hit;
-				Surface_mesh::FeatureVertex vit, vend;
-				Surface_mesh::Face f;
-				//Surface_mesh::FeatureLine line;
-				int k(0);
-				hit = mesh.halfedges(l);
-				vend = mesh.tail(l);
-
-				while (mesh.to_vertex(*hit) != vend)
+				for (int i = 0; i < mesh.n_vertices(); i++)
 				{
-					vit = mesh.to_vertex(*hit);
-					f = mesh.face(*hit);
-					if (f.is_valid())
-					{
-						k++;
-						//face_line[f] = mesh.line(*hit).idx();
-						lineface[f] = l.idx();
-					}
-					++hit;
-				}
-				vit = mesh.to_vertex(*hit);
-				f = mesh.face(*hit);
-				if (f.is_valid())
-				{
-					lineface[f] = mesh.line(*hit).idx();
+					vsa_pro[Surface_mesh::Vertex(i)] = vsa_pro[Surface_mesh::Vertex(i)] / (num_high + num_low);
 				}
 			}
 
+			auto lineface = mesh.add_face_property<int>("f:line face", -1);
+			auto visted = mesh.add_vertex_property<int>("v:used", -1);    //߽
+			Feature_graph graph(mesh);
+			for (auto f : mesh.faces())
+				lineface[f] = graph.line(f).idx();
+
 			for (auto f : mesh.faces())
 			{
 				if (lineface[f] != -1)
@@ -236,50 +313,14 @@ namespace graphene {
 				}*/
 
 				
-				if (mesh.get_exten(l) != 2 && mesh.get_exten(l) != 0)          //ͷ˵   
+				if (mesh.get_exten(l) != 2 && mesh.get_exten(l) != 0 &&
+					endpoint_candidates(mesh, mesh.face(mesh.halfedge(l)), group, goals))          //ͷ˵   
 				{
 					Surface_mesh::FeatureHalfedge hhead,next_hhead;
 					Surface_mesh::FeatureVertex vhead;
-					Surface_mesh::Halfedge_around_face_circulator hit, hend;
-					Surface_mesh::Vertex_around_face_circulator vit, vend;
-					Surface_mesh::Halfedge h;
 					Scalar cosine, denom;
 					Point  vec1, vec2, vec3;
 					hhead = mesh.halfedge(l);
-					f = mesh.face(hhead);
-					vit = vend = mesh.vertices(f);
-					do
-					{
-						group.push_back({ *vit,0,0,0 });
-						//goals.push_back({ *vit,0,0,0 });
-						++vit;
-					} while (vit != vend);
-					hit = hend = mesh.halfedges(f);
-					do 
-					{
-						h = mesh.opposite_halfedge(*hit);
-						f = mesh.face(h);
-						vit = vend = mesh.vertices(f);
-						do 
-						{
-							bool flag = true;
-							for (auto iter = group.begin();iter != group.end();iter++)
-							{
-								Surface_mesh::Vertex v1, v2;
-								v1 = iter->v;
-								v2 = *vit;
-								if (*vit == iter->v)
-								{
-									flag = false;
-									break;
-								}
-							}
-							if (flag)
-								goals.push_back({ *vit,0,0,0 });
-							++vit;
-						} while (vit != vend);
-						++hit;
-					} while (hit != hend);
 					Surface_mesh::Vertex aimVertex,aimVertex1;
 					Scalar min(1000);
 					Surface_mesh::FeatureVertex new_v;
@@ -374,53 +415,15 @@ namespace graphene {
 						}
 					}*/
 					
-					group.clear();
-					goals.clear();
 				}
-				if (mesh.get_exten(l) != 1 && mesh.get_exten(l) != 0)         //β˵
+				if (mesh.get_exten(l) != 1 && mesh.get_exten(l) != 0 &&
+					endpoint_candidates(mesh, mesh.face(mesh.tail_halfedge(l)), group, goals))         //β˵
 				{
 					Surface_mesh::FeatureHalfedge htail, pre_htail;
 					Surface_mesh::FeatureVertex vtail;
-					Surface_mesh::Halfedge_around_face_circulator hit, hend;
-					Surface_mesh::Vertex_around_face_circulator vit, vend;
-					Surface_mesh::Halfedge h;
 					Scalar cosine, denom;
 					Point  vec1, vec2, vec3;
 					htail = mesh.tail_halfedge(l);
-					
-					f = mesh.face(htail);
-					vit = vend = mesh.vertices(f);
-					do
-					{
-						group.push_back({ *vit,0,0,0 });
-						++vit;
-					} while (vit != vend);
-					hit = hend = mesh.halfedges(f);
-					do
-					{
-						h = mesh.opposite_halfedge(*hit);
-						f = mesh.face(h);
-						vit = vend = mesh.vertices(f);
-						do
-						{
-							bool flag = true;
-							for (auto iter = group.begin(); iter != group.end(); iter++)
-							{
-								Surface_mesh::Vertex v1, v2;
-								v1 = iter->v;
-								v2 = *vit;
-								if (*vit == iter->v)
-								{
-									flag = false;
-									break;
-								}
-							}
-							if (flag)
-								goals.push_back({ *vit,0,0,0 });
-							++vit;
-						} while (vit != vend);
-						++hit;
-					} while (hit != hend);
 					Surface_mesh::Vertex aimVertex,aimVertex1;
 					Scalar maxcos(-1),mindis(10);
 					Surface_mesh::FeatureVertex new_v1;
@@ -512,19 +515,39 @@ namespace graphene {
 							
 						}
 					}*/
-					group.clear();
-					goals.clear();
 				}
 			}
 
 		
 			
+			// index the feature vertices for the connection queries, cells of
+			// about two edge lengths. the end points moved, rebuild the graph.
+			Scalar edge_length(0);
+			for (auto e : mesh.edges())
+				edge_length += mesh.edge_length(e);
+			if (mesh.n_edges())
+				edge_length /= mesh.n_edges();
+
+			Feature_grid grid(edge_length > 0 ? 2 * edge_length : 1);
+			std::vector<Surface_mesh::FeatureLine> active;
+			graph.build(mesh);
+			for (auto l : mesh.lines())
+			{
+				for (unsigned int i = 0; i < graph.size(l); ++i)
+					grid.insert(graph.vertex(l, i), graph.point(l, i), l);
+				if (ldeleted[l]) continue;
+
+				if (mesh.head(l) == mesh.tail(l) || mesh.to_vertex(mesh.halfedge(l)) == mesh.tail(l)) continue;
+				if (mesh.get_exten(l) != 0)
+					active.push_back(l);
+			}
+
+			// extend the lines that are still open, two steps per pass
 			std::vector<Candidate>  candidate;
 			std::vector<Candidate>  add_point;
-			bool stop = false;
-			while (!stop)
+			while (!active.empty())
 			{
-				for (auto l : mesh.lines())
+				for (auto l : active)
 				{
 					if (mesh.is_deleted(l) || mesh.head(l) == mesh.tail(l) || mesh.to_vertex(mesh.halfedge(l)) == mesh.tail(l)) continue;
 					Surface_mesh::Vertex_around_vertex_circulator vvit, vvend;
@@ -573,6 +596,7 @@ namespace graphene {
 								{
 									Surface_mesh::FeatureVertex new_v2 = mesh.add_feature_vertex(vpoints[addpoint.v]);
 									mesh.insert_head_vertex(l, new_v2, -1);
+									grid.insert(new_v2, fpoints[new_v2], l);
 
 									step++;
 									seed = addpoint.v;
@@ -582,9 +606,12 @@ namespace graphene {
 											mesh.set_exten(l, 2);
 										else
 											mesh.set_exten(l, 0);
-										new_v2 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v2]);
-										if (new_v2 != mesh.head(l))
+										new_v2 = connection_point(mesh, grid, Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v2]);
+										if (new_v2.is_valid() && new_v2 != mesh.head(l))
+										{
 											mesh.insert_head_vertex(l, new_v2, -1);
+											grid.insert(new_v2, fpoints[new_v2], l);
+										}
 										break;
 									}
 									visted[seed] = l.idx();
@@ -632,6 +659,7 @@ namespace graphene {
 							}
 							Surface_mesh::FeatureVertex new_v2 = mesh.add_feature_vertex(vpoints[addpoint.v]);
 							mesh.insert_head_vertex(l, new_v2, -1);
+							grid.insert(new_v2, fpoints[new_v2], l);
 							step++;
 							seed = addpoint.v;
 							if (visted[seed] != -1 /*&& mesh.is_ridge(Surface_mesh::FeatureLine(visted[seed])) == mesh.is_ridge(l)*/)
@@ -640,9 +668,12 @@ namespace graphene {
 									mesh.set_exten(l, 2);
 								else
 									mesh.set_exten(l, 0);
-								new_v2 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v2]);
-								if (new_v2 != mesh.head(l))
+								new_v2 = connection_point(mesh, grid, Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v2]);
+								if (new_v2.is_valid() && new_v2 != mesh.head(l))
+								{
 									mesh.insert_head_vertex(l, new_v2, -1);
+									grid.insert(new_v2, fpoints[new_v2], l);
+								}
 								break;
 							}
 							visted[seed] = l.idx();
@@ -689,6 +720,7 @@ namespace graphene {
 								step++;
 								Surface_mesh::FeatureVertex new_v3 = mesh.add_feature_vertex(vpoints[addpoint.v]);
 								mesh.insert_tail_vertex(l, new_v3, -1);
+								grid.insert(new_v3, fpoints[new_v3], l);
 								seed = addpoint.v;
 								if (visted[seed] != -1 /*&& mesh.is_ridge(Surface_mesh::FeatureLine(visted[seed])) == mesh.is_ridge(l)*/)
 								{
@@ -696,9 +728,12 @@ namespace graphene {
 										mesh.set_exten(l, 1);
 									else
 										mesh.set_exten(l, 0);
-									new_v3 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v3]);
-									if (new_v3 != mesh.tail(l))
-									    mesh.insert_tail_vertex(l, new_v3, -1);
+									new_v3 = connection_point(mesh, grid, Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v3]);
+									if (new_v3.is_valid() && new_v3 != mesh.tail(l))
+									{
+										mesh.insert_tail_vertex(l, new_v3, -1);
+										grid.insert(new_v3, fpoints[new_v3], l);
+									}
 									break;
 								}
 								visted[seed] = l.idx();
@@ -740,6 +775,7 @@ namespace graphene {
 							}
 							Surface_mesh::FeatureVertex new_v3 = mesh.add_feature_vertex(vpoints[addpoint.v]);
 							mesh.insert_tail_vertex(l, new_v3, -1);
+							grid.insert(new_v3, fpoints[new_v3], l);
 							step++;
 							seed = addpoint.v;
 							if (visted[seed] != -1 /*&& mesh.is_ridge(Surface_mesh::FeatureLine(visted[seed])) == mesh.is_ridge(l)*/)
@@ -748,9 +784,12 @@ namespace graphene {
 									mesh.set_exten(l, 1);
 								else
 									mesh.set_exten(l, 0);
-								new_v3 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v3]);
-								if (new_v3 != mesh.tail(l))
-								    mesh.insert_tail_vertex(l, new_v3, -1);
+								new_v3 = connection_point(mesh, grid, Surface_mesh::FeatureLine(visted[seed]), fpoints[new_v3]);
+								if (new_v3.is_valid() && new_v3 != mesh.tail(l))
+								{
+									mesh.insert_tail_vertex(l, new_v3, -1);
+									grid.insert(new_v3, fpoints[new_v3], l);
+								}
 								break;
 							}
 							mesh.update_lineporp(l, addpoint.v, false);
@@ -760,20 +799,15 @@ namespace graphene {
 					}
 				}
 
-				bool flag = true;
-				for (auto l : mesh.lines())
+				// lines connect or are closed by other lines, drop them
+				size_t n = 0;
+				for (auto l : active)
 				{
 					if (ldeleted[l] || mesh.head(l) == mesh.tail(l) || mesh.to_vertex(mesh.halfedge(l)) == mesh.tail(l)) continue;
 					if (mesh.get_exten(l) != 0)
-					{
-						flag = false;
-						break;
-					}
-				}
-				if (flag)
-				{
-					stop = true;
+						active[n++] = l;
 				}
+				active.resize(n);
 			}
 
 			//-----------------Ϣ------------//
@@ -1,6 +1,9 @@
 //== INCLUDES =================================================================
 
 #include <graphene/surface_mesh/algorithms/subdivision/line_dilate.h>
+#include <graphene/surface_mesh/data_structure/Feature_graph.h>
+#include <algorithm>
+#include <vector>
 
 //== NAMESPACE ================================================================
 
@@ -96,35 +99,9 @@ namespace graphene {
 			//}
 
 			/************************It only dilate the end point********************************/
-			for (auto l : mesh.lines())
-			{
-				Surface_mesh::Halfedge_around_line_circulator  hit;
-				Surface_mesh::FeatureVertex vit, vend;
-				Surface_mesh::Face f;
-				//Surface_mesh::FeatureLine line;
-				int k(0);
-				hit = mesh.halfedges(l);
-				vend = mesh.tail(l);
-
-				while (mesh.to_vertex(*hit) != vend)
-				{
-					vit = mesh.to_vertex(*hit);
-					f = mesh.face(*hit);
-					if (f.is_valid())
-					{
-						k++;
-						//face_line[f] = mesh.line(*hit).idx();
-						face_line[f] = l.idx();
-					}
-					++hit;
-				}
-				vit = mesh.to_vertex(*hit);
-				f = mesh.face(*hit);
-				if (f.is_valid())
-				{
-					face_line[f] = mesh.line(*hit).idx();
-				}
-			}
+			Feature_graph graph(mesh);
+			for (auto f : mesh.faces())
+				face_line[f] = graph.line(f).idx();
 
 			auto vertex_line = mesh.add_vertex_property<int>("v:the line id of vertex", -1);
 			for (auto f : mesh.faces())
@@ -141,130 +118,59 @@ namespace graphene {
 				}
 			}
 
+			// pairs of lines whose end faces touch the faces of another line. the
+			// mesh is only read here, so lines are checked in parallel, each into
+			// its own sorted pair list, and the lists are merged afterwards.
+			std::vector<Surface_mesh::FeatureLine> lines;
 			for (auto l : mesh.lines())
+				lines.push_back(l);
+
+			const int n_lines = lines.size();
+			std::vector<line_connect> line_pairs(n_lines);
+
+#pragma omp parallel for schedule(dynamic)
+			for (int i = 0; i < n_lines; ++i)
 			{
-				if (mesh.head(l) == mesh.tail(l)) continue;             //
-				Surface_mesh::Halfedge_around_line_circulator  hit,hits;
-				Surface_mesh::Vertex_around_face_circulator  fvit, fvend;
-				Surface_mesh::Face_around_vertex_circulator  fit, fend;
-				Surface_mesh::FeatureVertex vhead, vtail;
-				Surface_mesh::Vertex v;
-				Surface_mesh::Face f;
-				Surface_mesh::FeatureLine line;
-				Surface_mesh::EndPoint ep;
-				hit = mesh.halfedges(l);
-				vhead = mesh.head(l);
-				vtail = mesh.tail(l);
+				Surface_mesh::FeatureLine l = lines[i];
+				const unsigned int n = graph.size(l);
+				if (n < 2 || graph.vertex(l, 0) == graph.vertex(l, n - 1)) continue;             //
 				//һϵ߶β
-				if (mesh.to_vertex(*hit) == vtail) continue;
-				if (mesh.to_vertex(mesh.next_halfedge(*hit)) == vtail)  continue;
+				if (n < 4) continue;
 
-				do
+				// the faces of the first and the last segment
+				line_connect& pairs = line_pairs[i];
+				Surface_mesh::Face ends[2] = { graph.face(l, 0), graph.face(l, n - 2) };
+				for (int e = 0; e < 2; ++e)
 				{
-					/*Surface_mesh::FeatureVertex v1, v2;
-					v1 = mesh.from_vertex(*hit);
-					v2 = mesh.to_vertex(*hit);*/
-					if (mesh.from_vertex(*hit) == vhead || mesh.to_vertex(*hit) == vtail)
-					{
+					Surface_mesh::Face f = ends[e];
+					if (!f.is_valid()) continue;
 
-						f = mesh.face(*hit);
-						if (f.is_valid())
+					for (auto v : mesh.vertices(f))
+					{
+						for (auto g : mesh.faces(v))
 						{
-							/*if (mesh.from_vertex(*hit) == vhead)
-								ep = mesh.add_end_point(l, *hit, vhead, f, true);
-							else
-								ep = mesh.add_end_point(l, *hit, vtail, f, false);*/
-
-							fvit = fvend = mesh.vertices(f);
-							do
+							if (g == f) continue;
+							for (auto w : mesh.vertices(g))
 							{
-								v = *fvit;
-								fit = fend = mesh.faces(v);
-								//bool stop = false;
-								do
-								{
-
-									if (f != *fit)
-									{
-										Surface_mesh::Vertex_around_face_circulator  fvit1, fvend1;
-										fvit1 = fvend1 = mesh.vertices(*fit);
-										do
-										{
-											
-											//int fit_id = face_line[*fit] % MAX, f_id = face_line[f] % MAX;
-											int fit_id = vertex_line[*fvit1], f_id = l.idx();
-											if (fit_id == f_id) continue;
-											if (fit_id != -1 && fit_id != f_id)
-											{
-												Surface_mesh::FeatureLine ls = Surface_mesh::FeatureLine(fit_id);
-												//int m = mesh.get_line_num(ls);
-												//int n = mesh.get_line_num(ls);
-												if (mesh.get_line_num(ls) == 1 ) continue;
-												line_connect::const_iterator ncIt(connect_cache.begin()), ncEnd(connect_cache.end());
-												bool flag = false;
-												for (; ncIt != ncEnd; ++ncIt)
-												{
-													if ((f_id == ncIt->first && fit_id == ncIt->second) || (fit_id == ncIt->first && f_id == ncIt->second))
-														flag = true;
-												}
-												if (!flag)
-												{
-												//	mesh.join(Surface_mesh::FeatureLine(fit_id), l);
-												//	if (mesh.from_vertex(*hit) == vhead)
-												//	{
-												//		if (mesh.get_exten(l) == 3||mesh.get_exten(l) == 1)
-												//		{
-												//			Surface_mesh::FeatureVertex new_v1;
-												//			mesh.insert_head_vertex(l, mesh.add_feature_vertex(vpoints[*fvit1]), -1);
-												//			mesh.update_featureLine(l, *fvit1, true);
-												//			new_v1 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(fit_id), vpoints[*fvit1]);
-												//			if (new_v1.is_valid())
-												//			{
-												//				mesh.insert_head_vertex(l, new_v1, -1);
-												//				if (mesh.get_exten(l) == 3)
-												//					mesh.set_exten(l, 2);
-												//				else
-												//					mesh.set_exten(l, 0);
-												//			}
-												//		}
-												//	}
-												//	else
-												//	{
-												//		if (mesh.get_exten(l) == 3 || mesh.get_exten(l) == 2)
-												//		{
-												//			Surface_mesh::FeatureVertex new_v2;
-												//			//new_v2 = mesh.add_feature_vertex(fpoints[mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(fit_id), vpoints[*fvit1])]);
-												//			mesh.insert_tail_vertex(l, mesh.add_feature_vertex(vpoints[*fvit1]), -1);
-												//			mesh.update_featureLine(l, *fvit1, false);
-												//			new_v2 = mesh.find_shortest_distance_point(Surface_mesh::FeatureLine(fit_id), vpoints[*fvit1]);
-												//			if (new_v2.is_valid())
-												//			{
-												//				mesh.insert_tail_vertex(l, new_v2, -1);
-												//				if (mesh.get_exten(l) == 3)
-												//					mesh.set_exten(l, 1);
-												//				else
-												//					mesh.set_exten(l, 0);
-												//			}
-												//		}
-												//	}
-												//	connect_cache.push_back(Connect(fit_id, f_id));
-												//}
-												//break;
-											}
-											/*else
-												face_line[*fit] = face_line[f]+MAX;*/
-										} while (++fvit1 != fvend1);
-									}
-								} while (++fit != fend);
-								//if (stop)  break;
-							} while (++fvit != fvend);
+								int id = vertex_line[w];
+								if (id == -1 || id == l.idx()) continue;
+								if (mesh.get_line_num(Surface_mesh::FeatureLine(id)) == 1) continue;
+								pairs.push_back(Connect(std::min(id, l.idx()), std::max(id, l.idx())));
+							}
 						}
 					}
-					if (mesh.to_vertex(*hit) == vtail) break;
-					++hit;
-				} while (1);
+				}
+
+				std::sort(pairs.begin(), pairs.end());
+				pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
 			}
 
+			// each unordered pair once
+			for (int i = 0; i < n_lines; ++i)
+				connect_cache.insert(connect_cache.end(), line_pairs[i].begin(), line_pairs[i].end());
+			std::sort(connect_cache.begin(), connect_cache.end());
+			connect_cache.erase(std::unique(connect_cache.begin(), connect_cache.end()), connect_cache.end());
+
 			FILE  *out = fopen("connect.txt", "w");
 			line_connect::const_iterator ncIt(connect_cache.begin()), ncEnd(connect_cache.end());
 			for (; ncIt != ncEnd; ++ncIt)
@@ -334,6 +240,12 @@ namespace graphene {
 					}
 					fscanf(clr1, "%lf %lf %lf", &R, &G, &B);
 				}
+				// lines by parent, in index order
+				std::vector< std::vector<Surface_mesh::FeatureLine> > parent_lines(mesh.flines_size());
+				std::vector<unsigned int> parent_marked(mesh.flines_size(), 0);
+				for (auto l : mesh.lines())
+					parent_lines[mesh.get_parent(l).idx()].push_back(l);
+
 				for (auto l : mesh.lines())
 				{
 					Surface_mesh::FeatureHalfedge hhead;
@@ -405,13 +317,13 @@ namespace graphene {
 								save_line[par_l] = true;
 							}
 						
-						for (auto ls : mesh.lines())
+						// the earlier lines with the same parent, each marked once
+						std::vector<Surface_mesh::FeatureLine>& children = parent_lines[par_l.idx()];
+						for (; parent_marked[par_l.idx()] < children.size(); ++parent_marked[par_l.idx()])
 						{
-							if(ls.idx() == l.idx()) break;
-							if (mesh.get_parent(ls) == par_l)
-							{
-								save_line[ls] = true;
-							}
+							Surface_mesh::FeatureLine ls = children[parent_marked[par_l.idx()]];
+							if (ls.idx() >= l.idx()) break;
+							save_line[ls] = true;
 						}
 						}
 					}
@@ -7,6 +7,7 @@
 //== INCLUDES =================================================================
 
 #include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/utility/Progress.h>
 
 
 //== NAMESPACE ================================================================
@@ -22,7 +23,10 @@ namespace surface_mesh {
 /// @{
 
 /// Perform one step of Loop subdivision on Surface_mesh \a mesh.
-void loop_subdivision(Surface_mesh& mesh);
+/// \a progress can stop it before the mesh is modified, returns false then.
+/// Returns false without changes if \a mesh is not a triangle mesh.
+/// Uses a Subdivider, deleted elements are garbage collected first.
+bool loop_subdivision(Surface_mesh& mesh, utility::Progress* progress=NULL);
 
 /// @}
 
@@ -21,14 +21,18 @@ void sqrt3_subdivision(Surface_mesh& mesh)
 
     // compute new positions of old vertices
     Surface_mesh::Vertex_property<Point> new_pos = mesh.add_vertex_property<Point>("v:np");
-    for (vit=mesh.vertices_begin(); vit!=vend; ++vit)
+    const int n_vertices = mesh.vertices_size();
+
+#pragma omp parallel for
+    for (int i=0; i<n_vertices; ++i)
     {
-        if (!mesh.is_boundary(*vit))
+        Surface_mesh::Vertex v(i);
+        if (!mesh.is_deleted(v) && !mesh.is_boundary(v))
         {
-            Scalar n = mesh.valence(*vit);
+            Scalar n = mesh.valence(v);
             Scalar alpha = (4.0 - 2.0*cos(2.0*M_PI/n)) / 9.0;
             Point  p(0,0,0);
-            Surface_mesh::Vertex_around_vertex_circulator vvit=mesh.vertices(*vit), vvend=vvit;
+            Surface_mesh::Vertex_around_vertex_circulator vvit=mesh.vertices(v), vvend=vvit;
 
             do
             {
@@ -36,19 +40,26 @@ void sqrt3_subdivision(Surface_mesh& mesh)
             }
             while (++vvit != vvend);
 
-            p = (1.0f-alpha)*points[*vit] + alpha/n*p;
-            new_pos[*vit] = p;
+            p = (1.0f-alpha)*points[v] + alpha/n*p;
+            new_pos[v] = p;
         }
     }
 
 
-    // split faces
-    for (fit=mesh.faces_begin(); fit!=fend; ++fit)
+    // compute face centers
+    Surface_mesh::Face_property<Point> center = mesh.add_face_property<Point>("f:center");
+    const int n_faces = mesh.faces_size();
+
+#pragma omp parallel for
+    for (int i=0; i<n_faces; ++i)
     {
+        Surface_mesh::Face f(i);
+        if (mesh.is_deleted(f)) continue;
+
         Point  p(0,0,0);
         Scalar c(0);
-        Surface_mesh::Vertex_around_face_circulator fvit = mesh.vertices(*fit), fvend=fvit;
-		
+        Surface_mesh::Vertex_around_face_circulator fvit = mesh.vertices(f), fvend=fvit;
+
         do
         {
             p += points[*fvit];
@@ -56,8 +67,14 @@ void sqrt3_subdivision(Surface_mesh& mesh)
         }
         while (++fvit!=fvend);
 
-        p /= c;
+        center[f] = p / c;
+    }
+
 
+    // split faces
+    for (fit=mesh.faces_begin(); fit!=fend; ++fit)
+    {
+        const Point p = center[*fit];
         mesh.split(*fit, p);
     }
 
@@ -72,6 +89,7 @@ void sqrt3_subdivision(Surface_mesh& mesh)
     }
 
     mesh.remove_vertex_property(new_pos);
+    mesh.remove_face_property(center);
 
 
     // flip old edges
@@ -82,6 +100,8 @@ void sqrt3_subdivision(Surface_mesh& mesh)
             mesh.flip(*eit);
         }
     }
+
+    mesh.geometry_changed();
 }
 
 //=============================================================================
@@ -3,6 +3,9 @@
 #include "Curvature.h"
 #include <graphene/geometry/Matrix3x3.h>
 
+#include <algorithm>
+#include <iterator>
+
 
 //== NAMESPACES ===============================================================
 
@@ -14,10 +17,15 @@ namespace surface_mesh {
 
 
 Curvature_analyzer::Curvature_analyzer(Surface_mesh& mesh)
-  : mesh_(mesh)
+  : mesh_(mesh), cache_(mesh), analyzed_(false), tensor_(false), two_ring_(false), smoothing_steps_(0), revision_(0)
 {
     min_curvature_ = mesh_.add_vertex_property<Scalar>("curv:min");
     max_curvature_ = mesh_.add_vertex_property<Scalar>("curv:max");
+    min_direction_ = mesh_.add_vertex_property<Direction>("curv:min direction", Direction(0,0,0));
+    max_direction_ = mesh_.add_vertex_property<Direction>("curv:max direction", Direction(0,0,0));
+
+    raw_min_curvature_ = mesh_.add_vertex_property<Scalar>("curv:raw min");
+    raw_max_curvature_ = mesh_.add_vertex_property<Scalar>("curv:raw max");
 }
 
 
@@ -28,6 +36,13 @@ Curvature_analyzer::~Curvature_analyzer()
 {
     mesh_.remove_vertex_property(min_curvature_);
     mesh_.remove_vertex_property(max_curvature_);
+    mesh_.remove_vertex_property(min_direction_);
+    mesh_.remove_vertex_property(max_direction_);
+
+    mesh_.remove_vertex_property(raw_min_curvature_);
+    mesh_.remove_vertex_property(raw_max_curvature_);
+    if (edge_tensor_)
+        mesh_.remove_edge_property(edge_tensor_);
 }
 
 
@@ -36,53 +51,269 @@ Curvature_analyzer::~Curvature_analyzer()
 
 void Curvature_analyzer::analyze(unsigned int smoothing_steps)
 {
+    analyzed_        = true;
+    tensor_          = false;
+    two_ring_        = false;
+    smoothing_steps_ = smoothing_steps;
+
+    analyze_all();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void Curvature_analyzer::analyze_tensor(unsigned int smoothing_steps,
+                                        bool two_ring_neighborhood)
+{
+    analyzed_        = true;
+    tensor_          = true;
+    two_ring_        = two_ring_neighborhood;
+    smoothing_steps_ = smoothing_steps;
+
+    if (!edge_tensor_)
+        edge_tensor_ = mesh_.add_edge_property<Edge_tensor>("curv:edge tensor");
+
+    analyze_all();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void Curvature_analyzer::analyze_all()
+{
+    dirty_.clear();
+    cache_.update();
+    revision_ = mesh_.revision();
+
+    std::vector<Surface_mesh::Vertex> vertices;
+    vertices.reserve(mesh_.n_vertices());
+
     Surface_mesh::Vertex_iterator vit, vend=mesh_.vertices_end();
-    Surface_mesh::Edge_iterator   eit, eend=mesh_.edges_end();
+    for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+        vertices.push_back(*vit);
+
+    if (tensor_)
+    {
+        std::vector<Surface_mesh::Edge> edges;
+        edges.reserve(mesh_.n_edges());
+
+        Surface_mesh::Edge_iterator eit, eend=mesh_.edges_end();
+        for (eit=mesh_.edges_begin(); eit!=eend; ++eit)
+            edges.push_back(*eit);
+
+        compute_edge_tensors(edges);
+        compute_tensor_curvatures(vertices);
+    }
+    else
+    {
+        compute_curvatures(vertices);
+    }
+    smooth_curvatures(vertices, vertices);
+}
 
-    Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
-    Surface_mesh::Vertex v;
 
+//-----------------------------------------------------------------------------
 
-    Scalar  kmin, kmax, mean, gauss;
-    Scalar  area, sum_angles;
-    Scalar  weight, sum_weights;
-    Point   p0, p1, p2, laplace;
 
+void Curvature_analyzer::update()
+{
+    if (!analyzed_)
+        return;
 
-    // cotan weight per edge
-    Surface_mesh::Edge_property<double>  cotan = mesh_.add_edge_property<double>("curv:cotan");
-    for (eit=mesh_.edges_begin(); eit!=eend; ++eit)
+    // the mesh changed as a whole since the last analysis
+    if (revision_ != mesh_.revision())
     {
-        cotan[*eit] = cotan_weight(mesh_, *eit);
+        analyze_all();
+        return;
     }
 
+    if (dirty_.empty())
+        return;
+
+    // areas and cotan weights around the dirty vertices
+    cache_.update();
+
+
+    // dirty vertices still alive
+    std::vector<Surface_mesh::Vertex> vertices;
+    for (unsigned int i=0; i<dirty_.size(); ++i)
+        if (!mesh_.is_deleted(dirty_[i]))
+            vertices.push_back(dirty_[i]);
+    dirty_.clear();
+
+
+    // edges of the faces around the dirty vertices: their faces changed
+    Surface_mesh::Face_around_vertex_circulator      fvit, fvend;
+    Surface_mesh::Halfedge_around_face_circulator    hfit, hfend;
+    Surface_mesh::Halfedge_around_vertex_circulator  hvit, hvend;
+    std::vector<Surface_mesh::Edge> edges;
+
+    for (unsigned int i=0; i<vertices.size(); ++i)
+    {
+        hvit = hvend = mesh_.halfedges(vertices[i]);
+        if (hvit) do
+        {
+            edges.push_back(mesh_.edge(*hvit));
+        }
+        while (++hvit != hvend);
+
+        fvit = fvend = mesh_.faces(vertices[i]);
+        if (fvit) do
+        {
+            hfit = hfend = mesh_.halfedges(*fvit);
+            do
+            {
+                edges.push_back(mesh_.edge(*hfit));
+            }
+            while (++hfit != hfend);
+        }
+        while (++fvit != fvend);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    if (tensor_)
+        compute_edge_tensors(edges);
+
+
+    // Voronoi areas change in the one-ring
+    grow(vertices, 1);
+
+
+    // curvature uses the edges around a vertex (and its one-ring with
+    // two_ring_), boundary vertices interpolate their neighbors
+    grow(vertices, (tensor_ && !two_ring_) ? 0 : 1);
+    if (tensor_)
+        compute_tensor_curvatures(vertices);
+    else
+        compute_curvatures(vertices);
+
+
+    // smoothing spreads the change by one ring per step. smooth a larger
+    // region, its outer vertices would depend on vertices outside.
+    grow(vertices, smoothing_steps_);
+    std::vector<Surface_mesh::Vertex> region(vertices);
+    grow(region, smoothing_steps_);
+    smooth_curvatures(region, vertices);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void Curvature_analyzer::grow(std::vector<Surface_mesh::Vertex>& vertices,
+                              unsigned int n) const
+{
+    Surface_mesh::Vertex_around_vertex_circulator vvit, vvend;
+
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    for (unsigned int k=0; k<n; ++k)
+    {
+        const unsigned int m = vertices.size();
+        for (unsigned int i=0; i<m; ++i)
+        {
+            vvit = vvend = mesh_.vertices(vertices[i]);
+            if (vvit) do
+            {
+                vertices.push_back(*vvit);
+            }
+            while (++vvit != vvend);
+        }
+
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void Curvature_analyzer::compute_edge_tensors(const std::vector<Surface_mesh::Edge>& edges)
+{
+    const int n = edges.size();
+
+    // dihedral_angle*edge_length*e*e^T, the face normals are computed on
+    // the fly instead of in a separate pass
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
+    {
+        const Surface_mesh::Edge e = edges[i];
+
+        Surface_mesh::Halfedge  h0, h1;
+        Surface_mesh::Face      f0, f1;
+        Vec3d                   n0, n1, d;
+        double                  l, w;
+        Edge_tensor&            t = edge_tensor_[e];
+
+        t.xx = t.xy = t.xz = t.yy = t.yz = t.zz = 0.0;
+
+        h0 = mesh_.halfedge(e, 0);
+        h1 = mesh_.halfedge(e, 1);
+        f0 = mesh_.face(h0);
+        f1 = mesh_.face(h1);
+        if (f0.is_valid() && f1.is_valid())
+        {
+            n0 = (Vec3d) mesh_.compute_face_normal(f0);
+            n1 = (Vec3d) mesh_.compute_face_normal(f1);
+            d  = mesh_.position(mesh_.to_vertex(h0));
+            d -= mesh_.position(mesh_.to_vertex(h1));
+            l  = norm(d);
+            d /= l;
+            l *= 0.5; // only consider half of the edge (matchig Voronoi area)
+            w  = l * atan2(dot(cross(n0,n1), d), dot(n0,n1));
+            t.xx = w*d[0]*d[0];  t.xy = w*d[0]*d[1];  t.xz = w*d[0]*d[2];
+            t.yy = w*d[1]*d[1];  t.yz = w*d[1]*d[2];  t.zz = w*d[2]*d[2];
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void Curvature_analyzer::compute_curvatures(const std::vector<Surface_mesh::Vertex>& vertices)
+{
+    const int n = vertices.size();
+
 
-    // Voronoi area per vertex
     // Laplace per vertex
     // angle sum per vertex
     // -> mean, Gauss -> min, max curvature
-    for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
     {
+        const Surface_mesh::Vertex v = vertices[i];
+
+        Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+        Scalar  kmin, kmax, mean, gauss;
+        Scalar  area, sum_angles;
+        Scalar  weight, sum_weights;
+        Point   p0, p1, p2, laplace;
+
         kmin = kmax = 0.0;
 
-        if (!mesh_.is_isolated(*vit) && !mesh_.is_boundary(*vit))
+        if (!mesh_.is_isolated(v) && !mesh_.is_boundary(v))
         {
             laplace     = 0.0;
             sum_weights = 0.0;
             sum_angles  = 0.0;
-            p0 = mesh_.position(*vit);
+            p0 = mesh_.position(v);
 
             // Voronoi area
-            area = voronoi_area(mesh_, *vit);
+            area = cache_.voronoi_area(v);
 
             // Laplace & angle sum
-            vhit = vhend = mesh_.halfedges(*vit);
+            vhit = vhend = mesh_.halfedges(v);
             do
             {
                 p1 = mesh_.position(mesh_.to_vertex(*vhit));
                 p2 = mesh_.position(mesh_.to_vertex(mesh_.ccw_rotated_halfedge(*vhit)));
 
-                weight       = cotan[mesh_.edge(*vhit)];
+                weight       = cache_.cotan(mesh_.edge(*vhit));
                 sum_weights += weight;
                 laplace     += weight * p1;
 
@@ -91,7 +322,7 @@ void Curvature_analyzer::analyze(unsigned int smoothing_steps)
                 sum_angles += acos( clamp_cos( dot(p1, p2) ) );
             }
             while (++vhit != vhend);
-            laplace -= sum_weights * mesh_.position(*vit);
+            laplace -= sum_weights * mesh_.position(v);
             laplace /= Scalar(2.0) * area;
 
             mean = Scalar(0.5) * norm(laplace);
@@ -102,302 +333,287 @@ void Curvature_analyzer::analyze(unsigned int smoothing_steps)
             kmax = mean + s;
         }
 
-        min_curvature_[*vit] = kmin;
-        max_curvature_[*vit] = kmax;
+        raw_min_curvature_[v] = kmin;
+        raw_max_curvature_[v] = kmax;
     }
 
 
-
     // boundary vertices: interpolate from interior neighbors
-    for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
     {
-        if (mesh_.is_boundary(*vit))
-        {
-            kmin = kmax = sum_weights = 0.0;
+        const Surface_mesh::Vertex v = vertices[i];
+        if (!mesh_.is_boundary(v)) continue;
 
-            vhit = vhend = mesh_.halfedges(*vit);
-            if (vhit) do
-                      {
-                          v = mesh_.to_vertex(*vhit);
-                          if (!mesh_.is_boundary(v))
-                          {
-                              weight = cotan[mesh_.edge(*vhit)];
-                              sum_weights += weight;
-                              kmin += weight * min_curvature_[v];
-                              kmax += weight * max_curvature_[v];
-                          }
-                      }
-                while (++vhit != vhend);
+        Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+        Surface_mesh::Vertex vv;
+        Scalar  kmin, kmax;
+        Scalar  weight, sum_weights;
 
-            if (sum_weights)
+        kmin = kmax = sum_weights = 0.0;
+
+        vhit = vhend = mesh_.halfedges(v);
+        if (vhit) do
+        {
+            vv = mesh_.to_vertex(*vhit);
+            if (!mesh_.is_boundary(vv))
             {
-                kmin /= sum_weights;
-                kmax /= sum_weights;
+                weight = cache_.cotan(mesh_.edge(*vhit));
+                sum_weights += weight;
+                kmin += weight * raw_min_curvature_[vv];
+                kmax += weight * raw_max_curvature_[vv];
             }
-
-            min_curvature_[*vit] = kmin;
-            max_curvature_[*vit] = kmax;
         }
-    }
-
-
-    // clean-up properties
-    mesh_.remove_edge_property(cotan);
+        while (++vhit != vhend);
 
+        if (sum_weights)
+        {
+            kmin /= sum_weights;
+            kmax /= sum_weights;
+        }
 
-    // smooth curvature values
-    smooth_curvatures(smoothing_steps);
+        raw_min_curvature_[v] = kmin;
+        raw_max_curvature_[v] = kmax;
+    }
 }
 
 
 //-----------------------------------------------------------------------------
 
 
-void Curvature_analyzer::analyze_tensor(unsigned int smoothing_steps,
-                                        bool two_ring_neighborhood)
+void Curvature_analyzer::compute_tensor_curvatures(const std::vector<Surface_mesh::Vertex>& vertices)
 {
-    Surface_mesh::Vertex_property<double> area   = mesh_.add_vertex_property<double>("curv:area", 0.0);
-    Surface_mesh::Face_property<Vec3d>    normal = mesh_.add_face_property<Vec3d>("curv:normal");
-    Surface_mesh::Edge_property<Vec3d>    evec   = mesh_.add_edge_property<Vec3d>("curv:evec", Vec3d(0,0,0));
-    Surface_mesh::Edge_property<double>   angle  = mesh_.add_edge_property<double>("curv:angle", 0.0);
-
-    Surface_mesh::Vertex_iterator vit, vend=mesh_.vertices_end();
-    Surface_mesh::Edge_iterator   eit, eend=mesh_.edges_end();
-    Surface_mesh::Face_iterator   fit, fend=mesh_.faces_end();
-
-    Surface_mesh::Vertex_around_vertex_circulator    vvit, vvend;
-    Surface_mesh::Vertex_around_face_circulator      vfit;
-    Surface_mesh::Halfedge_around_vertex_circulator  hvit, hvend;
-
-    Surface_mesh::Vertex    v;
-    Surface_mesh::Halfedge  h0, h1;
-    Surface_mesh::Edge      ee;
-    Surface_mesh::Face      f0, f1;
-    Vec3d                   p0, p1, n0, n1, e;
-    double                  l, A, beta, a1, a2, a3;
-    Mat3d                   tensor;
-
-    double  eval1, eval2, eval3, kmin, kmax;
-    Vec3d   evec1, evec2, evec3;
-
-    std::vector<Surface_mesh::Vertex>  neighborhood;
-    std::vector<Surface_mesh::Vertex>::const_iterator nit, nend;
-    neighborhood.reserve(15);
-
-
+    const int n = vertices.size();
 
-    // precompute Voronoi area per vertex
-    for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+#pragma omp parallel
     {
-        area[*vit] = voronoi_area(mesh_, *vit);
-    }
-
+        Surface_mesh::Vertex_around_vertex_circulator    vvit, vvend;
+        Surface_mesh::Halfedge_around_vertex_circulator  hvit, hvend;
 
-    // precompute face normals
-    for (fit=mesh_.faces_begin(); fit!=fend; ++fit)
-    {
-        normal[*fit] = (Vec3d) mesh_.compute_face_normal(*fit);
-    }
+        double       A, a1, a2, a3, kmin, kmax;
+        double       eval1, eval2, eval3;
+        Vec3d        evec1, evec2, evec3, dmin, dmax;
+        Edge_tensor  sum;
+        Mat3d        tensor;
 
+        // neighborhood buffer of this thread
+        std::vector<Surface_mesh::Vertex>  neighborhood;
+        neighborhood.reserve(15);
 
-    // precompute dihedral_angle*edge_length*edge per edge
-    for (eit=mesh_.edges_begin(); eit!=eend; ++eit)
-    {
-        h0 = mesh_.halfedge(*eit, 0);
-        h1 = mesh_.halfedge(*eit, 1);
-        f0 = mesh_.face(h0);
-        f1 = mesh_.face(h1);
-        if (f0.is_valid() && f1.is_valid())
+#pragma omp for
+        for (int i=0; i<n; ++i)
         {
-            n0 = normal[f0];
-            n1 = normal[f1];
-            e  = mesh_.position(mesh_.to_vertex(h0));
-            e -= mesh_.position(mesh_.to_vertex(h1));
-            l  = norm(e);
-            e /= l;
-            l *= 0.5; // only consider half of the edge (matchig Voronoi area)
-            angle[*eit] = atan2(dot(cross(n0,n1), e), dot(n0,n1));
-            evec[*eit]  = sqrt(l) * e;
-        }
-    }
-
+            const Surface_mesh::Vertex v = vertices[i];
 
-    // compute curvature tensor for each vertex
-    for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
-    {
-        kmin = 0.0;
-        kmax = 0.0;
+            kmin = 0.0;
+            kmax = 0.0;
+            dmin = dmax = Vec3d(0,0,0);
 
 
-        if (!mesh_.is_isolated(*vit))
-        {
-            // one-ring or two-ring neighborhood?
-            neighborhood.clear();
-            neighborhood.push_back(*vit);
-            if (two_ring_neighborhood)
+            if (!mesh_.is_isolated(v))
             {
-                vvit = vvend = mesh_.vertices(*vit);
-                do
+                // one-ring or two-ring neighborhood?
+                neighborhood.clear();
+                neighborhood.push_back(v);
+                if (two_ring_)
                 {
-                    neighborhood.push_back(*vvit);
+                    vvit = vvend = mesh_.vertices(v);
+                    do
+                    {
+                        neighborhood.push_back(*vvit);
+                    }
+                    while (++vvit != vvend);
                 }
-                while (++vvit != vvend);
-            }
 
 
-            A = 0.0;
-            tensor = Mat3d::zero();
+                A = 0.0;
+                sum.xx = sum.xy = sum.xz = sum.yy = sum.yz = sum.zz = 0.0;
 
 
-            // compute tensor over vertex neighborhood stored in vertices
-            for (nit=neighborhood.begin(), nend=neighborhood.end(); nit!=nend; ++nit)
-            {
-                // accumulate tensor from dihedral angles around vertices
-                hvit = hvend = mesh_.halfedges(*nit);
-                do
+                // compute tensor over vertex neighborhood stored in vertices
+                for (unsigned int j=0; j<neighborhood.size(); ++j)
                 {
-                    ee = mesh_.edge(*hvit);
-                    e = evec[ee];
-                    beta = angle[ee];
-                    for (int i=0; i<3; ++i)
-                        for (int j=0; j<3; ++j)
-                            tensor(i,j) += beta * e[i]*e[j];
-                }
-                while (++hvit != hvend);
+                    // accumulate tensor from dihedral angles around vertices
+                    hvit = hvend = mesh_.halfedges(neighborhood[j]);
+                    do
+                    {
+                        const Edge_tensor& t = edge_tensor_[mesh_.edge(*hvit)];
+                        sum.xx += t.xx;  sum.xy += t.xy;  sum.xz += t.xz;
+                        sum.yy += t.yy;  sum.yz += t.yz;  sum.zz += t.zz;
+                    }
+                    while (++hvit != hvend);
 
-                // accumulate area
-                A += area[*nit];
-            }
+                    // accumulate area
+                    A += cache_.voronoi_area(neighborhood[j]);
+                }
 
-            // normalize tensor by accumulated
-            tensor /= A;
+                // normalize tensor by accumulated
+                tensor(0,0) = sum.xx / A;
+                tensor(1,1) = sum.yy / A;
+                tensor(2,2) = sum.zz / A;
+                tensor(0,1) = tensor(1,0) = sum.xy / A;
+                tensor(0,2) = tensor(2,0) = sum.xz / A;
+                tensor(1,2) = tensor(2,1) = sum.yz / A;
 
 
-            // Eigen-decomposition
-            bool ok = symmetric_eigendecomposition(tensor, eval1, eval2, eval3, evec1, evec2, evec3);
-            if (ok)
-            {
-                // curvature values:
-                //   normal vector -> eval with smallest absolute value
-                //   evals are sorted in decreasing order
-                a1 = fabs(eval1);
-                a2 = fabs(eval2);
-                a3 = fabs(eval3);
-                if (a1 < a2)
-                {
-                    if (a1 < a3)
-                    {
-                        // e1 is normal
-                        kmax = eval2;
-                        kmin = eval3;
-                    }
-                    else
-                    {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
-                    }
-                }
-                else
+                // Eigen-decomposition
+                bool ok = symmetric_eigendecomposition_closed_form(tensor, eval1, eval2, eval3, evec1, evec2, evec3);
+                if (ok)
                 {
-                    if (a2 < a3)
+                    // curvature values:
+                    //   normal vector -> eval with smallest absolute value
+                    //   evals are sorted in decreasing order
+                    // directions: the eigenvector of kmax is the direction of
+                    // minimum curvature and vice versa
+                    a1 = fabs(eval1);
+                    a2 = fabs(eval2);
+                    a3 = fabs(eval3);
+                    if (a1 < a2)
                     {
-                        // e2 is normal
-                        kmax = eval1;
-                        kmin = eval3;
+                        if (a1 < a3)
+                        {
+                            // e1 is normal
+                            kmax = eval2;
+                            kmin = eval3;
+                            dmin = evec2;
+                            dmax = evec3;
+                        }
+                        else
+                        {
+                            // e3 is normal
+                            kmax = eval1;
+                            kmin = eval2;
+                            dmin = evec1;
+                            dmax = evec2;
+                        }
                     }
                     else
                     {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
+                        if (a2 < a3)
+                        {
+                            // e2 is normal
+                            kmax = eval1;
+                            kmin = eval3;
+                            dmin = evec1;
+                            dmax = evec3;
+                        }
+                        else
+                        {
+                            // e3 is normal
+                            kmax = eval1;
+                            kmin = eval2;
+                            dmin = evec1;
+                            dmax = evec2;
+                        }
                     }
                 }
             }
-        }
-		           
-        assert(kmin <= kmax);
 
-        min_curvature_[*vit] = kmin;
-        max_curvature_[*vit] = kmax;
-    }
+            assert(kmin <= kmax);
 
-
-    // clean-up properties
-    mesh_.remove_vertex_property(area);
-    mesh_.remove_edge_property(evec);
-    mesh_.remove_edge_property(angle);
-    mesh_.remove_face_property(normal);
-
-
-    // smooth curvature values
-    smooth_curvatures(smoothing_steps);
+            raw_min_curvature_[v] = kmin;
+            raw_max_curvature_[v] = kmax;
+            min_direction_[v] = Direction(dmin);
+            max_direction_[v] = Direction(dmax);
+        }
+    }
 }
 
 
 //-----------------------------------------------------------------------------
 
 
-void Curvature_analyzer::smooth_curvatures(unsigned int _iterations)
+void Curvature_analyzer::smooth_curvatures(const std::vector<Surface_mesh::Vertex>& vertices,
+                                           const std::vector<Surface_mesh::Vertex>& inner)
 {
-    Surface_mesh::Vertex_iterator  vit, vend=mesh_.vertices_end();
-    Surface_mesh::Edge_iterator    eit, eend=mesh_.edges_end();
-    Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
-
-    Surface_mesh::Vertex v;
-    Scalar  kmin, kmax;
-    Scalar  weight, sum_weights;
+    const int n = vertices.size();
 
 
-    // properties
-    Surface_mesh::Vertex_property<bool> vfeature = mesh_.get_vertex_property<bool>("v:feature");
-    Surface_mesh::Edge_property<double>  cotan = mesh_.add_edge_property<double>("curv:cotan");
+    // outer vertices keep their current values
+    std::vector<Surface_mesh::Vertex> outer;
+    std::set_difference(vertices.begin(), vertices.end(),
+                        inner.begin(), inner.end(),
+                        std::back_inserter(outer));
+    std::vector<Scalar> outer_min(outer.size()), outer_max(outer.size());
+    for (unsigned int i=0; i<outer.size(); ++i)
+    {
+        outer_min[i] = min_curvature_[outer[i]];
+        outer_max[i] = max_curvature_[outer[i]];
+    }
 
 
-    // cotan weight per edge
-    for (eit=mesh_.edges_begin(); eit!=eend; ++eit)
+    // start from unsmoothed values
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
     {
-        cotan[*eit] = cotan_weight(mesh_, *eit);
+        min_curvature_[vertices[i]] = raw_min_curvature_[vertices[i]];
+        max_curvature_[vertices[i]] = raw_max_curvature_[vertices[i]];
     }
 
 
-    for (unsigned int i=0; i<_iterations; ++i)
+    // Jacobi iterations: each vertex only depends on its neighborhood, as
+    // needed for update(), and vertices can be smoothed in parallel
+    Surface_mesh::Vertex_property<bool> vfeature = mesh_.get_vertex_property<bool>("v:feature");
+    std::vector<Scalar> new_min(n), new_max(n);
+
+    for (unsigned int iter=0; iter<smoothing_steps_; ++iter)
     {
-        for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+#pragma omp parallel for
+        for (int i=0; i<n; ++i)
         {
+            const Surface_mesh::Vertex v = vertices[i];
+
+            Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+            Surface_mesh::Vertex vv;
+            Scalar  kmin, kmax;
+            Scalar  weight, sum_weights;
+
+            new_min[i] = min_curvature_[v];
+            new_max[i] = max_curvature_[v];
+
             // don't smooth feature vertices
-            if (vfeature && vfeature[*vit])
+            if (vfeature && vfeature[v])
                 continue;
 
             kmin = kmax = sum_weights = 0.0;
 
-            vhit = vhend = mesh_.halfedges(*vit);
+            vhit = vhend = mesh_.halfedges(v);
             if (vhit) do
-                      {
-                          v = mesh_.to_vertex(*vhit);
+            {
+                vv = mesh_.to_vertex(*vhit);
 
-                          // don't consider feature vertices (high curvature)
-                          if (vfeature && vfeature[v])
-                              continue;
+                // don't consider feature vertices (high curvature)
+                if (vfeature && vfeature[vv])
+                    continue;
 
-                          weight = std::max(0.0, cotan_weight(mesh_, mesh_.edge(*vhit)));
-                          sum_weights += weight;
-                          kmin += weight * min_curvature_[v];
-                          kmax += weight * max_curvature_[v];
-                      }
-                while (++vhit != vhend);
+                weight = std::max(0.0, cache_.cotan(mesh_.edge(*vhit)));
+                sum_weights += weight;
+                kmin += weight * min_curvature_[vv];
+                kmax += weight * max_curvature_[vv];
+            }
+            while (++vhit != vhend);
 
             if (sum_weights)
             {
-                min_curvature_[*vit] = kmin / sum_weights;
-                max_curvature_[*vit] = kmax / sum_weights;
+                new_min[i] = kmin / sum_weights;
+                new_max[i] = kmax / sum_weights;
             }
         }
+
+#pragma omp parallel for
+        for (int i=0; i<n; ++i)
+        {
+            min_curvature_[vertices[i]] = new_min[i];
+            max_curvature_[vertices[i]] = new_max[i];
+        }
     }
 
 
-    // remove property
-    mesh_.remove_edge_property(cotan);
+    for (unsigned int i=0; i<outer.size(); ++i)
+    {
+        min_curvature_[outer[i]] = outer_min[i];
+        max_curvature_[outer[i]] = outer_max[i];
+    }
 }
 
 
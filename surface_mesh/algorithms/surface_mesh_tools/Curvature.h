@@ -8,6 +8,8 @@
 
 #include <graphene/surface_mesh/data_structure/Surface_mesh.h>
 #include <graphene/surface_mesh/algorithms/surface_mesh_tools/diffgeo.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Geometry_cache.h>
+#include <vector>
 
 
 //== NAMESPACES ===============================================================
@@ -21,7 +23,9 @@ namespace surface_mesh {
 
 /** Compute per-vertex curvature (min,max,mean,Gaussian).
     Curvature values for boundary vertices are interpolated from their interior
-    neighbors. Curvature values can be smoothed */
+    neighbors. Curvature values can be smoothed.
+    After local edits the curvature can be updated incrementally: mark the
+    modified vertices with mark_dirty() and call update(). */
 class Curvature_analyzer
 {
 public:
@@ -41,6 +45,19 @@ public:
     void analyze_tensor(unsigned int post_smoothing_steps=0,
                         bool two_ring_neighborhood=false);
 
+    /** mark v as modified: moved, or part of a local topology change. After
+        an edge split mark the new vertex, after a collapse the remaining
+        vertex, after a flip the four vertices of the two faces. Garbage
+        collection invalidates the marked vertices, update() before. */
+    void mark_dirty(Surface_mesh::Vertex v) { dirty_.push_back(v); cache_.mark_dirty(v); }
+
+    /** recompute areas, edge weights and curvature around the vertices
+        marked dirty, with the method and parameters of the last analyze()
+        or analyze_tensor(). Gives the same result as a full analysis at
+        a cost proportional to the size of the edit. Analyzes everything
+        again if Surface_mesh::revision() changed in the meantime. */
+    void update();
+
     /// return mean curvature
     Scalar mean_curvature(Surface_mesh::Vertex v) const
     {
@@ -71,11 +88,45 @@ public:
         return std::max(fabs(min_curvature_[v]), fabs(max_curvature_[v]));
     }
 
+    /// return direction of minimum curvature, only set by analyze_tensor()
+    Direction min_direction(Surface_mesh::Vertex v) const
+    {
+        return min_direction_[v];
+    }
+
+    /// return direction of maximum curvature, only set by analyze_tensor()
+    Direction max_direction(Surface_mesh::Vertex v) const
+    {
+        return max_direction_[v];
+    }
+
 
 private:
 
-    /// smooth curvature values
-    void smooth_curvatures(unsigned int _iterations);
+    /// upper triangle of the symmetric 3x3 contribution of an edge to the tensor
+    struct Edge_tensor
+    {
+        double xx, xy, xz, yy, yz, zz;
+    };
+
+    /// analyze all vertices with the current method
+    void analyze_all();
+
+    /// tensor contribution of the edges
+    void compute_edge_tensors(const std::vector<Surface_mesh::Edge>& edges);
+
+    /// unsmoothed curvature of the vertices
+    void compute_curvatures(const std::vector<Surface_mesh::Vertex>& vertices);
+    void compute_tensor_curvatures(const std::vector<Surface_mesh::Vertex>& vertices);
+
+    /// smooth curvature values over vertices, starting from the unsmoothed
+    /// ones. only the inner vertices are changed, the others are too close
+    /// to the vertices that are not smoothed.
+    void smooth_curvatures(const std::vector<Surface_mesh::Vertex>& vertices,
+                           const std::vector<Surface_mesh::Vertex>& inner);
+
+    /// add the n-ring neighborhood, sorts and removes duplicates
+    void grow(std::vector<Surface_mesh::Vertex>& vertices, unsigned int n) const;
 
 
 private:
@@ -83,6 +134,25 @@ private:
     Surface_mesh& mesh_;
     Surface_mesh::Vertex_property<Scalar> min_curvature_;
     Surface_mesh::Vertex_property<Scalar> max_curvature_;
+    Surface_mesh::Vertex_property<Direction> min_direction_;
+    Surface_mesh::Vertex_property<Direction> max_direction_;
+
+    // Voronoi areas and cotan weights
+    Geometry_cache cache_;
+
+    // kept for update()
+    Surface_mesh::Vertex_property<Scalar>       raw_min_curvature_;
+    Surface_mesh::Vertex_property<Scalar>       raw_max_curvature_;
+    Surface_mesh::Edge_property<Edge_tensor>    edge_tensor_;
+
+    // parameters of the last analysis
+    bool          analyzed_;
+    bool          tensor_;
+    bool          two_ring_;
+    unsigned int  smoothing_steps_;
+    unsigned int  revision_;
+
+    std::vector<Surface_mesh::Vertex> dirty_;
 };
 
 
@@ -0,0 +1,211 @@
+//== INCLUDES =================================================================
+
+#include "Geodesics.h"
+
+#include <cfloat>
+#include <queue>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+Geodesics::
+Geodesics(const Surface_mesh& mesh)
+    : mesh_(mesh)
+{
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics::
+compute(const std::vector<Surface_mesh::Vertex>& sources,
+        std::vector<Scalar>& distance,
+        Scalar max_distance) const
+{
+    std::vector<Surface_mesh::Vertex> order;
+    march(sources, max_distance, distance, order);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics::
+compute(const std::vector< std::vector<Surface_mesh::Vertex> >& sources,
+        std::vector< std::vector<Scalar> >& distances,
+        Scalar max_distance) const
+{
+    const int n = sources.size();
+    distances.resize(n);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<n; ++i)
+    {
+        std::vector<Surface_mesh::Vertex> order;
+        march(sources[i], max_distance, distances[i], order);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics::
+ball(const std::vector<Surface_mesh::Vertex>& sources,
+     Scalar radius,
+     std::vector<Surface_mesh::Vertex>& vertices) const
+{
+    std::vector<Scalar> distance;
+    vertices.clear();
+    march(sources, radius, distance, vertices);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics::
+march(const std::vector<Surface_mesh::Vertex>& sources,
+      Scalar max_distance,
+      std::vector<Scalar>& distance,
+      std::vector<Surface_mesh::Vertex>& order) const
+{
+    const Scalar limit = (max_distance > 0.0) ? max_distance : FLT_MAX;
+
+    distance.assign(mesh_.vertices_size(), FLT_MAX);
+    std::vector<bool> frozen(mesh_.vertices_size(), false);
+    std::vector<Surface_mesh::Vertex> touched;
+    std::priority_queue<Front_entry> front;
+
+    for (unsigned int i=0; i<sources.size(); ++i)
+    {
+        Surface_mesh::Vertex v = sources[i];
+        if (!v.is_valid() || mesh_.is_deleted(v) || distance[v.idx()] == 0.0) continue;
+
+        distance[v.idx()] = 0.0;
+        touched.push_back(v);
+        front.push(Front_entry(0.0, v));
+    }
+
+
+    Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+
+    while (!front.empty())
+    {
+        const Front_entry entry = front.top();
+        front.pop();
+
+        const Surface_mesh::Vertex v = entry.vertex;
+        if (frozen[v.idx()] || entry.distance > distance[v.idx()]) continue;
+        if (entry.distance > limit) break;
+
+        frozen[v.idx()] = true;
+        order.push_back(v);
+
+        const Scalar dv = distance[v.idx()];
+
+        vhit = vhend = mesh_.halfedges(v);
+        if (!vhit) continue;
+        do
+        {
+            const Surface_mesh::Vertex x = mesh_.to_vertex(*vhit);
+
+            // along the edge (v,x)
+            Scalar dx = dv + norm(mesh_.position(x) - mesh_.position(v));
+
+            // through the triangles (v,x,y) and (v,y,x) whose other vertex y
+            // is frozen already
+            Surface_mesh::Halfedge h = *vhit;
+            if (mesh_.face(h).is_valid())
+            {
+                Surface_mesh::Vertex y = mesh_.to_vertex(mesh_.next_halfedge(h));
+                if (frozen[y.idx()])
+                    dx = std::min(dx, update(v, dv, y, distance[y.idx()], x));
+            }
+            h = mesh_.opposite_halfedge(h);
+            if (mesh_.face(h).is_valid())
+            {
+                Surface_mesh::Vertex y = mesh_.to_vertex(mesh_.next_halfedge(h));
+                if (frozen[y.idx()])
+                    dx = std::min(dx, update(v, dv, y, distance[y.idx()], x));
+            }
+
+            if (!frozen[x.idx()] && dx < distance[x.idx()])
+            {
+                if (distance[x.idx()] == FLT_MAX)
+                    touched.push_back(x);
+                distance[x.idx()] = dx;
+                front.push(Front_entry(dx, x));
+            }
+        }
+        while (++vhit != vhend);
+    }
+
+
+    // tentative distances beyond the limit are not final
+    for (unsigned int i=0; i<touched.size(); ++i)
+    {
+        if (!frozen[touched[i].idx()])
+            distance[touched[i].idx()] = FLT_MAX;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Scalar
+Geodesics::
+update(Surface_mesh::Vertex a, Scalar da,
+       Surface_mesh::Vertex b, Scalar db,
+       Surface_mesh::Vertex c) const
+{
+    const Vec3d pa = (Vec3d) mesh_.position(a);
+    const Vec3d pb = (Vec3d) mesh_.position(b);
+    const Vec3d pc = (Vec3d) mesh_.position(c);
+
+    const double dijkstra = std::min(da + norm(pc-pa), db + norm(pc-pb));
+
+
+    // unfold: a at the origin, b on the positive x-axis, c above
+    const Vec3d  e  = pb - pa;
+    const double l  = norm(e);
+    if (l <= DBL_MIN) return dijkstra;
+
+    const double cx = dot(pc-pa, e) / l;
+    const double cy = norm((pc-pa) - e * (cx/l));
+
+
+    // virtual source below the x-axis at distance da from a and db from b
+    const double sx  = (double(da)*da - double(db)*db + l*l) / (2.0*l);
+    const double sy2 = double(da)*da - sx*sx;
+    if (sy2 < 0.0) return dijkstra;
+    const double sy  = -sqrt(sy2);
+
+
+    // the straight path from the source has to enter through the edge (a,b)
+    if (cy - sy <= DBL_MIN) return dijkstra;
+    const double t = -sy / (cy - sy);
+    const double x = sx + t * (cx - sx);
+    if (x < 0.0 || x > l) return dijkstra;
+
+    return std::min(dijkstra, sqrt((cx-sx)*(cx-sx) + (cy-sy)*(cy-sy)));
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,95 @@
+//=============================================================================
+
+#ifndef GRAPHENE_GEODESICS_H
+#define GRAPHENE_GEODESICS_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Geodesic distances by multi-source fast marching (Kimmel and Sethian
+/// 1998). Vertices are frozen in the order of their distance, taken from a
+/// heap. Triangles are updated by unfolding them into the plane, if the
+/// straight path does not cross the opposite edge the update falls back to
+/// the edges (Dijkstra). Exact for planar meshes, first order otherwise.
+///
+/// Unlike Geodesics_heat there is no precomputation, queries are local if a
+/// maximum distance is given. All queries are const and can run in parallel.
+/// The mesh must not change while the object is in use.
+class Geodesics
+{
+public:
+
+    /// mesh has to be a triangle mesh
+    Geodesics(const Surface_mesh& mesh);
+
+    /// distance of each vertex to the closest source, indexed by vertex
+    /// index. stops at max_distance (0 means unlimited), FLT_MAX for
+    /// vertices farther away or not connected to a source.
+    void compute(const std::vector<Surface_mesh::Vertex>& sources,
+                 std::vector<Scalar>& distance,
+                 Scalar max_distance=0.0) const;
+
+    /// one distance field per source set, computed in parallel
+    void compute(const std::vector< std::vector<Surface_mesh::Vertex> >& sources,
+                 std::vector< std::vector<Scalar> >& distances,
+                 Scalar max_distance=0.0) const;
+
+    /// vertices with distance to the sources of at most radius, sorted by
+    /// distance. only visits the neighborhood of the sources.
+    void ball(const std::vector<Surface_mesh::Vertex>& sources,
+              Scalar radius,
+              std::vector<Surface_mesh::Vertex>& vertices) const;
+
+
+private:
+
+    // march from the sources, append the frozen vertices to order
+    void march(const std::vector<Surface_mesh::Vertex>& sources,
+               Scalar max_distance,
+               std::vector<Scalar>& distance,
+               std::vector<Surface_mesh::Vertex>& order) const;
+
+    // distance of c from the triangle (a,b,c) with known distances at a and b
+    Scalar update(Surface_mesh::Vertex a, Scalar da,
+                  Surface_mesh::Vertex b, Scalar db,
+                  Surface_mesh::Vertex c) const;
+
+
+    // heap entry, outdated if the distance of the vertex decreased meanwhile
+    struct Front_entry
+    {
+        Front_entry(Scalar d, Surface_mesh::Vertex v) : distance(d), vertex(v) {}
+
+        // std::priority_queue pops the largest element: closest first
+        bool operator<(const Front_entry& rhs) const { return distance > rhs.distance; }
+
+        Scalar                distance;
+        Surface_mesh::Vertex  vertex;
+    };
+
+
+private:
+
+    const Surface_mesh&  mesh_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_GEODESICS_H
+//=============================================================================
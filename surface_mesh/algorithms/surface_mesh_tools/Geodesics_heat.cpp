@@ -0,0 +1,223 @@
+//== INCLUDES =================================================================
+
+#include "Geodesics_heat.h"
+#include "Laplace.h"
+#include "diffgeo.h"
+
+#include <cfloat>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+Geodesics_heat::Geodesics_heat(Surface_mesh& mesh, Scalar time_factor)
+    : mesh_(mesh), n_components_(0)
+{
+    const int nv = mesh_.vertices_size();
+
+    fixed_.resize(nv);
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        fixed_[i] = (mesh_.is_deleted(v) || mesh_.is_isolated(v));
+    }
+
+
+    // connected components, the first vertex of each is the anchor of the
+    // Poisson problem (its solution is only defined up to a constant)
+    Surface_mesh::Vertex_around_vertex_circulator vvit, vvend;
+    std::vector<Surface_mesh::Vertex> stack;
+
+    anchor_ = fixed_;
+    component_.assign(nv, -1);
+    for (int i=0; i<nv; ++i)
+    {
+        if (fixed_[i] || component_[i] != -1) continue;
+
+        anchor_[i] = true;
+        component_[i] = n_components_;
+        stack.push_back(Surface_mesh::Vertex(i));
+        while (!stack.empty())
+        {
+            Surface_mesh::Vertex v = stack.back();
+            stack.pop_back();
+
+            vvit = vvend = mesh_.vertices(v);
+            do
+            {
+                if (component_[(*vvit).idx()] == -1)
+                {
+                    component_[(*vvit).idx()] = n_components_;
+                    stack.push_back(*vvit);
+                }
+            }
+            while (++vvit != vvend);
+        }
+
+        ++n_components_;
+    }
+
+
+    Sparse_matrix L;
+    cotan_laplace(mesh, L);
+    mass_matrix(mesh, mass_);
+
+
+    // heat flow: M - t L
+    const Scalar h = mean_edge_length(mesh);
+    Sparse_matrix A = L;
+    A.scale(-time_factor * h * h);
+    A.add_diagonal(mass_);
+    A.constrain(fixed_);
+    heat_solver_.factorize(A);
+
+
+    // Poisson: -L
+    L.scale(-1.0);
+    L.constrain(anchor_);
+    poisson_solver_.factorize(L);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics_heat::
+compute(const std::vector<Surface_mesh::Vertex>& sources,
+        std::vector<Scalar>& distance) const
+{
+    const int nv = mesh_.vertices_size();
+    const int nf = mesh_.faces_size();
+
+
+    // diffuse heat from the sources
+    std::vector<double> b(nv, 0.0), u(nv, 0.0);
+    for (unsigned int i=0; i<sources.size(); ++i)
+    {
+        if (!fixed_[sources[i].idx()])
+            b[sources[i].idx()] = mass_[sources[i].idx()];
+    }
+    heat_solver_.solve(b, u);
+
+
+    // normalized negative gradient per triangle
+    std::vector<Vec3d> X(nf, Vec3d(0,0,0));
+
+#pragma omp parallel for
+    for (int i=0; i<nf; ++i)
+    {
+        Surface_mesh::Face f(i);
+        if (mesh_.is_deleted(f) || mesh_.valence(f) != 3) continue;
+
+        Surface_mesh::Halfedge h0 = mesh_.halfedge(f);
+        Surface_mesh::Halfedge h1 = mesh_.next_halfedge(h0);
+        Surface_mesh::Halfedge h2 = mesh_.next_halfedge(h1);
+
+        const int   i0 = mesh_.to_vertex(h0).idx();
+        const int   i1 = mesh_.to_vertex(h1).idx();
+        const int   i2 = mesh_.to_vertex(h2).idx();
+        const Vec3d p0 = (Vec3d) mesh_.position(mesh_.to_vertex(h0));
+        const Vec3d p1 = (Vec3d) mesh_.position(mesh_.to_vertex(h1));
+        const Vec3d p2 = (Vec3d) mesh_.position(mesh_.to_vertex(h2));
+
+        // grad u = sum_k u_k (n x e_k) / |n|^2, e_k opposite to vertex k
+        const Vec3d  n  = cross(p1-p0, p2-p0);
+        const double nn = sqrnorm(n);
+        if (nn <= DBL_MIN) continue;
+
+        Vec3d g = (u[i0]*cross(n, p2-p1) + u[i1]*cross(n, p0-p2) + u[i2]*cross(n, p1-p0)) / nn;
+        const double l = norm(g);
+        if (l > DBL_MIN)
+            X[i] = g / -l;
+    }
+
+
+    // integrated divergence per vertex
+    std::fill(b.begin(), b.end(), 0.0);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        if (anchor_[i]) continue;
+
+        Surface_mesh::Vertex v(i);
+        Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+        const Vec3d p = (Vec3d) mesh_.position(v);
+        double div = 0.0;
+
+        vhit = vhend = mesh_.halfedges(v);
+        do
+        {
+            Surface_mesh::Face f = mesh_.face(*vhit);
+            if (f.is_valid())
+            {
+                const Vec3d  pj = (Vec3d) mesh_.position(mesh_.to_vertex(*vhit));
+                const Vec3d  pk = (Vec3d) mesh_.position(mesh_.to_vertex(mesh_.next_halfedge(*vhit)));
+                const Vec3d& x  = X[f.idx()];
+
+                // cotangents of the angles at k and j
+                const double cotk = clamp_cot(dot(p-pk, pj-pk) / norm(cross(p-pk, pj-pk)));
+                const double cotj = clamp_cot(dot(p-pj, pk-pj) / norm(cross(p-pj, pk-pj)));
+
+                div += 0.5 * (cotk * dot(pj-p, x) + cotj * dot(pk-p, x));
+            }
+        }
+        while (++vhit != vhend);
+
+        // -L phi = -div
+        b[i] = -div;
+    }
+
+
+    // recover distance, zero at the closest source of each component
+    std::vector<double> phi(nv, 0.0);
+    poisson_solver_.solve(b, phi);
+
+    std::vector<double> offset(n_components_, DBL_MAX);
+    for (unsigned int i=0; i<sources.size(); ++i)
+    {
+        const int c = component_[sources[i].idx()];
+        if (c != -1 && phi[sources[i].idx()] < offset[c])
+            offset[c] = phi[sources[i].idx()];
+    }
+
+    distance.resize(nv);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        const int c = component_[i];
+        distance[i] = (c == -1 || offset[c] == DBL_MAX) ? FLT_MAX : std::max(0.0, phi[i] - offset[c]);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geodesics_heat::
+compute(const std::vector< std::vector<Surface_mesh::Vertex> >& sources,
+        std::vector< std::vector<Scalar> >& distances) const
+{
+    const int n = sources.size();
+    distances.resize(n);
+
+    // the loops inside compute() are not nested into this one
+#pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<n; ++i)
+        compute(sources[i], distances[i]);
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
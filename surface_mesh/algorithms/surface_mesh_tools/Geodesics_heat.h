@@ -0,0 +1,67 @@
+//=============================================================================
+
+#ifndef GRAPHENE_GEODESICS_HEAT_H
+#define GRAPHENE_GEODESICS_HEAT_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Sparse_matrix.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Geodesic distances on triangle meshes by the heat method (Crane et al.
+/// 2013): diffuse heat from the sources for a short time, normalize its
+/// gradient and recover the distance by a Poisson solve. Both systems only
+/// depend on the mesh, they are assembled and factorized by the constructor
+/// and reused by all compute() calls. The mesh must not change meanwhile.
+class Geodesics_heat
+{
+public:
+
+    /// precompute for mesh, the diffusion time is time_factor times the
+    /// squared mean edge length
+    Geodesics_heat(Surface_mesh& mesh, Scalar time_factor=1.0);
+
+    /// approximate distance of each vertex to the closest source, indexed by
+    /// vertex index. FLT_MAX for vertices not connected to a source.
+    /// const, several queries can run in parallel.
+    void compute(const std::vector<Surface_mesh::Vertex>& sources,
+                 std::vector<Scalar>& distance) const;
+
+    /// one distance field per source set, the queries run in parallel and
+    /// share the factorizations
+    void compute(const std::vector< std::vector<Surface_mesh::Vertex> >& sources,
+                 std::vector< std::vector<Scalar> >& distances) const;
+
+
+private:
+
+    const Surface_mesh&  mesh_;
+
+    Sparse_cholesky      heat_solver_;     // M - t L
+    Sparse_cholesky      poisson_solver_;  // -L, one vertex per component fixed
+    std::vector<double>  mass_;
+    std::vector<bool>    fixed_;           // deleted and isolated vertices
+    std::vector<bool>    anchor_;          // fixed_ and one vertex per component
+    std::vector<int>     component_;       // connected component per vertex
+    int                  n_components_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_GEODESICS_HEAT_H
+//=============================================================================
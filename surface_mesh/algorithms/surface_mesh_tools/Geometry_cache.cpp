@@ -0,0 +1,223 @@
+//== INCLUDES =================================================================
+
+#include "Geometry_cache.h"
+#include "diffgeo.h"
+
+#include <algorithm>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+namespace {
+
+// name of the revision stamp of the cached properties
+const std::string stamp_name("geometry cache");
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Geometry_cache::
+Geometry_cache(Surface_mesh& mesh)
+    : mesh_(mesh)
+{
+    cotan_       = mesh_.edge_property<double>("e:geometry cotan");
+    length_      = mesh_.edge_property<Scalar>("e:geometry length");
+    face_area_   = mesh_.face_property<Scalar>("f:geometry area");
+    vertex_area_ = mesh_.vertex_property<double>("v:geometry area");
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Geometry_cache::
+is_current() const
+{
+    return mesh_.is_cache_current(stamp_name);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geometry_cache::
+stamp()
+{
+    mesh_.stamp_cache(stamp_name);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geometry_cache::
+update()
+{
+    std::vector<Surface_mesh::Vertex> vertices;
+    std::vector<Surface_mesh::Edge>   edges;
+    std::vector<Surface_mesh::Face>   faces;
+
+
+    // outdated: everything
+    if (!is_current())
+    {
+        dirty_.clear();
+
+        vertices.reserve(mesh_.n_vertices());
+        edges.reserve(mesh_.n_edges());
+        faces.reserve(mesh_.n_faces());
+
+        Surface_mesh::Vertex_iterator vit, vend=mesh_.vertices_end();
+        for (vit=mesh_.vertices_begin(); vit!=vend; ++vit)
+            vertices.push_back(*vit);
+
+        Surface_mesh::Edge_iterator eit, eend=mesh_.edges_end();
+        for (eit=mesh_.edges_begin(); eit!=eend; ++eit)
+            edges.push_back(*eit);
+
+        Surface_mesh::Face_iterator fit, fend=mesh_.faces_end();
+        for (fit=mesh_.faces_begin(); fit!=fend; ++fit)
+            faces.push_back(*fit);
+
+        compute(vertices, edges, faces);
+        stamp();
+        return;
+    }
+
+
+    if (dirty_.empty())
+        return;
+
+
+    // the faces around dirty vertices changed, and with them their edges
+    // and the areas of their vertices
+    Surface_mesh::Face_around_vertex_circulator    fvit, fvend;
+    Surface_mesh::Halfedge_around_face_circulator  hfit, hfend;
+    Surface_mesh::Halfedge_around_vertex_circulator hvit, hvend;
+
+    for (unsigned int i=0; i<dirty_.size(); ++i)
+    {
+        const Surface_mesh::Vertex v = dirty_[i];
+        if (mesh_.is_deleted(v)) continue;
+
+        vertices.push_back(v);
+
+        hvit = hvend = mesh_.halfedges(v);
+        if (hvit) do
+        {
+            edges.push_back(mesh_.edge(*hvit));
+            vertices.push_back(mesh_.to_vertex(*hvit));
+        }
+        while (++hvit != hvend);
+
+        fvit = fvend = mesh_.faces(v);
+        if (fvit) do
+        {
+            faces.push_back(*fvit);
+
+            hfit = hfend = mesh_.halfedges(*fvit);
+            do
+            {
+                edges.push_back(mesh_.edge(*hfit));
+                vertices.push_back(mesh_.to_vertex(*hfit));
+            }
+            while (++hfit != hfend);
+        }
+        while (++fvit != fvend);
+    }
+    dirty_.clear();
+
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+
+    compute(vertices, edges, faces);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geometry_cache::
+geometry_changed()
+{
+    update();
+    mesh_.geometry_changed();
+    stamp();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geometry_cache::
+clear()
+{
+    mesh_.remove_cache_stamp(stamp_name);
+    mesh_.remove_edge_property(cotan_);
+    mesh_.remove_edge_property(length_);
+    mesh_.remove_face_property(face_area_);
+    mesh_.remove_vertex_property(vertex_area_);
+    dirty_.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Geometry_cache::
+compute(const std::vector<Surface_mesh::Vertex>& vertices,
+        const std::vector<Surface_mesh::Edge>&   edges,
+        const std::vector<Surface_mesh::Face>&   faces)
+{
+    const int nv = vertices.size();
+    const int ne = edges.size();
+    const int nf = faces.size();
+
+#pragma omp parallel
+    {
+#pragma omp for nowait
+        for (int i=0; i<ne; ++i)
+        {
+            cotan_[edges[i]]  = cotan_weight(mesh_, edges[i]);
+            length_[edges[i]] = mesh_.edge_length(edges[i]);
+        }
+
+#pragma omp for nowait
+        for (int i=0; i<nf; ++i)
+        {
+            face_area_[faces[i]] = (mesh_.valence(faces[i]) == 3) ? triangle_area(mesh_, faces[i]) : 0.0;
+        }
+
+#pragma omp for
+        for (int i=0; i<nv; ++i)
+        {
+            vertex_area_[vertices[i]] = surface_mesh::voronoi_area(mesh_, vertices[i]);
+        }
+    }
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
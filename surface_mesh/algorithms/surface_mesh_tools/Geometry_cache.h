@@ -0,0 +1,107 @@
+//=============================================================================
+
+#ifndef GRAPHENE_GEOMETRY_CACHE_H
+#define GRAPHENE_GEOMETRY_CACHE_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Per-element geometry shared by the algorithms: cotan weights and lengths
+/// of edges, areas of triangles and (mixed) Voronoi areas of vertices. They
+/// are stored on the mesh as properties "e:geometry cotan", "e:geometry
+/// length", "f:geometry area" and "v:geometry area", computed in one
+/// parallel pass and stamped with Surface_mesh::revision() through
+/// Surface_mesh::stamp_cache(). Every Geometry_cache of the same mesh
+/// revision reuses them. After local edits through the low-level operations
+/// of Surface_mesh, which leave the revision as it is, mark the modified
+/// vertices: update() then only recomputes the elements around them.
+class Geometry_cache
+{
+public:
+
+    /// construct with mesh, call update() before reading
+    Geometry_cache(Surface_mesh& mesh);
+
+    /// recompute everything if the cache is missing or from another
+    /// revision, otherwise only the elements around the dirty vertices
+    void update();
+
+    /// mark v as modified: moved, or part of a local topology change. After
+    /// an edge split mark the new vertex, after a collapse the remaining
+    /// vertex, after a flip the four vertices of the two faces.
+    void mark_dirty(Surface_mesh::Vertex v) { dirty_.push_back(v); }
+
+    /// update() and increase the mesh revision: cached data of other
+    /// algorithms (e.g. Sizing_field) becomes outdated, this cache stays valid
+    void geometry_changed();
+
+    /// remove the cached properties from the mesh
+    void clear();
+
+
+    /// cotan weight cot(a)+cot(b) of e, see cotan_weight()
+    double cotan(Surface_mesh::Edge e) const { return cotan_[e]; }
+
+    /// length of e
+    Scalar length(Surface_mesh::Edge e) const { return length_[e]; }
+
+    /// area of triangle f, 0 for other polygons
+    Scalar area(Surface_mesh::Face f) const { return face_area_[f]; }
+
+    /// (mixed) Voronoi area of v, see voronoi_area()
+    double voronoi_area(Surface_mesh::Vertex v) const { return vertex_area_[v]; }
+
+
+    /// typed properties, valid until clear()
+    Surface_mesh::Edge_property<double>   cotans()        const { return cotan_; }
+    Surface_mesh::Edge_property<Scalar>   lengths()       const { return length_; }
+    Surface_mesh::Face_property<Scalar>   face_areas()    const { return face_area_; }
+    Surface_mesh::Vertex_property<double> voronoi_areas() const { return vertex_area_; }
+
+
+private:
+
+    // recompute for the given elements in parallel
+    void compute(const std::vector<Surface_mesh::Vertex>& vertices,
+                 const std::vector<Surface_mesh::Edge>&   edges,
+                 const std::vector<Surface_mesh::Face>&   faces);
+
+    // cache valid for the current revision?
+    bool is_current() const;
+
+    // stamp the cache with the current revision
+    void stamp();
+
+
+private:
+
+    Surface_mesh& mesh_;
+
+    Surface_mesh::Edge_property<double>    cotan_;
+    Surface_mesh::Edge_property<Scalar>    length_;
+    Surface_mesh::Face_property<Scalar>    face_area_;
+    Surface_mesh::Vertex_property<double>  vertex_area_;
+
+    std::vector<Surface_mesh::Vertex> dirty_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_GEOMETRY_CACHE_H
+//=============================================================================
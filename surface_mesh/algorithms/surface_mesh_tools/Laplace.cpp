@@ -0,0 +1,132 @@
+//== INCLUDES =================================================================
+
+#include "Laplace.h"
+#include "Geometry_cache.h"
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+void cotan_laplace(Surface_mesh& mesh, Sparse_matrix& L)
+{
+    const int nv = mesh.vertices_size();
+
+    Geometry_cache cache(mesh);
+    cache.update();
+
+
+    // row sizes: valence + diagonal
+    L.row.resize(nv+1);
+    L.row[0] = 0;
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        L.row[i+1] = L.row[i] + 1 +
+            ((mesh.is_deleted(v) || mesh.is_isolated(v)) ? 0 : mesh.valence(v));
+    }
+    L.col.resize(L.row[nv]);
+    L.val.resize(L.row[nv]);
+
+
+    // fill rows, sorted by column
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        Surface_mesh::Halfedge_around_vertex_circulator vhit, vhend;
+        unsigned int k = L.row[i];
+        double diag = 0.0;
+
+        if (!mesh.is_deleted(v) && !mesh.is_isolated(v))
+        {
+            vhit = vhend = mesh.halfedges(v);
+            do
+            {
+                const double w = 0.5 * cache.cotan(mesh.edge(*vhit));
+                L.col[k] = mesh.to_vertex(*vhit).idx();
+                L.val[k] = w;
+                diag -= w;
+                ++k;
+            }
+            while (++vhit != vhend);
+        }
+
+        L.col[k] = i;
+        L.val[k] = diag;
+
+
+        // insertion sort, rows are short
+        for (unsigned int a=L.row[i]+1; a<L.row[i+1]; ++a)
+        {
+            const unsigned int c = L.col[a];
+            const double       w = L.val[a];
+            unsigned int b = a;
+            for (; b>L.row[i] && L.col[b-1]>c; --b)
+            {
+                L.col[b] = L.col[b-1];
+                L.val[b] = L.val[b-1];
+            }
+            L.col[b] = c;
+            L.val[b] = w;
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void mass_matrix(Surface_mesh& mesh, std::vector<double>& M)
+{
+    const int nv = mesh.vertices_size();
+    M.resize(nv);
+
+    Geometry_cache cache(mesh);
+    cache.update();
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        M[i] = mesh.is_deleted(v) ? 0.0 : cache.voronoi_area(v);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Scalar mean_edge_length(Surface_mesh& mesh)
+{
+    const int ne = mesh.edges_size();
+
+    Geometry_cache cache(mesh);
+    cache.update();
+    double l = 0.0;
+    int    n = 0;
+
+#pragma omp parallel for reduction(+:l,n)
+    for (int i=0; i<ne; ++i)
+    {
+        Surface_mesh::Edge e(i);
+        if (!mesh.is_deleted(e))
+        {
+            l += cache.length(e);
+            ++n;
+        }
+    }
+
+    return n ? l/n : 0.0;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
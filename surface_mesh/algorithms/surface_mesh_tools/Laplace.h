@@ -0,0 +1,41 @@
+//=============================================================================
+
+#ifndef GRAPHENE_LAPLACE_H
+#define GRAPHENE_LAPLACE_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Sparse_matrix.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//=============================================================================
+
+/** assemble the cotan Laplace matrix, rows and columns are vertex indices:
+    L_ij = (cot(a_ij) + cot(b_ij)) / 2 for edges, L_ii = -sum_j L_ij. L is
+    symmetric and negative semi-definite, M^-1 L x is laplace() of x.
+    Deleted and isolated vertices only have a zero diagonal. The cotangents
+    are taken from the Geometry_cache, the rows are filled in parallel. */
+void cotan_laplace(Surface_mesh& mesh, Sparse_matrix& L);
+
+/// lumped mass matrix: (mixed) Voronoi area per vertex from the Geometry_cache
+void mass_matrix(Surface_mesh& mesh, std::vector<double>& M);
+
+/// mean edge length, used to scale time steps
+Scalar mean_edge_length(Surface_mesh& mesh);
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_LAPLACE_H
+//=============================================================================
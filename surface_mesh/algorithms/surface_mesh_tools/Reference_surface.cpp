@@ -0,0 +1,113 @@
+//== INCLUDES =================================================================
+
+#include "Reference_surface.h"
+#include <graphene/geometry/bary_coord.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//=============================================================================
+
+
+Reference_surface::
+Reference_surface(const Surface_mesh& mesh,
+                  const Surface_mesh::Vertex_property<Scalar>& values)
+: tree_(mesh, 10, 30)
+{
+    Surface_mesh::Vertex_property<Point> points = mesh.get_vertex_property<Point>("v:point");
+
+
+    // per-vertex data, independent per vertex
+    const int nv = mesh.vertices_size();
+    points_.resize(nv);
+    normals_.resize(nv);
+    values_.resize(nv);
+
+#pragma omp parallel for
+    for (int i=0; i<nv; ++i)
+    {
+        Surface_mesh::Vertex v(i);
+        points_[i]  = points[v];
+        normals_[i] = mesh.compute_vertex_normal(v);
+        values_[i]  = values[v];
+    }
+
+
+    // vertex indices of the triangles, indexed by face
+    corners_.resize(mesh.faces_size());
+    for (Surface_mesh::Face_iterator fit=mesh.faces_begin(); fit!=mesh.faces_end(); ++fit)
+    {
+        Corners& c = corners_[(*fit).idx()];
+        Surface_mesh::Vertex_around_face_circulator vfit = mesh.vertices(*fit);
+        for (int i=0; i<3; ++i, ++vfit)
+            c.v[i] = (*vfit).idx();
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Reference_surface::Sample
+Reference_surface::
+project(const Point& p) const
+{
+    Triangle_tree::Nearest_neighbor nn = tree_.nearest(p);
+    const Point b = barycentric_coordinates(nn.face, nn.nearest);
+
+    Sample s;
+    s.point  = nn.nearest;
+    s.normal = interpolate_normal(nn.face, b);
+    s.value  = interpolate_value(nn.face, b);
+    s.face   = nn.face;
+    return s;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Point
+Reference_surface::
+barycentric_coordinates(Surface_mesh::Face f, const Point& p) const
+{
+    const Corners& c = corners_[f.idx()];
+    return geometry::barycentric_coordinates(p, points_[c.v[0]],
+                                                points_[c.v[1]],
+                                                points_[c.v[2]]);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Point
+Reference_surface::
+interpolate_normal(Surface_mesh::Face f, const Point& b) const
+{
+    const Corners& c = corners_[f.idx()];
+    Point n = normals_[c.v[0]]*b[0] + normals_[c.v[1]]*b[1] + normals_[c.v[2]]*b[2];
+    return n.normalize();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Scalar
+Reference_surface::
+interpolate_value(Surface_mesh::Face f, const Point& b) const
+{
+    const Corners& c = corners_[f.idx()];
+    return values_[c.v[0]]*b[0] + values_[c.v[1]]*b[1] + values_[c.v[2]]*b[2];
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,87 @@
+//=============================================================================
+
+#ifndef GRAPHENE_REFERENCE_SURFACE_H
+#define GRAPHENE_REFERENCE_SURFACE_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Triangle_kD_tree.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+/// \addtogroup surface_mesh
+/// @{
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Immutable snapshot of a triangle mesh used as projection target while the
+/// mesh itself is being modified, e.g. during remeshing. Stores positions,
+/// vertex normals and a scalar per vertex, the three vertex indices of each
+/// face, and a kD tree for closest point queries. No other connectivity is
+/// kept. All queries are const and can be issued from several threads.
+class Reference_surface
+{
+public:
+
+    /// result of project()
+    struct Sample
+    {
+        Point               point;   ///< closest point on the surface
+        Point               normal;  ///< interpolated, normalized normal
+        Scalar              value;   ///< interpolated scalar
+        Surface_mesh::Face  face;    ///< face containing point
+    };
+
+
+    /// snapshot mesh (must be a triangle mesh) with per-vertex values,
+    /// normals are computed from the current positions
+    Reference_surface(const Surface_mesh& mesh,
+                      const Surface_mesh::Vertex_property<Scalar>& values);
+
+
+    /// closest point on the surface, with interpolated normal and value
+    Sample project(const Point& p) const;
+
+    /// barycentric coordinates of p with respect to face f
+    Point barycentric_coordinates(Surface_mesh::Face f, const Point& p) const;
+
+    /// normal of face f interpolated at barycentric coordinates b
+    Point interpolate_normal(Surface_mesh::Face f, const Point& b) const;
+
+    /// value of face f interpolated at barycentric coordinates b
+    Scalar interpolate_value(Surface_mesh::Face f, const Point& b) const;
+
+
+private:
+
+    // vertex indices of one triangle
+    struct Corners
+    {
+        int     v[3];
+    };
+
+    std::vector<Point>    points_;
+    std::vector<Point>    normals_;
+    std::vector<Scalar>   values_;
+    std::vector<Corners>  corners_;
+    Triangle_kD_tree      tree_;
+};
+
+
+/// @}
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_REFERENCE_SURFACE_H
+//=============================================================================
@@ -0,0 +1,644 @@
+//== INCLUDES =================================================================
+
+#include "Sparse_matrix.h"
+
+#include <cmath>
+#include <cassert>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ===========================================================
+
+
+namespace {
+
+double dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const int n = a.size();
+    double d = 0.0;
+
+#pragma omp parallel for reduction(+:d)
+    for (int i=0; i<n; ++i)
+        d += a[i] * b[i];
+
+    return d;
+}
+
+
+// nested dissection: recursively split the graph of A (nonzero entries) by
+// a level set of a breadth first search from a pseudo-peripheral node, the
+// separators are numbered after the two parts. perm maps new to old index.
+void nested_dissection(const Sparse_matrix& A, std::vector<unsigned int>& perm)
+{
+    const unsigned int n = A.rows();
+
+    struct Block
+    {
+        std::vector<unsigned int> nodes;
+        unsigned int              first;  // position of the first node
+    };
+
+    std::vector<int>           label(n, 0), level(n, -1);
+    std::vector<unsigned int>  queue;
+    std::vector<Block>         stack(1);
+    int                        n_labels = 0;
+
+    perm.resize(n);
+    stack[0].first = 0;
+    for (unsigned int i=0; i<n; ++i)
+        stack[0].nodes.push_back(i);
+
+
+    while (!stack.empty())
+    {
+        Block block;
+        block.nodes.swap(stack.back().nodes);
+        block.first = stack.back().first;
+        stack.pop_back();
+
+        const unsigned int m = block.nodes.size();
+        const int id = ++n_labels;
+        for (unsigned int i=0; i<m; ++i)
+            label[block.nodes[i]] = id;
+
+
+        // breadth first search from root within the block, returns the
+        // number of levels. the last node in queue is the farthest.
+        unsigned int n_levels = 0;
+        unsigned int root = block.nodes[0];
+        for (unsigned int sweep=0; sweep<2 && m>64; ++sweep)
+        {
+            for (unsigned int i=0; i<queue.size(); ++i)
+                level[queue[i]] = -1;
+            queue.clear();
+
+            queue.push_back(root);
+            level[root] = 0;
+            for (unsigned int q=0; q<queue.size(); ++q)
+            {
+                const unsigned int i = queue[q];
+                for (unsigned int k=A.row[i]; k<A.row[i+1]; ++k)
+                {
+                    const unsigned int j = A.col[k];
+                    if (label[j] == id && level[j] == -1 && A.val[k] != 0.0)
+                    {
+                        level[j] = level[i] + 1;
+                        queue.push_back(j);
+                    }
+                }
+            }
+            n_levels = level[queue.back()] + 1;
+            root = queue.back();
+        }
+
+
+        std::vector<unsigned int> part1, part2, separator;
+
+        if (m <= 64)
+        {
+            // small enough
+        }
+        else if (queue.size() < m)
+        {
+            // not connected: split off the component of the root
+            for (unsigned int i=0; i<m; ++i)
+            {
+                if (level[block.nodes[i]] != -1)
+                    part1.push_back(block.nodes[i]);
+                else
+                    part2.push_back(block.nodes[i]);
+            }
+        }
+        else if (n_levels > 2)
+        {
+            // separator: the level containing the median node
+            int median = level[queue[m/2]];
+            if (median == 0)                median = 1;
+            if (median == (int)n_levels-1)  median = n_levels-2;
+
+            for (unsigned int i=0; i<m; ++i)
+            {
+                const unsigned int j = block.nodes[i];
+                if      (level[j] < median) part1.push_back(j);
+                else if (level[j] > median) part2.push_back(j);
+                else                        separator.push_back(j);
+            }
+        }
+
+        for (unsigned int i=0; i<queue.size(); ++i)
+            level[queue[i]] = -1;
+        queue.clear();
+
+
+        if (part1.empty() || part2.empty())
+        {
+            // leaf: keep the order
+            for (unsigned int i=0; i<m; ++i)
+                perm[block.first + i] = block.nodes[i];
+        }
+        else
+        {
+            for (unsigned int i=0; i<separator.size(); ++i)
+                perm[block.first + part1.size() + part2.size() + i] = separator[i];
+
+            stack.push_back(Block());
+            stack.back().nodes.swap(part1);
+            stack.back().first = block.first;
+            stack.push_back(Block());
+            stack.back().first = block.first + stack[stack.size()-2].nodes.size();
+            stack.back().nodes.swap(part2);
+        }
+    }
+}
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+double
+Sparse_matrix::
+operator()(unsigned int i, unsigned int j) const
+{
+    for (unsigned int k=row[i]; k<row[i+1]; ++k)
+        if (col[k] == j)
+            return val[k];
+    return 0.0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_matrix::
+multiply(const std::vector<double>& x, std::vector<double>& y) const
+{
+    const int n = rows();
+    y.resize(n);
+
+#pragma omp parallel for
+    for (int i=0; i<n; ++i)
+    {
+        double s = 0.0;
+        for (unsigned int k=row[i]; k<row[i+1]; ++k)
+            s += val[k] * x[col[k]];
+        y[i] = s;
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_matrix::
+scale(double s)
+{
+    for (unsigned int k=0; k<val.size(); ++k)
+        val[k] *= s;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_matrix::
+add_diagonal(const std::vector<double>& d)
+{
+    const unsigned int n = rows();
+    for (unsigned int i=0; i<n; ++i)
+    {
+        for (unsigned int k=row[i]; k<row[i+1]; ++k)
+        {
+            if (col[k] == i)
+            {
+                val[k] += d[i];
+                break;
+            }
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_matrix::
+constrain_rhs(const std::vector<bool>& fixed,
+              const std::vector<double>& x,
+              std::vector<double>& b) const
+{
+    const unsigned int n = rows();
+    for (unsigned int i=0; i<n; ++i)
+    {
+        if (fixed[i])
+        {
+            b[i] = x[i];
+        }
+        else
+        {
+            for (unsigned int k=row[i]; k<row[i+1]; ++k)
+                if (fixed[col[k]])
+                    b[i] -= val[k] * x[col[k]];
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_matrix::
+constrain(const std::vector<bool>& fixed)
+{
+    const unsigned int n = rows();
+    for (unsigned int i=0; i<n; ++i)
+    {
+        for (unsigned int k=row[i]; k<row[i+1]; ++k)
+        {
+            if (fixed[i] || fixed[col[k]])
+                val[k] = (col[k] == i) ? 1.0 : 0.0;
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Sparse_cholesky::
+factorize(const Sparse_matrix& A)
+{
+    const unsigned int n = A.rows();
+
+
+    // fill reducing ordering
+    nested_dissection(A, perm_);
+    std::vector<unsigned int> inv(n);
+    for (unsigned int k=0; k<n; ++k)
+        inv[perm_[k]] = k;
+
+
+    // lower triangle of the permuted matrix by rows (= upper by columns)
+    std::vector<unsigned int> Cp(n+1), Ci;
+    std::vector<double>       Cx;
+    Cp[0] = 0;
+    for (unsigned int k=0; k<n; ++k)
+    {
+        const unsigned int i = perm_[k];
+        for (unsigned int p=A.row[i]; p<A.row[i+1]; ++p)
+        {
+            const unsigned int j = inv[A.col[p]];
+            if (j <= k && (j == k || A.val[p] != 0.0))
+            {
+                Ci.push_back(j);
+                Cx.push_back(A.val[p]);
+            }
+        }
+        Cp[k+1] = Ci.size();
+    }
+
+
+    // symbolic: elimination tree and column counts (LDL, T. Davis)
+    std::vector<int>          parent(n), flag(n);
+    std::vector<unsigned int> Lnz(n);
+    for (unsigned int k=0; k<n; ++k)
+    {
+        parent[k] = -1;
+        flag[k]   = k;
+        Lnz[k]    = 0;
+        for (unsigned int p=Cp[k]; p<Cp[k+1]; ++p)
+        {
+            for (int i=Ci[p]; i<(int)k && flag[i]!=(int)k; i=parent[i])
+            {
+                if (parent[i] == -1) parent[i] = k;
+                ++Lnz[i];
+                flag[i] = k;
+            }
+        }
+    }
+
+    Lp_.resize(n+1);
+    Lp_[0] = 0;
+    for (unsigned int k=0; k<n; ++k)
+        Lp_[k+1] = Lp_[k] + Lnz[k];
+    Li_.resize(Lp_[n]);
+    Lx_.resize(Lp_[n]);
+    D_.resize(n);
+
+
+    // numeric: row k of L from a sparse triangular solve
+    std::vector<double>        Y(n, 0.0);
+    std::vector<unsigned int>  pattern(n);
+    for (unsigned int k=0; k<n; ++k)
+    {
+        unsigned int top = n;
+        flag[k] = k;
+        Lnz[k]  = 0;
+
+        for (unsigned int p=Cp[k]; p<Cp[k+1]; ++p)
+        {
+            int i = Ci[p];
+            Y[i] += Cx[p];
+
+            unsigned int len = 0;
+            for (; flag[i]!=(int)k; i=parent[i])
+            {
+                pattern[len++] = i;
+                flag[i] = k;
+            }
+            while (len > 0)
+                pattern[--top] = pattern[--len];
+        }
+
+        double d = Y[k];
+        Y[k] = 0.0;
+        for (; top<n; ++top)
+        {
+            const unsigned int i  = pattern[top];
+            const double       yi = Y[i];
+            Y[i] = 0.0;
+
+            const unsigned int p2 = Lp_[i] + Lnz[i];
+            for (unsigned int p=Lp_[i]; p<p2; ++p)
+                Y[Li_[p]] -= Lx_[p] * yi;
+
+            const double l = yi / D_[i];
+            d -= l * yi;
+            Li_[p2] = k;
+            Lx_[p2] = l;
+            ++Lnz[i];
+        }
+
+        if (!(d > 0.0))
+            return false;
+        D_[k] = d;
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_cholesky::
+solve(const std::vector<double>& b, std::vector<double>& x) const
+{
+    const unsigned int n = D_.size();
+    std::vector<double> y(n);
+
+    for (unsigned int k=0; k<n; ++k)
+        y[k] = b[perm_[k]];
+
+    // L y = P b
+    for (unsigned int j=0; j<n; ++j)
+        for (unsigned int p=Lp_[j]; p<Lp_[j+1]; ++p)
+            y[Li_[p]] -= Lx_[p] * y[j];
+
+    // D y = y
+    for (unsigned int j=0; j<n; ++j)
+        y[j] /= D_[j];
+
+    // L^T y = y
+    for (int j=n-1; j>=0; --j)
+        for (unsigned int p=Lp_[j]; p<Lp_[j+1]; ++p)
+            y[j] -= Lx_[p] * y[Li_[p]];
+
+    x.resize(n);
+    for (unsigned int k=0; k<n; ++k)
+        x[perm_[k]] = y[k];
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_cg::
+factorize(const Sparse_matrix& A)
+{
+    A_ = A;
+
+    // shift the diagonal until the incomplete factorization succeeds
+    double shift = 0.0;
+    for (unsigned int i=0; i<10; ++i)
+    {
+        if (factorize_ic(shift)) return;
+        shift = (shift == 0.0) ? 1e-3 : 4.0*shift;
+    }
+
+
+    // give up: Jacobi preconditioner
+    const unsigned int n = A_.rows();
+    L_.row.resize(n+1);
+    L_.col.resize(n);
+    L_.val.resize(n);
+    for (unsigned int i=0; i<n; ++i)
+    {
+        const double d = A_(i,i);
+        L_.row[i] = i;
+        L_.col[i] = i;
+        L_.val[i] = (d > 0.0) ? sqrt(d) : 1.0;
+    }
+    L_.row[n] = n;
+    U_ = L_;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Sparse_cg::
+factorize_ic(double shift)
+{
+    const unsigned int n = A_.rows();
+
+
+    // pattern of the lower triangle
+    L_.row.resize(n+1);
+    L_.col.clear();
+    L_.val.clear();
+    for (unsigned int i=0; i<n; ++i)
+    {
+        L_.row[i] = L_.col.size();
+        for (unsigned int k=A_.row[i]; k<A_.row[i+1] && A_.col[k]<=i; ++k)
+        {
+            L_.col.push_back(A_.col[k]);
+            L_.val.push_back(A_.val[k]);
+        }
+        if (L_.col.empty() || L_.col.back() != i)
+            return false; // no diagonal
+    }
+    L_.row[n] = L_.col.size();
+
+
+    // L_ik = (A_ik - sum_j<k L_ij L_kj) / L_kk, restricted to the pattern of A
+    for (unsigned int i=0; i<n; ++i)
+    {
+        const unsigned int ib = L_.row[i], id = L_.row[i+1]-1;
+
+        for (unsigned int p=ib; p<id; ++p)
+        {
+            const unsigned int k  = L_.col[p];
+            const unsigned int kd = L_.row[k+1]-1;
+            double s = L_.val[p];
+
+            // merge the sorted rows i and k up to column k
+            unsigned int a = ib, b = L_.row[k];
+            while (a < p && b < kd)
+            {
+                if      (L_.col[a] < L_.col[b]) ++a;
+                else if (L_.col[a] > L_.col[b]) ++b;
+                else    s -= L_.val[a++] * L_.val[b++];
+            }
+
+            L_.val[p] = s / L_.val[kd];
+        }
+
+        double d = L_.val[id] * (1.0 + shift);
+        for (unsigned int p=ib; p<id; ++p)
+            d -= L_.val[p] * L_.val[p];
+
+        if (!(d > 1e-12 * fabs(L_.val[id])))
+            return false;
+
+        L_.val[id] = sqrt(d);
+    }
+
+
+    // transpose for the backward substitution
+    U_.row.assign(n+1, 0);
+    U_.col.resize(L_.col.size());
+    U_.val.resize(L_.val.size());
+    for (unsigned int k=0; k<L_.col.size(); ++k)
+        ++U_.row[L_.col[k]+1];
+    for (unsigned int i=0; i<n; ++i)
+        U_.row[i+1] += U_.row[i];
+
+    std::vector<unsigned int> next(U_.row.begin(), U_.row.end()-1);
+    for (unsigned int i=0; i<n; ++i)
+    {
+        for (unsigned int k=L_.row[i]; k<L_.row[i+1]; ++k)
+        {
+            const unsigned int j = next[L_.col[k]]++;
+            U_.col[j] = i;
+            U_.val[j] = L_.val[k];
+        }
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Sparse_cg::
+precondition(const std::vector<double>& r, std::vector<double>& z) const
+{
+    const int n = L_.rows();
+
+
+    // L y = r
+    for (int i=0; i<n; ++i)
+    {
+        const unsigned int id = L_.row[i+1]-1;
+        double s = r[i];
+        for (unsigned int k=L_.row[i]; k<id; ++k)
+            s -= L_.val[k] * z[L_.col[k]];
+        z[i] = s / L_.val[id];
+    }
+
+
+    // L^T z = y
+    for (int i=n-1; i>=0; --i)
+    {
+        const unsigned int id = U_.row[i];
+        double s = z[i];
+        for (unsigned int k=id+1; k<U_.row[i+1]; ++k)
+            s -= U_.val[k] * z[U_.col[k]];
+        z[i] = s / U_.val[id];
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+Sparse_cg::
+solve(const std::vector<double>& b, std::vector<double>& x) const
+{
+    const int n = A_.rows();
+    assert((int)b.size() == n);
+    x.resize(n, 0.0);
+
+
+    const double bnorm = sqrt(dot(b, b));
+    if (bnorm == 0.0)
+    {
+        x.assign(n, 0.0);
+        return true;
+    }
+
+
+    std::vector<double> r(n), z(n), p(n), Ap(n);
+
+    // r = b - A x
+    A_.multiply(x, Ap);
+    for (int i=0; i<n; ++i)
+        r[i] = b[i] - Ap[i];
+
+    precondition(r, z);
+    p = z;
+    double rz = dot(r, z);
+
+
+    for (unsigned int iter=0; iter<max_iterations_; ++iter)
+    {
+        if (sqrt(dot(r, r)) <= tolerance_ * bnorm)
+            return true;
+
+        A_.multiply(p, Ap);
+        const double alpha = rz / dot(p, Ap);
+
+#pragma omp parallel for
+        for (int i=0; i<n; ++i)
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * Ap[i];
+        }
+
+        precondition(r, z);
+        const double rz_new = dot(r, z);
+        const double beta   = rz_new / rz;
+        rz = rz_new;
+
+#pragma omp parallel for
+        for (int i=0; i<n; ++i)
+            p[i] = z[i] + beta * p[i];
+    }
+
+    return sqrt(dot(r, r)) <= tolerance_ * bnorm;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,144 @@
+//=============================================================================
+
+#ifndef GRAPHENE_SPARSE_MATRIX_H
+#define GRAPHENE_SPARSE_MATRIX_H
+
+
+//== INCLUDES =================================================================
+
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Square sparse matrix in compressed row storage (CSR). The entries of row
+/// i are [row[i], row[i+1]) in col and val, sorted by column. Symmetric
+/// matrices store both triangles.
+struct Sparse_matrix
+{
+    /// number of rows (and columns)
+    unsigned int rows() const { return row.empty() ? 0 : row.size()-1; }
+
+    /// number of stored entries
+    unsigned int nonzeros() const { return col.size(); }
+
+    /// entry (i,j), 0 if not stored
+    double operator()(unsigned int i, unsigned int j) const;
+
+    /// y = A x, rows in parallel
+    void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+    /// A *= s
+    void scale(double s);
+
+    /// A += diag(d), the diagonal has to be stored
+    void add_diagonal(const std::vector<double>& d);
+
+    /// Dirichlet constraints x_i = x[i] for fixed variables: b[i] = x[i] for
+    /// fixed rows, b -= A_(free,fixed) x for the others. Call on the matrix
+    /// before constrain().
+    void constrain_rhs(const std::vector<bool>& fixed,
+                       const std::vector<double>& x,
+                       std::vector<double>& b) const;
+
+    /// zero the rows and columns of fixed variables and put 1 on their
+    /// diagonal, a symmetric matrix stays symmetric
+    void constrain(const std::vector<bool>& fixed);
+
+
+    std::vector<unsigned int>  row;
+    std::vector<unsigned int>  col;
+    std::vector<double>        val;
+};
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Sparse Cholesky factorization A = P^T L D L^T P of a symmetric positive
+/// definite matrix. P is a nested dissection ordering to limit the fill-in.
+/// factorize() is the expensive part, every solve() is just two triangular
+/// solves. solve() is const and can be called from several threads, e.g.
+/// once per coordinate.
+class Sparse_cholesky
+{
+public:
+
+    /// factorize A, false if A is not positive definite
+    bool factorize(const Sparse_matrix& A);
+
+    /// solve A x = b
+    void solve(const std::vector<double>& b, std::vector<double>& x) const;
+
+
+private:
+
+    std::vector<unsigned int>  perm_;   // new -> old index
+    std::vector<unsigned int>  Lp_;     // columns of L (unit diagonal not stored)
+    std::vector<unsigned int>  Li_;
+    std::vector<double>        Lx_;
+    std::vector<double>        D_;
+};
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Conjugate gradients for symmetric positive definite sparse matrices,
+/// preconditioned by an incomplete Cholesky factorization without fill-in.
+/// Needs much less memory than Sparse_cholesky, but only solves up to the
+/// given tolerance and needs more time per solve. Suited for well
+/// conditioned systems with a good initial guess, e.g. small time steps.
+class Sparse_cg
+{
+public:
+
+    Sparse_cg() : tolerance_(1e-8), max_iterations_(1000) {}
+
+    /// stop when the residual is below tolerance times the norm of b
+    void set_tolerance(double tolerance) { tolerance_ = tolerance; }
+
+    /// stop after this many iterations
+    void set_max_iterations(unsigned int n) { max_iterations_ = n; }
+
+    /// store A and factorize the preconditioner. if the factorization breaks
+    /// down the diagonal is shifted, in the worst case Jacobi is used.
+    void factorize(const Sparse_matrix& A);
+
+    /// solve A x = b, x is the initial guess. false if not converged.
+    bool solve(const std::vector<double>& b, std::vector<double>& x) const;
+
+
+private:
+
+    // incomplete factorization of A with diagonal scaled by 1+shift
+    bool factorize_ic(double shift);
+
+    // z = (L L^T)^-1 r
+    void precondition(const std::vector<double>& r, std::vector<double>& z) const;
+
+
+private:
+
+    double        tolerance_;
+    unsigned int  max_iterations_;
+
+    Sparse_matrix A_;
+    Sparse_matrix L_;   // lower triangle, diagonal last in each row
+    Sparse_matrix U_;   // L^T, diagonal first in each row
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_SPARSE_MATRIX_H
+//=============================================================================
@@ -6,9 +6,7 @@
 
 //== INCLUDES =================================================================
 
-#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
-#include <graphene/geometry/Plane.h>
-#include <vector>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Triangle_tree.h>
 
 
 //== NAMESPACES ===============================================================
@@ -23,67 +21,31 @@ namespace surface_mesh {
 
 //== CLASS DEFINITION =========================================================
 
-/// Triangle BSP
-class Triangle_BSP
+/// Triangle BSP: arbitrary splitting planes orthogonal to the principal axis
+/// of the triangle centers. More expensive to build than the kD tree, but
+/// tighter cells for thin or diagonal structures.
+class Triangle_BSP : public Triangle_tree
 {
 public:
 
     /// construct with mesh
-    Triangle_BSP(Surface_mesh&    mesh);
-
-    /// destructur
-    ~Triangle_BSP() { delete root_; }
+    Triangle_BSP(const Surface_mesh& mesh);
 
     /// construct BSP, returns depth of the tree
     unsigned int build(unsigned int  max_faces=10, unsigned int  max_depth=100);
 
 
-    /// nearest neighbor information
-    struct Nearest_neighbor
-    {
-        Scalar              dist;
-        Surface_mesh::Face  face;
-        Point               nearest;
-        int                 tests;
-    };
-
-    /// Return handle of the nearest neighbor
-    Nearest_neighbor nearest(const Point& p) const;
-
-
-
 private:
 
-    typedef graphene::geometry::Plane Plane;    
-
-    // Node of the tree: contains parent, children and splitting plane
-    struct Node
-    {
-        Node(Node* _parent);
-        ~Node();
-        Node *parent_, *left_child_, *right_child_;
-        std::vector<Surface_mesh::Face> faces_;
-        Plane plane_;
-    };
-
-
-private:
-    
-    // Recursive part of build()
-    unsigned int _build(Node*        node,
-                        unsigned int max_handles,
-                        unsigned int depth);
-
-    // Recursive part of nearest()
-    void _nearest(Node* node, const Point& point, Nearest_neighbor& data) const;
-
+    // plane through centroid, orthogonal to principal direction
+    virtual bool split_plane(const Triangles& triangles,
+                             Point&           normal,
+                             Scalar&          offset) const;
 
 
 private:
 
-    Surface_mesh&  mesh_;
-    Node*       root_;
-    Surface_mesh::Vertex_property<Point> points_;
+    const Surface_mesh&  mesh_;
 };
 
 /// @}
@@ -6,8 +6,7 @@
 
 //== INCLUDES =================================================================
 
-#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
-#include <vector>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Triangle_tree.h>
 
 
 //== NAMESPACES ===============================================================
@@ -22,8 +21,9 @@ namespace surface_mesh {
 //== CLASS DEFINITION =========================================================
 
 
-
-class Triangle_kD_tree
+/// Triangle kD tree: axis-aligned splits at the middle of the longest side of
+/// the bounding box. Cheap to build, good default for projection queries.
+class Triangle_kD_tree : public Triangle_tree
 {
 public:
 
@@ -32,75 +32,13 @@ public:
                      unsigned int  max_faces=10,
                      unsigned int  max_depth=30);
 
-    /// destructur
-    ~Triangle_kD_tree() { delete root_; }
-
-    /// nearest neighbor information
-    struct Nearest_neighbor
-    {
-        Scalar              dist;
-        Surface_mesh::Face  face;
-        Point               nearest;
-        int                 tests;
-    };
-
-
-    /// Return handle of the nearest neighbor
-    Nearest_neighbor nearest(const Point& p) const;
-
-
-
-private:
-
-    // triangle stores corners and face handle
-    struct Triangle
-    {
-        Triangle() {}
-        Triangle(const Point& x0, const Point& x1, const Point& x2, Surface_mesh::Face ff)
-        { x[0]=x0; x[1]=x1; x[2]=x2; f=ff; }
-
-        Point x[3];
-        Surface_mesh::Face f;
-    };
-
-
-    // vector of Triangle
-    typedef std::vector<Triangle>  Triangles;
-
-
-    // Node of the tree: contains parent, children and splitting plane
-    struct Node
-    {
-        Node() : faces_(0), left_child_(0), right_child_(0) {}
-
-        ~Node()
-        {
-            delete faces_;
-            delete left_child_;
-            delete right_child_;
-        }
-
-        unsigned char axis_;
-        Scalar        split_;
-        Triangles     *faces_;
-        Node          *left_child_;
-        Node          *right_child_;
-    };
-
-
-    // Recursive part of build()
-    unsigned int _build(Node*        node,
-                        unsigned int max_handles,
-                        unsigned int depth);
-
-    // Recursive part of nearest()
-    void _nearest(Node* node, const Point& point, Nearest_neighbor& data) const;
-
-
 
 private:
 
-    Node *root_;
+    // split longest side of bounding box
+    virtual bool split_plane(const Triangles& triangles,
+                             Point&           normal,
+                             Scalar&          offset) const;
 };
 
 /// @}
@@ -0,0 +1,205 @@
+//== INCLUDES =================================================================
+
+#include "Triangle_tree.h"
+#include <graphene/geometry/distance_point_triangle.h>
+#include <float.h>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//=============================================================================
+
+
+unsigned int
+Triangle_tree::
+build_tree(const Surface_mesh& mesh,
+           unsigned int max_faces,
+           unsigned int max_depth)
+{
+    nodes_.clear();
+    triangles_.clear();
+
+    Surface_mesh::Vertex_property<Point> points = mesh.get_vertex_property<Point>("v:point");
+
+
+    // collect triangles
+    Triangles triangles;
+    Triangle  tri;
+    triangles.reserve(mesh.n_faces());
+    for (Surface_mesh::Face_iterator fit=mesh.faces_begin(); fit!=mesh.faces_end(); ++fit)
+    {
+        Surface_mesh::Vertex_around_face_circulator vfit = mesh.vertices(*fit);
+        tri.x[0] = points[*vfit];
+        ++vfit;
+        tri.x[1] = points[*vfit];
+        ++vfit;
+        tri.x[2] = points[*vfit];
+        tri.f  = *fit;
+        triangles.push_back(tri);
+    }
+
+
+    // root node, call recursive helper
+    nodes_.reserve(2 * (mesh.n_faces() / std::max(max_faces, 1u) + 1));
+    triangles_.reserve(triangles.size());
+    nodes_.push_back(Node());
+    int depth = _build(0, triangles, max_faces, max_depth);
+
+
+    // compact memory
+    std::vector<Node>(nodes_).swap(nodes_);
+    Triangles(triangles_).swap(triangles_);
+
+    return max_depth - depth;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Triangle_tree::
+_build(unsigned int  node,
+       Triangles&    triangles,
+       unsigned int  max_faces,
+       unsigned int  depth)
+{
+    Point   normal;
+    Scalar  offset;
+
+
+    // should we split at this level ?
+    if ((depth > 0) &&
+        (triangles.size() > max_faces) &&
+        split_plane(triangles, normal, offset))
+    {
+        Triangles left, right;
+        left.reserve(triangles.size()/2);
+        right.reserve(triangles.size()/2);
+
+
+        // partition for left and right child
+        Triangles::const_iterator fit, fend=triangles.end();
+        for (fit=triangles.begin(); fit!=fend; ++fit)
+        {
+            bool l=false, r=false;
+
+            const Triangle& t = *fit;
+            if (dot(normal, t.x[0]) <= offset) l=true; else r=true;
+            if (dot(normal, t.x[1]) <= offset) l=true; else r=true;
+            if (dot(normal, t.x[2]) <= offset) l=true; else r=true;
+
+            if (l) left.push_back(t);
+            if (r) right.push_back(t);
+        }
+
+
+        // recurse only if the split separates something
+        if (left.size()  != triangles.size() &&
+            right.size() != triangles.size())
+        {
+            Triangles().swap(triangles);
+
+            unsigned int child = nodes_.size();
+            nodes_.push_back(Node());
+            nodes_.push_back(Node());
+
+            Node& n   = nodes_[node];
+            n.normal_ = normal;
+            n.offset_ = offset;
+            n.child_  = child;
+
+            int depth_left  = _build(child,   left,  max_faces, depth-1);
+            int depth_right = _build(child+1, right, max_faces, depth-1);
+
+            return std::min(depth_left, depth_right);
+        }
+    }
+
+
+    // leaf: append triangles to packed array
+    Node& n  = nodes_[node];
+    n.begin_ = triangles_.size();
+    triangles_.insert(triangles_.end(), triangles.begin(), triangles.end());
+    n.end_   = triangles_.size();
+    Triangles().swap(triangles);
+
+    return depth;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Triangle_tree::Nearest_neighbor
+Triangle_tree::nearest(const Point& p) const
+{
+    Nearest_neighbor data;
+    data.dist = FLT_MAX;
+    data.tests = 0;
+    if (!nodes_.empty())
+        _nearest(0, p, data);
+    return data;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Triangle_tree::
+_nearest(unsigned int node, const Point& point, Nearest_neighbor& data) const
+{
+    const Node& n = nodes_[node];
+
+
+    // terminal node?
+    if (n.is_leaf())
+    {
+        Scalar d;
+        Point  nearest;
+
+        for (unsigned int i=n.begin_; i<n.end_; ++i)
+        {
+            const Triangle& t = triangles_[i];
+            d = geometry::dist_point_triangle(point, t.x[0], t.x[1], t.x[2], nearest);
+            ++data.tests;
+            if (d < data.dist)
+            {
+                data.dist    = d;
+                data.face    = t.f;
+                data.nearest = nearest;
+            }
+        }
+    }
+
+
+    // non-terminal node
+    else
+    {
+        Scalar dist = dot(n.normal_, point) - n.offset_;
+
+        if (dist <= 0.0)
+        {
+            _nearest(n.child_, point, data);
+            if (fabs(dist) < data.dist)
+                _nearest(n.child_+1, point, data);
+        }
+        else
+        {
+            _nearest(n.child_+1, point, data);
+            if (fabs(dist) < data.dist)
+                _nearest(n.child_, point, data);
+        }
+    }
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
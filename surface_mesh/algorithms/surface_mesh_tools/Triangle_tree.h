@@ -0,0 +1,129 @@
+//=============================================================================
+
+#ifndef TRIANGLE_TREE_H
+#define TRIANGLE_TREE_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACES ===============================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+/// \addtogroup surface_mesh
+/// @{
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Common core of the triangle search trees (kD tree, BSP). Nodes live in one
+/// contiguous array, each leaf refers to a range of a packed triangle array
+/// that stores corner positions, so queries never touch the mesh again.
+/// Derived classes only decide how a set of triangles is split.
+class Triangle_tree
+{
+public:
+
+    /// nearest neighbor information
+    struct Nearest_neighbor
+    {
+        Scalar              dist;
+        Surface_mesh::Face  face;
+        Point               nearest;
+        int                 tests;
+    };
+
+    /// destructor
+    virtual ~Triangle_tree() {}
+
+    /// Return handle of the nearest neighbor
+    Nearest_neighbor nearest(const Point& p) const;
+
+    /// number of nodes of the tree
+    unsigned int n_nodes() const { return nodes_.size(); }
+
+    /// number of (possibly duplicated) triangles stored in the leaves
+    unsigned int n_triangles() const { return triangles_.size(); }
+
+
+protected:
+
+    // triangle stores corners and face handle
+    struct Triangle
+    {
+        Triangle() {}
+        Triangle(const Point& x0, const Point& x1, const Point& x2, Surface_mesh::Face ff)
+        { x[0]=x0; x[1]=x1; x[2]=x2; f=ff; }
+
+        Point x[3];
+        Surface_mesh::Face f;
+    };
+
+    // vector of Triangle
+    typedef std::vector<Triangle>  Triangles;
+
+
+protected:
+
+    /// clear the tree, collect triangles of mesh and build the nodes,
+    /// returns the depth of the tree
+    unsigned int build_tree(const Surface_mesh& mesh,
+                            unsigned int max_faces,
+                            unsigned int max_depth);
+
+    /// compute the splitting plane (normal, offset) for a set of triangles.
+    /// return false if the triangles should not be split.
+    virtual bool split_plane(const Triangles& triangles,
+                             Point&           normal,
+                             Scalar&          offset) const = 0;
+
+
+private:
+
+    // Node of the tree: internal nodes store the splitting plane and the index
+    // of their left child (the right child follows directly), leaves store a
+    // range into triangles_
+    struct Node
+    {
+        Node() : child_(0), begin_(0), end_(0) {}
+
+        bool is_leaf() const { return child_ == 0; }
+
+        Point         normal_;
+        Scalar        offset_;
+        unsigned int  child_;
+        unsigned int  begin_, end_;
+    };
+
+
+    // Recursive part of build_tree(), consumes triangles
+    unsigned int _build(unsigned int  node,
+                        Triangles&    triangles,
+                        unsigned int  max_faces,
+                        unsigned int  depth);
+
+    // Recursive part of nearest()
+    void _nearest(unsigned int node, const Point& point, Nearest_neighbor& data) const;
+
+
+private:
+
+    std::vector<Node>  nodes_;
+    Triangles          triangles_;
+};
+
+
+/// @}
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif
+//=============================================================================
@@ -0,0 +1,129 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/algorithms/subdivision/Limit_evaluator.h>
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+using namespace graphene;
+using namespace graphene::surface_mesh;
+
+
+namespace {
+
+
+// open n x n grid of quads or triangles, lifted by height times a smooth bump
+Surface_mesh grid(unsigned int n, bool quads, Scalar height)
+{
+    Surface_mesh mesh;
+    std::vector<Surface_mesh::Vertex> v;
+
+    for (unsigned int j=0; j<=n; ++j)
+    {
+        for (unsigned int i=0; i<=n; ++i)
+        {
+            const Scalar z = height * (sin(1.3*i + 0.4) * cos(0.7*j) + 0.1*i*j);
+            v.push_back(mesh.add_vertex(Point(i, j, z)));
+        }
+    }
+
+    for (unsigned int j=0; j<n; ++j)
+    {
+        for (unsigned int i=0; i<n; ++i)
+        {
+            const Surface_mesh::Vertex a = v[ j   *(n+1) + i  ];
+            const Surface_mesh::Vertex b = v[ j   *(n+1) + i+1];
+            const Surface_mesh::Vertex c = v[(j+1)*(n+1) + i+1];
+            const Surface_mesh::Vertex d = v[(j+1)*(n+1) + i  ];
+
+            // alternating diagonals give boundary vertices of 1 to 3 faces
+            if (quads)
+                mesh.add_quad(a, b, c, d);
+            else if ((i+j) % 2)
+            {
+                mesh.add_triangle(a, b, c);
+                mesh.add_triangle(a, c, d);
+            }
+            else
+            {
+                mesh.add_triangle(a, b, d);
+                mesh.add_triangle(b, c, d);
+            }
+        }
+    }
+
+    return mesh;
+}
+
+
+// compare the limit normals of the control vertices with the normals after
+// levels steps of subdivision, also at the face corners for evaluate()
+bool check(const char* name, Subdivider::Scheme scheme, bool quads, Scalar height,
+           unsigned int levels, Scalar tolerance)
+{
+    const Surface_mesh control = grid(4, quads, height);
+
+    Surface_mesh refined = control;
+    Subdivider subdivider(scheme);
+    subdivider.setup(refined, levels);
+    subdivider.refine(refined);
+
+    Limit_evaluator evaluator(scheme);
+    Surface_mesh limit = control;
+    if (!evaluator.setup(limit) || !evaluator.project(limit))
+    {
+        printf("%s: setup failed\n", name);
+        return false;
+    }
+    Surface_mesh::Vertex_property<Normal> normals = limit.get_vertex_property<Normal>("v:normal");
+
+    Scalar error(0), corner_error(0);
+    for (auto v: control.vertices())
+    {
+        // refined vertices keep the index of their control vertex
+        const Normal n = refined.compute_vertex_normal(v);
+        error = std::max(error, norm(normals[v] - n));
+
+        Point  p;
+        Normal nf;
+        for (auto f: control.faces(v))
+        {
+            // parameter (0,0) is the second vertex of f
+            if (control.to_vertex(control.halfedge(f)) == v &&
+                evaluator.evaluate(control, f, 0, 0, p, nf))
+                corner_error = std::max(corner_error, norm(nf - n));
+        }
+    }
+
+    const bool ok = (error < tolerance && corner_error < tolerance);
+    printf("%s: normal error %g, evaluate() error %g %s\n",
+           name, error, corner_error, ok ? "" : "FAILED");
+    return ok;
+}
+
+
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+int main()
+{
+    // the boundary of Loop surfaces converges more slowly
+    bool ok = true;
+    ok &= check("Loop, flat",           Subdivider::LOOP,          false, 0.0, 7, 1e-4);
+    ok &= check("Loop, curved",         Subdivider::LOOP,          false, 0.3, 7, 1e-2);
+    ok &= check("Catmull-Clark, flat",   Subdivider::CATMULL_CLARK, true,  0.0, 7, 1e-4);
+    ok &= check("Catmull-Clark, curved", Subdivider::CATMULL_CLARK, true,  0.3, 7, 1e-3);
+
+    return ok ? 0 : 1;
+}
+
+
+//=============================================================================
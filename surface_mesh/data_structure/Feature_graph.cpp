@@ -0,0 +1,131 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Feature_graph.h>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+void
+Feature_graph::
+clear()
+{
+    first_.clear();
+    last_.clear();
+    ridge_.clear();
+    points_.clear();
+    vertices_.clear();
+    faces_.clear();
+    face_line_.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_graph::
+build(const Surface_mesh& mesh)
+{
+    clear();
+
+    Surface_mesh::FeatureVertex_property<Point> fpoints =
+        mesh.get_feature_v_property<Point>("f:point");
+
+    const unsigned int nl = mesh.flines_size();
+    first_.resize(nl);
+    last_.resize(nl);
+    ridge_.resize(nl, 0);
+    face_line_.assign(mesh.faces_size(), -1);
+
+    // points per line, bounded against broken chains
+    const unsigned int max_points = mesh.fhalfedges_size() + 1;
+
+    std::vector<Surface_mesh::FeatureVertex> vertices;
+    std::vector<Surface_mesh::Face>          faces;
+
+    for (unsigned int i=0; i<nl; ++i)
+    {
+        Surface_mesh::FeatureLine l(i);
+
+        vertices.clear();
+        faces.clear();
+
+        Surface_mesh::FeatureHalfedge h = mesh.halfedge(l);
+        if (fpoints && !mesh.is_deleted(l) && h.is_valid())
+        {
+            Surface_mesh::FeatureVertex tail = mesh.tail(l);
+
+            vertices.push_back(mesh.from_vertex(h));
+            while (vertices.size() < max_points)
+            {
+                vertices.push_back(mesh.to_vertex(h));
+                faces.push_back(mesh.face(h));
+                if (mesh.to_vertex(h) == tail) break;
+                h = mesh.next_halfedge(h);
+            }
+            ridge_[i] = mesh.is_ridge(l);
+        }
+
+        const unsigned int n = vertices.size();
+        const unsigned int k = allocate(n);
+
+        first_[i] = k;
+        last_[i]  = k + n;
+
+        for (unsigned int j=0; j<n; ++j)
+        {
+            points_[k+j]   = fpoints[vertices[j]];
+            vertices_[k+j] = vertices[j];
+        }
+        for (unsigned int j=0; j+1<n; ++j)
+        {
+            faces_[k+j] = faces[j];
+            set_face_line(faces[j], i);
+        }
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+Feature_graph::
+allocate(unsigned int n)
+{
+    const unsigned int k = points_.size();
+    const unsigned int m = points_.size() + n;
+
+    points_.resize(m);
+    vertices_.resize(m);
+    faces_.resize(m);
+
+    return k;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_graph::
+set_face_line(Surface_mesh::Face f, unsigned int i)
+{
+    if (!f.is_valid()) return;
+    if (f.idx() >= (int)face_line_.size())
+        face_line_.resize(f.idx()+1, -1);
+    face_line_[f.idx()] = i;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
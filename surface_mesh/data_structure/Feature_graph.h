@@ -0,0 +1,124 @@
+//=============================================================================
+
+#ifndef GRAPHENE_FEATURE_GRAPH_H
+#define GRAPHENE_FEATURE_GRAPH_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Compact copy of the feature lines of a Surface_mesh.
+///
+/// The points of each line are stored head to tail as one contiguous run in
+/// shared arrays, addressed by per-line offsets, so walking a line or all
+/// lines is a linear scan instead of following the feature halfedges. The
+/// graph is a snapshot: rebuild it after the feature lines change.
+///
+/// Lines keep the index of their Surface_mesh::FeatureLine, deleted lines
+/// have empty runs. A face-to-line index gives the line crossing a face.
+class Feature_graph
+{
+public:
+
+    /// empty graph
+    Feature_graph() {}
+
+    /// graph of the feature lines of mesh
+    explicit Feature_graph(const Surface_mesh& mesh) { build(mesh); }
+
+    /// rebuild from the feature lines of mesh
+    void build(const Surface_mesh& mesh);
+
+    /// remove all lines
+    void clear();
+
+
+    /// number of lines, including the empty runs of deleted lines
+    unsigned int n_lines() const { return first_.size(); }
+
+    /// number of points of line l
+    unsigned int size(Surface_mesh::FeatureLine l) const
+    {
+        return last_[l.idx()] - first_[l.idx()];
+    }
+
+    /// whether line l is a ridge (or a ravine)
+    bool is_ridge(Surface_mesh::FeatureLine l) const { return ridge_[l.idx()] != 0; }
+
+    /// the points of line l, head first, size(l) of them
+    const Point* points(Surface_mesh::FeatureLine l) const
+    {
+        return points_.data() + first_[l.idx()];
+    }
+
+    /// point i of line l, 0 is the head
+    const Point& point(Surface_mesh::FeatureLine l, unsigned int i) const
+    {
+        return points_[first_[l.idx()] + i];
+    }
+
+    /// feature vertex of point i of line l
+    Surface_mesh::FeatureVertex vertex(Surface_mesh::FeatureLine l, unsigned int i) const
+    {
+        return vertices_[first_[l.idx()] + i];
+    }
+
+    /// face of the segment from point i to point i+1 of line l
+    Surface_mesh::Face face(Surface_mesh::FeatureLine l, unsigned int i) const
+    {
+        return faces_[first_[l.idx()] + i];
+    }
+
+    /// the line crossing face f, the one added last if there are several.
+    /// invalid if no line crosses f.
+    Surface_mesh::FeatureLine line(Surface_mesh::Face f) const
+    {
+        return (f.is_valid() && f.idx() < (int)face_line_.size()) ?
+            Surface_mesh::FeatureLine(face_line_[f.idx()]) :
+            Surface_mesh::FeatureLine();
+    }
+
+
+private:
+
+    // append a run of n points, returns its first point
+    unsigned int allocate(unsigned int n);
+
+    // record that line i crosses face f
+    void set_face_line(Surface_mesh::Face f, unsigned int i);
+
+
+private:
+
+    // line i uses the points [first_[i], last_[i])
+    std::vector<unsigned int>  first_, last_;
+    std::vector<char>          ridge_;
+
+    // per point; faces_[k] is the face of the segment from point k to k+1
+    std::vector<Point>                        points_;
+    std::vector<Surface_mesh::FeatureVertex>  vertices_;
+    std::vector<Surface_mesh::Face>           faces_;
+
+    // line index per face, -1 if none
+    std::vector<int>  face_line_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_FEATURE_GRAPH_H
+//=============================================================================
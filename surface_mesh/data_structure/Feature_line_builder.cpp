@@ -0,0 +1,276 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Feature_line_builder.h>
+
+#include <cassert>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+unsigned int
+Feature_line_builder::
+add_line(const std::vector<Point>& points, const std::vector<int>& face_id,
+         Scalar length, bool is_ridge, bool closed)
+{
+    Line line;
+    line.first_point = points_.size();
+    line.n_points    = points.size();
+    line.first_edge  = faces_.size();
+    line.length      = length;
+    line.ridge       = is_ridge;
+    line.closed      = closed;
+    lines_.push_back(line);
+
+    assert(line.n_points >= (closed ? 3 : 2));
+    assert(face_id.size() >= n_segments(lines_.size()-1));
+
+    points_.insert(points_.end(), points.begin(), points.end());
+    faces_.insert(faces_.end(), face_id.begin(), face_id.begin() + n_segments(lines_.size()-1));
+
+    return lines_.size() - 1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+insert_head(Surface_mesh::FeatureLine l, const Point& p, int face_id,
+            Surface_mesh::Vertex v)
+{
+    Extension e;
+    e.line   = l;
+    e.vertex = v;
+    e.point  = p;
+    e.face   = face_id;
+    e.head   = true;
+    extensions_.push_back(e);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+insert_tail(Surface_mesh::FeatureLine l, const Point& p, int face_id,
+            Surface_mesh::Vertex v)
+{
+    Extension e;
+    e.line   = l;
+    e.vertex = v;
+    e.point  = p;
+    e.face   = face_id;
+    e.head   = false;
+    extensions_.push_back(e);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+clear()
+{
+    lines_.clear();
+    points_.clear();
+    faces_.clear();
+    extensions_.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+commit(Surface_mesh& mesh)
+{
+    Feature_line_builder* self = this;
+    commit(mesh, &self, 1);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+commit(Surface_mesh& mesh, std::vector<Feature_line_builder>& builders)
+{
+    std::vector<Feature_line_builder*> pointers(builders.size());
+    for (unsigned int i=0; i<builders.size(); ++i)
+        pointers[i] = &builders[i];
+
+    if (!pointers.empty())
+        commit(mesh, pointers.data(), pointers.size());
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+commit(Surface_mesh& mesh, Feature_line_builder* const* builders, unsigned int n)
+{
+    typedef Surface_mesh::FeatureVertex    FeatureVertex;
+    typedef Surface_mesh::FeatureHalfedge  FeatureHalfedge;
+    typedef Surface_mesh::FeatureLine      FeatureLine;
+
+
+    // handle ranges: per builder its lines, then its extensions
+    std::vector<int> vbase(n), ebase(n), lbase(n);
+    int nv = mesh.fvertices_size();
+    int ne = mesh.fedges_size();
+    int nl = mesh.flines_size();
+
+    for (unsigned int b=0; b<n; ++b)
+    {
+        const Feature_line_builder& builder = *builders[b];
+        vbase[b] = nv;
+        ebase[b] = ne;
+        lbase[b] = nl;
+        nv += builder.points_.size()  + builder.extensions_.size();
+        ne += builder.faces_.size()   + builder.extensions_.size();
+        nl += builder.lines_.size();
+    }
+
+    mesh.resize_features(nv, ne, nl);
+
+
+    // new lines, independent of each other
+    for (unsigned int b=0; b<n; ++b)
+    {
+        const Feature_line_builder& builder = *builders[b];
+        const int                   lines   = builder.lines_.size();
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i=0; i<lines; ++i)
+        {
+            const Line& line = builder.lines_[i];
+            builder.build_line(mesh, i, vbase[b] + line.first_point,
+                               ebase[b] + line.first_edge, lbase[b] + i);
+        }
+    }
+
+
+    // extensions, in order since several may extend the same line
+    for (unsigned int b=0; b<n; ++b)
+    {
+        const Feature_line_builder& builder = *builders[b];
+        int v = vbase[b] + builder.points_.size();
+        int e = ebase[b] + builder.faces_.size();
+
+        for (unsigned int i=0; i<builder.extensions_.size(); ++i, ++v, ++e)
+        {
+            const Extension&    ext = builder.extensions_[i];
+            const FeatureLine   l   = ext.line;
+            const FeatureVertex fv(v);
+            const FeatureHalfedge h0(2*e), h1(2*e+1);
+
+            mesh.exchange_feature_vertex(fv, ext.point);
+
+            // as Surface_mesh::insert_head_vertex() and insert_tail_vertex()
+            if (ext.head)
+            {
+                const FeatureVertex   vhead      = mesh.head(l);
+                const FeatureHalfedge inner_next = mesh.halfedge(l);
+
+                mesh.set_feature_v(h0, vhead);
+                mesh.set_feature_v(h1, fv);
+                mesh.set_next_halfedge(h0, inner_next);
+                mesh.set_next_halfedge(mesh.opposite_halfedge(inner_next), h1);
+                mesh.set_halfedge(fv, h0);
+                mesh.set_line_head(l, h0, fv);
+            }
+            else
+            {
+                const FeatureVertex   vtail      = mesh.tail(l);
+                const FeatureHalfedge inner_prev = mesh.tail_halfedge(l);
+
+                mesh.set_feature_v(h0, fv);
+                mesh.set_feature_v(h1, vtail);
+                mesh.set_next_halfedge(inner_prev, h0);
+                mesh.set_next_halfedge(h1, mesh.opposite_halfedge(inner_prev));
+                mesh.set_halfedge(fv, h0);
+                mesh.set_line_tail(l, fv);
+            }
+
+            mesh.set_line(h0, l, ext.face);
+            mesh.set_line_num(l, mesh.get_line_num(l) + 1);
+            if (ext.vertex.is_valid())
+                mesh.update_featureLine(l, ext.vertex, ext.head);
+        }
+    }
+
+
+    for (unsigned int b=0; b<n; ++b)
+    {
+        builders[b]->committed_   = lbase[b];
+        builders[b]->n_committed_ = builders[b]->lines_.size();
+        builders[b]->clear();
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Feature_line_builder::
+build_line(Surface_mesh& mesh, unsigned int i, int vertex, int edge, int line) const
+{
+    typedef Surface_mesh::FeatureVertex    FeatureVertex;
+    typedef Surface_mesh::FeatureHalfedge  FeatureHalfedge;
+
+    const Line&          ln = lines_[i];
+    const unsigned int   n  = ln.n_points;
+    const unsigned int   ns = n_segments(i);
+    const Surface_mesh::FeatureLine l(line);
+
+    for (unsigned int j=0; j<n; ++j)
+        mesh.exchange_feature_vertex(FeatureVertex(vertex + j), points_[ln.first_point + j]);
+
+    // segment j from vertex j to vertex j+1, the last one of a closed line
+    // back to vertex 0
+    for (unsigned int j=0; j<ns; ++j)
+    {
+        const FeatureHalfedge h(2 * (edge + j));
+        mesh.set_feature_v(h, FeatureVertex(vertex + (j+1) % n));
+        mesh.set_feature_v(mesh.opposite_halfedge(h), FeatureVertex(vertex + j));
+        mesh.set_line(h, l, faces_[ln.first_edge + j]);
+    }
+
+    // links and vertex halfedges as in Surface_mesh::add_feature_line()
+    for (unsigned int j=0; j+1<ns; ++j)
+    {
+        const FeatureHalfedge h(2 * (edge + j)), hn(2 * (edge + j + 1));
+        mesh.set_next_halfedge(h, hn);
+        mesh.set_next_halfedge(mesh.opposite_halfedge(hn), mesh.opposite_halfedge(h));
+    }
+    for (unsigned int j=1; j<=ns; ++j)
+        mesh.set_halfedge(FeatureVertex(vertex + j % n), FeatureHalfedge(2 * (edge + j - 1)));
+    if (!ln.closed)
+        mesh.set_halfedge(FeatureVertex(vertex), FeatureHalfedge(2 * edge));
+
+    const FeatureVertex tail(ln.closed ? vertex : vertex + n - 1);
+    mesh.set_lineporp(l, FeatureHalfedge(2 * edge), FeatureVertex(vertex), tail,
+                      ln.length, ln.ridge);
+    mesh.set_line_num(l, ns);
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,144 @@
+//=============================================================================
+
+#ifndef GRAPHENE_FEATURE_LINE_BUILDER_H
+#define GRAPHENE_FEATURE_LINE_BUILDER_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Buffer of feature lines to be added to a Surface_mesh.
+///
+/// add_feature_line(), insert_head_vertex() and insert_tail_vertex() of
+/// Surface_mesh allocate feature vertices and halfedges one by one, so only
+/// one thread can create lines. A builder collects new lines and extensions
+/// of existing lines without touching the mesh, one builder per thread.
+/// commit() then allocates the elements of all builders at once and sets up
+/// the new lines in parallel, each on its own range of handles. Committed
+/// lines are ordered by builder, then by the order they were added in.
+///
+/// \code
+/// std::vector<Feature_line_builder> builders(n_threads);
+/// #pragma omp parallel for
+/// for (int i=0; i<n_regions; ++i)
+///     extract(region[i], builders[omp_get_thread_num()]);
+/// Feature_line_builder::commit(mesh, builders);
+/// \endcode
+class Feature_line_builder
+{
+public:
+
+    /// empty builder
+    Feature_line_builder() : committed_(0), n_committed_(0) {}
+
+
+    /// add a line through points, segment i lies in face face_id[i] (-1 for
+    /// none). a closed line returns from its last point to the first one,
+    /// with one more segment. returns the index of the line in this builder.
+    unsigned int add_line(const std::vector<Point>& points,
+                          const std::vector<int>& face_id,
+                          Scalar length, bool is_ridge = true,
+                          bool closed = false);
+
+    /// add point p before the head of the existing line l, the new segment
+    /// lies in face face_id. a valid v becomes the mesh vertex of the head,
+    /// as Surface_mesh::update_featureLine().
+    void insert_head(Surface_mesh::FeatureLine l, const Point& p, int face_id,
+                     Surface_mesh::Vertex v = Surface_mesh::Vertex());
+
+    /// add point p after the tail of the existing line l, the new segment
+    /// lies in face face_id. a valid v becomes the mesh vertex of the tail.
+    void insert_tail(Surface_mesh::FeatureLine l, const Point& p, int face_id,
+                     Surface_mesh::Vertex v = Surface_mesh::Vertex());
+
+    /// number of buffered new lines
+    unsigned int n_lines() const { return lines_.size(); }
+
+    /// whether nothing is buffered
+    bool empty() const { return lines_.empty() && extensions_.empty(); }
+
+    /// drop the buffered lines and extensions
+    void clear();
+
+
+    /// add the buffered lines to mesh and apply the extensions, then clear
+    void commit(Surface_mesh& mesh);
+
+    /// commit all builders in one batch, in their order
+    static void commit(Surface_mesh& mesh, std::vector<Feature_line_builder>& builders);
+
+    /// the mesh line of line i of the last commit
+    Surface_mesh::FeatureLine line(unsigned int i) const
+    {
+        return (i < n_committed_) ? Surface_mesh::FeatureLine(committed_ + i)
+                                  : Surface_mesh::FeatureLine();
+    }
+
+
+private:
+
+    // commit n builders
+    static void commit(Surface_mesh& mesh, Feature_line_builder* const* builders,
+                       unsigned int n);
+
+    // number of segments of line i
+    unsigned int n_segments(unsigned int i) const
+    {
+        return lines_[i].closed ? lines_[i].n_points : lines_[i].n_points - 1;
+    }
+
+    // set up line i, its vertices, halfedges and line start at the given
+    // handles
+    void build_line(Surface_mesh& mesh, unsigned int i, int vertex, int edge,
+                    int line) const;
+
+
+private:
+
+    struct Line
+    {
+        unsigned int  first_point;
+        unsigned int  n_points;
+        unsigned int  first_edge;
+        Scalar        length;
+        bool          ridge;
+        bool          closed;
+    };
+
+    struct Extension
+    {
+        Surface_mesh::FeatureLine  line;
+        Surface_mesh::Vertex       vertex;
+        Point                      point;
+        int                        face;
+        bool                       head;
+    };
+
+    std::vector<Line>       lines_;
+    std::vector<Point>      points_;
+    std::vector<int>        faces_;   // per segment, indexed by Line::first_edge
+    std::vector<Extension>  extensions_;
+
+    // lines of the last commit
+    unsigned int  committed_, n_committed_;
+};
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_FEATURE_LINE_BUILDER_H
+//=============================================================================
@@ -0,0 +1,191 @@
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Segment_boundaries.h>
+
+#include <algorithm>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== IMPLEMENTATION ==========================================================
+
+
+namespace {
+
+
+// whether h runs along the boundary of the patch of its face
+bool is_patch_boundary(const Surface_mesh& mesh,
+                       const Surface_mesh::Face_property<int>& labels,
+                       Surface_mesh::Halfedge h)
+{
+    const Surface_mesh::Face f0 = mesh.face(h);
+    const Surface_mesh::Face f1 = mesh.face(mesh.opposite_halfedge(h));
+    return f0.is_valid() && (!f1.is_valid() || labels[f0] != labels[f1]);
+}
+
+
+// the boundary halfedge of the same patch after h, found by rotating
+// around the to-vertex of h through the faces of the patch
+Surface_mesh::Halfedge next_boundary(const Surface_mesh& mesh,
+                                     const Surface_mesh::Face_property<int>& labels,
+                                     Surface_mesh::Halfedge h)
+{
+    Surface_mesh::Halfedge g = mesh.next_halfedge(h);
+    for (unsigned int i=0; i<mesh.halfedges_size(); ++i)
+    {
+        if (is_patch_boundary(mesh, labels, g))
+            return g;
+        g = mesh.next_halfedge(mesh.opposite_halfedge(g));
+    }
+    return Surface_mesh::Halfedge();
+}
+
+
+// vertices, valences and loops of segmentation from its boundary edges and
+// the halfedges along the mesh boundary
+void collect(const Surface_mesh& mesh,
+             const Surface_mesh::Face_property<int>& labels,
+             const std::vector<Surface_mesh::Halfedge>& border,
+             Segment_boundaries& result)
+{
+    // vertices in the order they are met
+    std::vector<unsigned int> valence(mesh.vertices_size(), 0);
+    for (unsigned int i=0; i<result.edges.size(); ++i)
+    {
+        for (int j=0; j<2; ++j)
+        {
+            const Surface_mesh::Vertex v = mesh.vertex(result.edges[i], j);
+            if (valence[v.idx()]++ == 0)
+                result.vertices.push_back(v);
+        }
+    }
+    result.valences.resize(result.vertices.size());
+    for (unsigned int i=0; i<result.vertices.size(); ++i)
+        result.valences[i] = valence[result.vertices[i].idx()];
+
+
+    // loops, started from every patch side of a boundary edge and from the
+    // mesh boundary
+    std::vector<char>                    visited(mesh.halfedges_size(), 0);
+    std::vector<Surface_mesh::Halfedge>  starts;
+    starts.reserve(2 * result.edges.size() + border.size());
+    for (unsigned int i=0; i<result.edges.size(); ++i)
+    {
+        starts.push_back(mesh.halfedge(result.edges[i], 0));
+        starts.push_back(mesh.halfedge(result.edges[i], 1));
+    }
+    starts.insert(starts.end(), border.begin(), border.end());
+
+    result.loop_start.assign(1, 0);
+    for (unsigned int i=0; i<starts.size(); ++i)
+    {
+        const Surface_mesh::Halfedge start = starts[i];
+        if (visited[start.idx()]) continue;
+
+        Surface_mesh::Halfedge h = start;
+        do
+        {
+            visited[h.idx()] = 1;
+            result.loop_halfedges.push_back(h);
+            h = next_boundary(mesh, labels, h);
+        }
+        while (h.is_valid() && h != start && !visited[h.idx()]);
+
+        result.loop_start.push_back(result.loop_halfedges.size());
+        result.loop_label.push_back(labels[mesh.face(start)]);
+    }
+}
+
+
+} // anonymous namespace
+
+
+//-----------------------------------------------------------------------------
+
+
+Segment_boundaries
+segment_boundaries(const Surface_mesh& mesh,
+                   const Surface_mesh::Face_property<int>& labels)
+{
+    std::vector< Surface_mesh::Face_property<int> > all(1, labels);
+    return segment_boundaries(mesh, all)[0];
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+std::vector<Segment_boundaries>
+segment_boundaries(const Surface_mesh& mesh,
+                   const std::vector< Surface_mesh::Face_property<int> >& labels)
+{
+    const int ns = labels.size();
+    const int ne = mesh.edges_size();
+
+    std::vector<Segment_boundaries> results(ns);
+    if (ns == 0) return results;
+
+
+    // one pass over the edges for all segmentations, in blocks that collect
+    // their edges, concatenated in order afterwards
+    const int nb = std::max(1, std::min(256, ne / 4096));
+    std::vector< std::vector<Surface_mesh::Edge> >      edges(nb * ns);
+    std::vector< std::vector<Surface_mesh::Halfedge> >  border(nb);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int b=0; b<nb; ++b)
+    {
+        const int begin = (long long)ne * b / nb;
+        const int end   = (long long)ne * (b+1) / nb;
+
+        for (int i=begin; i<end; ++i)
+        {
+            const Surface_mesh::Edge e(i);
+            if (mesh.is_deleted(e)) continue;
+
+            const Surface_mesh::Halfedge h0 = mesh.halfedge(e, 0);
+            const Surface_mesh::Halfedge h1 = mesh.halfedge(e, 1);
+            const Surface_mesh::Face     f0 = mesh.face(h0);
+            const Surface_mesh::Face     f1 = mesh.face(h1);
+
+            if (f0.is_valid() && f1.is_valid())
+            {
+                for (int s=0; s<ns; ++s)
+                    if (labels[s][f0] != labels[s][f1])
+                        edges[b*ns + s].push_back(e);
+            }
+            else if (f0.is_valid() || f1.is_valid())
+            {
+                border[b].push_back(f0.is_valid() ? h0 : h1);
+            }
+        }
+    }
+
+    std::vector<Surface_mesh::Halfedge> all_border;
+    for (int b=0; b<nb; ++b)
+        all_border.insert(all_border.end(), border[b].begin(), border[b].end());
+
+
+    // vertices and loops, per segmentation
+#pragma omp parallel for schedule(dynamic)
+    for (int s=0; s<ns; ++s)
+    {
+        Segment_boundaries& result = results[s];
+        for (int b=0; b<nb; ++b)
+            result.edges.insert(result.edges.end(), edges[b*ns + s].begin(), edges[b*ns + s].end());
+
+        collect(mesh, labels[s], all_border, result);
+    }
+
+    return results;
+}
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
@@ -0,0 +1,66 @@
+//=============================================================================
+
+#ifndef GRAPHENE_SEGMENT_BOUNDARIES_H
+#define GRAPHENE_SEGMENT_BOUNDARIES_H
+
+
+//== INCLUDES =================================================================
+
+#include <graphene/surface_mesh/data_structure/Surface_mesh.h>
+#include <vector>
+
+
+//== NAMESPACE ================================================================
+
+namespace graphene {
+namespace surface_mesh {
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Boundaries between the patches of a face segmentation, in compact arrays.
+struct Segment_boundaries
+{
+    /// interior edges whose two faces have different labels
+    std::vector<Surface_mesh::Edge>      edges;
+
+    /// the vertices of these edges, each once
+    std::vector<Surface_mesh::Vertex>    vertices;
+
+    /// number of boundary edges at vertices[i]
+    std::vector<unsigned int>            valences;
+
+    /// boundary loops of the patches. loop i consists of the halfedges
+    /// [loop_start[i], loop_start[i+1]) of loop_halfedges, each with a face
+    /// of the patch on its left; it runs along the mesh boundary where the
+    /// patch does. loop_start has one entry more than there are loops.
+    std::vector<Surface_mesh::Halfedge>  loop_halfedges;
+    std::vector<unsigned int>            loop_start;
+
+    /// label of the patch of each loop
+    std::vector<int>                     loop_label;
+
+    /// number of loops
+    unsigned int n_loops() const { return loop_label.size(); }
+};
+
+
+/// boundaries of the segmentation given by the face labels, found in a
+/// parallel pass over the edges
+Segment_boundaries segment_boundaries(const Surface_mesh& mesh,
+                                      const Surface_mesh::Face_property<int>& labels);
+
+/// boundaries of several segmentations of the same mesh, all found in the
+/// same pass over the edges. result i belongs to labels[i].
+std::vector<Segment_boundaries>
+segment_boundaries(const Surface_mesh& mesh,
+                   const std::vector< Surface_mesh::Face_property<int> >& labels);
+
+
+//=============================================================================
+} // namespace surface_mesh
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_SEGMENT_BOUNDARIES_H
+//=============================================================================
@@ -21,6 +21,7 @@
 
 #include "Surface_mesh.h"
 #include "IO.h"
+#include <atomic>
 #include <cmath>
 #include <stdio.h>
 
@@ -35,6 +36,16 @@ namespace graphene {
 		//== IMPLEMENTATION ===========================================================
 
 
+		namespace
+		{
+			// last revision handed out, over all meshes
+			std::atomic<unsigned int> last_revision(0);
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
 		Surface_mesh::
 			Surface_mesh()
 		{
@@ -61,6 +72,7 @@ namespace graphene {
 
 			deleted_vertices_ = deleted_edges_ = deleted_faces_ = deleted_feature_edges_ = deleted_feature_vertices_ = deleted_lines_ = 0;
 			garbage_ = false;
+			geometry_changed();
 		}
 
 
@@ -92,6 +104,7 @@ namespace graphene {
 				fhprops_ = rhs.fhprops_;
 				feprops_ = rhs.feprops_;
 				lprops_ = rhs.lprops_;
+				epprops_ = rhs.epprops_;
 				// property handles contain pointers, have to be reassigned
 				vconn_ = vertex_property<Vertex_connectivity>("v:connectivity");
 				hconn_ = halfedge_property<Halfedge_connectivity>("h:connectivity");
@@ -101,9 +114,16 @@ namespace graphene {
 				fdeleted_ = face_property<bool>("f:deleted");
 				vpoint_ = vertex_property<Point>("v:point");
 				//feature
-				fpoint_ = feature_v_property<Point>("v:feature point");
+				fpoint_ = feature_v_property<Point>("f:point");
 				fvconn_ = feature_v_property<FeatureVertex_connectivity>("v:feature connectivity");
 				fhconn_ = feature_h_property<FeatureHalfedge_connectivity>("h:feature connectivity");
+				flconn_ = line_property<FeatureLine_connectivity>("l:feature connectivity");
+				epconn_ = endpoint_property<EndPoint_connectivity>("v:end point connectivity");
+				ldeleted_ = line_property<bool>("l:deleted");
+				lvisual_ = line_property<bool>("l:is visual");
+				fvdeleted_ = feature_v_property<bool>("fv:deleted");
+				fedeleted_ = feature_e_property<bool>("fe:deleted");
+				epdeleted_ = endpoint_property<bool>("ep:deleted");
 				// normals might be there, therefore use get_property
 				vnormal_ = get_vertex_property<Point>("v:normal");
 				fnormal_ = get_face_property<Point>("f:normal");
@@ -116,8 +136,11 @@ namespace graphene {
 				deleted_feature_edges_ = rhs.deleted_feature_edges_;
 				deleted_feature_vertices_ = rhs.deleted_feature_vertices_;
 				deleted_lines_ = rhs.deleted_lines_;
+				deleted_end_point_ = rhs.deleted_end_point_;
 
 				garbage_ = rhs.garbage_;
+				revision_ = rhs.revision_;
+				cache_revisions_ = rhs.cache_revisions_;
 			}
 
 			return *this;
@@ -184,6 +207,8 @@ namespace graphene {
 				deleted_edges_ = rhs.deleted_edges_;
 				deleted_faces_ = rhs.deleted_faces_;
 				garbage_ = rhs.garbage_;
+				revision_ = rhs.revision_;
+				cache_revisions_.clear();
 			}
 
 			return *this;
@@ -251,6 +276,19 @@ namespace graphene {
 
 			deleted_vertices_ = deleted_edges_ = deleted_faces_ = deleted_feature_edges_ = deleted_feature_vertices_ = deleted_lines_ = deleted_end_point_ = 0;
 			garbage_ = false;
+			cache_revisions_.clear();
+			geometry_changed();
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Surface_mesh::
+			geometry_changed()
+		{
+			revision_ = ++last_revision;
 		}
 
 
@@ -289,6 +327,18 @@ namespace graphene {
 			fprops_.reserve(nfaces);
 		}
 
+		void
+			Surface_mesh::
+			resize(unsigned int nvertices,
+				unsigned int nedges,
+				unsigned int nfaces)
+		{
+			vprops_.resize(nvertices);
+			hprops_.resize(2 * nedges);
+			eprops_.resize(nedges);
+			fprops_.resize(nfaces);
+		}
+
 		void
 			Surface_mesh::
 			reserve(unsigned int nvertices,
@@ -299,6 +349,18 @@ namespace graphene {
 			feprops_.reserve(nedges);
 		}
 
+		void
+			Surface_mesh::
+			resize_features(unsigned int nvertices,
+				unsigned int nedges,
+				unsigned int nlines)
+		{
+			fvprops_.resize(nvertices);
+			fhprops_.resize(2 * nedges);
+			feprops_.resize(nedges);
+			lprops_.resize(nlines);
+		}
+
 
 		//-----------------------------------------------------------------------------
 
@@ -688,6 +750,79 @@ namespace graphene {
 			return inner_next;
 		}
 
+		//-----------------------------------------------------------------------------
+		void
+			Surface_mesh::
+			set_feature_line(FeatureLine l, const std::vector<Point>& points,
+			                 const std::vector<int>& face_id, Scalar length)
+		{
+			const unsigned int n(points.size());
+			assert(n >= 2 && face_id.size() + 1 >= n);
+
+			// the current chain, bounded against broken links
+			std::vector<FeatureVertex>    vertices;
+			std::vector<FeatureHalfedge>  halfedges;
+			FeatureHalfedge h = halfedge(l);
+			const FeatureVertex vtail = tail(l);
+			vertices.push_back(from_vertex(h));
+			while (halfedges.size() < fhalfedges_size())
+			{
+				halfedges.push_back(h);
+				vertices.push_back(to_vertex(h));
+				if (to_vertex(h) == vtail) break;
+				h = next_halfedge(h);
+			}
+			const unsigned int m(vertices.size());
+
+			// vertex handles: head and tail kept, inner ones reused in order
+			std::vector<FeatureVertex> w(n);
+			w[0]   = vertices[0];
+			w[n-1] = vertices[m-1];
+			for (unsigned int i = 1; i + 1 < n; ++i)
+				w[i] = (i + 1 < m) ? vertices[i] : new_feature_v();
+			for (unsigned int i = n - 1; i + 1 < m; ++i)
+			{
+				fvdeleted_[vertices[i]] = true;
+				++deleted_feature_vertices_;
+				garbage_ = true;
+			}
+			for (unsigned int i = 0; i < n; ++i)
+				fpoint_[w[i]] = points[i];
+
+			// halfedges reused in order
+			std::vector<FeatureHalfedge> g(n - 1);
+			for (unsigned int i = 0; i + 1 < n; ++i)
+			{
+				g[i] = (i < halfedges.size()) ? halfedges[i] : new_feature_edge(w[i], w[i+1]);
+				set_feature_v(g[i], w[i+1]);
+				set_feature_v(opposite_halfedge(g[i]), w[i]);
+				set_line(g[i], l, face_id[i]);
+			}
+			for (unsigned int i = n - 1; i < halfedges.size(); ++i)
+			{
+				fedeleted_[edge(halfedges[i])] = true;
+				++deleted_feature_edges_;
+				garbage_ = true;
+			}
+
+			// links, as add_feature_line() and insert_head_vertex()
+			for (unsigned int i = 0; i + 2 < n; ++i)
+			{
+				set_next_halfedge(g[i], g[i+1]);
+				set_next_halfedge(opposite_halfedge(g[i+1]), opposite_halfedge(g[i]));
+			}
+			fhconn_[g[n-2]].next_halfedge_ = FeatureHalfedge();
+			fhconn_[opposite_halfedge(g[0])].next_halfedge_ = FeatureHalfedge();
+			for (unsigned int i = 1; i < n; ++i)
+				set_halfedge(w[i], g[i-1]);
+			set_halfedge(w[0], g[0]);
+
+			set_line_head(l, g[0], w[0]);
+			set_line_tail(l, w[n-1]);
+			set_line_num(l, n - 1);
+			flconn_[l].length_ = length;
+		}
+
 
 	
 
@@ -972,6 +1107,8 @@ namespace graphene {
 			Face_iterator fit = faces_begin(), fend = faces_end();
 			for (; fit != fend; ++fit)
 				triangulate(*fit);
+
+			geometry_changed();
 		}
 
 
@@ -1227,14 +1364,35 @@ namespace graphene {
 		void
 			Surface_mesh::
 			split(Edge e, Vertex v)
+		{
+			// allocate the new elements, then connect them
+			unsigned int ne = 1, nf = 0;
+			if (!is_boundary(halfedge(e, 0))) { ++ne; ++nf; }
+			if (!is_boundary(halfedge(e, 1))) { ++ne; ++nf; }
+
+			Edge enew(edges_size());
+			Face fnew(faces_size());
+			allocate(0, ne, nf);
+
+			split(e, v, enew, fnew);
+		}
+
+
+		//------------------------------------------------------------------------------
+		void
+			Surface_mesh::
+			split(Edge e, Vertex v, Edge enew, Face fnew)
 		{
 			Halfedge h0 = halfedge(e, 0);
 			Halfedge o0 = halfedge(e, 1);
 
 			Vertex   v2 = to_vertex(o0);
 
-			Halfedge e1 = new_edge(v, v2);
+			Halfedge e1 = halfedge(enew, 0);
 			Halfedge t1 = opposite_halfedge(e1);
+			set_vertex(e1, v2);
+			set_vertex(t1, v);
+			enew = Edge(enew.idx() + 1);
 
 			Face     f0 = face(h0);
 			Face     f3 = face(o0);
@@ -1249,10 +1407,14 @@ namespace graphene {
 
 				Vertex   v1 = to_vertex(h1);
 
-				Halfedge e0 = new_edge(v, v1);
+				Halfedge e0 = halfedge(enew, 0);
 				Halfedge t0 = opposite_halfedge(e0);
+				set_vertex(e0, v1);
+				set_vertex(t0, v);
+				enew = Edge(enew.idx() + 1);
 
-				Face f1 = new_face();
+				Face f1 = fnew;
+				fnew = Face(fnew.idx() + 1);
 				set_halfedge(f0, h0);
 				set_halfedge(f1, h2);
 
@@ -1287,10 +1449,12 @@ namespace graphene {
 
 				Vertex v3 = to_vertex(o1);
 
-				Halfedge e2 = new_edge(v, v3);
+				Halfedge e2 = halfedge(enew, 0);
 				Halfedge t2 = opposite_halfedge(e2);
+				set_vertex(e2, v3);
+				set_vertex(t2, v);
 
-				Face f2 = new_face();
+				Face f2 = fnew;
 				set_halfedge(f2, o1);
 				set_halfedge(f3, o0);
 
@@ -1995,6 +2159,47 @@ namespace graphene {
 			}
 
 
+			// update references of feature lines into the mesh,
+			// references to deleted elements become invalid
+			for (i = 0; i < (int)fhalfedges_size(); ++i)
+			{
+				Face& ff = fhconn_[FeatureHalfedge(i)].face_;
+				if (ff.is_valid())
+				{
+					ff = fmap[ff];
+					if (ff.idx() >= nF) ff = Face();
+				}
+			}
+			for (i = 0; i < (int)flines_size(); ++i)
+			{
+				FeatureLine_connectivity& lc = flconn_[FeatureLine(i)];
+				if (lc.vhead_.is_valid())
+				{
+					lc.vhead_ = vmap[lc.vhead_];
+					if (lc.vhead_.idx() >= nV) lc.vhead_ = Vertex();
+				}
+				if (lc.vtail_.is_valid())
+				{
+					lc.vtail_ = vmap[lc.vtail_];
+					if (lc.vtail_.idx() >= nV) lc.vtail_ = Vertex();
+				}
+			}
+			for (i = 0; i < (int)endpoint_size(); ++i)
+			{
+				EndPoint_connectivity& ec = epconn_[EndPoint(i)];
+				if (ec.mesh_vertex_.is_valid())
+				{
+					ec.mesh_vertex_ = vmap[ec.mesh_vertex_];
+					if (ec.mesh_vertex_.idx() >= nV) ec.mesh_vertex_ = Vertex();
+				}
+				if (ec.f.is_valid())
+				{
+					ec.f = fmap[ec.f];
+					if (ec.f.idx() >= nF) ec.f = Face();
+				}
+			}
+
+
 			// remove handle maps
 			remove_vertex_property(vmap);
 			remove_halfedge_property(hmap);
@@ -2009,6 +2214,7 @@ namespace graphene {
 
 			deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
 			garbage_ = false;
+			geometry_changed();
 		}
 
 		
@@ -28,6 +28,8 @@
 #include <graphene/geometry/Geometry_representation.h>
 #include <graphene/types.h>
 #include <graphene/surface_mesh/data_structure/properties.h>
+#include <map>
+#include <string>
 
 
 //== NAMESPACE ================================================================
@@ -1609,13 +1611,54 @@ public: //--------------------------------------------------- memory management
                  unsigned int nedges,
                  unsigned int nfaces );
 
+    /// resize the vertex, edge and face arrays, new elements are not deleted
+    /// but unconnected. for algorithms that set up the connectivity of a
+    /// whole mesh at once through the low-level functions below.
+    void resize(unsigned int nvertices,
+                unsigned int nedges,
+                unsigned int nfaces );
+
 	/// reserve feature data memory (mainly used in file readers)
 	void reserve(unsigned int nvertices,
 		unsigned int nedges);
 
+	/// resize the feature vertex, edge and line arrays, new elements are not
+	/// deleted but unconnected. for Feature_line_builder, which sets up the
+	/// lines of a batch through the low-level functions below.
+	void resize_features(unsigned int nvertices,
+		unsigned int nedges,
+		unsigned int nlines);
+
     /// remove deleted vertices/edges/faces
     void garbage_collection();
 
+    /// revision of geometry and connectivity, used as key for cached derived
+    /// data. Changed by clear() and garbage_collection(), algorithms that move
+    /// vertices or change connectivity call geometry_changed() when they are
+    /// done. The low-level operations (split(), flip(), collapse(), ...) do
+    /// not, so they can run concurrently on disjoint parts of the mesh.
+    /// Revisions are unique among all meshes, a copy keeps the revision of
+    /// its original until either of them changes.
+    unsigned int revision() const { return revision_; }
+
+    /// mark cached data derived from the geometry as outdated
+    void geometry_changed();
+
+    /// whether the cached data called name was derived from the current
+    /// revision(), see stamp_cache()
+    bool is_cache_current(const std::string& name) const
+    {
+        std::map<std::string, unsigned int>::const_iterator it = cache_revisions_.find(name);
+        return it != cache_revisions_.end() && it->second == revision_;
+    }
+
+    /// record that the cached data called name was derived from the current
+    /// revision(). the stamps are copied with the mesh, as its properties.
+    void stamp_cache(const std::string& name) { cache_revisions_[name] = revision_; }
+
+    /// forget the stamp of the cached data called name
+    void remove_cache_stamp(const std::string& name) { cache_revisions_.erase(name); }
+
 
     /// returns whether vertex \c v is deleted
     /// \sa garbage_collection()
@@ -2008,6 +2051,18 @@ public: //---------------------------------------------- low-level connectivity
 		return epconn_[ev].l;
 	}
 
+	/// mesh vertex of end point \c ev, invalid if not snapped to a vertex
+	Vertex mesh_vertex(EndPoint ev) const
+	{
+		return epconn_[ev].mesh_vertex_;
+	}
+
+	/// mesh face containing end point \c ev
+	Face face(EndPoint ev) const
+	{
+		return epconn_[ev].f;
+	}
+
 	FeatureLine  prefeatureline(FeatureLine l) const
 	{
 		return flconn_[l].parent_;
@@ -2770,6 +2825,26 @@ public: //--------------------------------------------- higher-level operations
      */
     void split(Edge e, Vertex v);
 
+    /** Same as split(Edge, Vertex), but uses elements allocated beforehand
+     through allocate() instead of creating new ones: it consumes the edges
+     \c enew, \c enew+1, ... (one per adjacent triangle plus one) and the faces
+     \c fnew, \c fnew+1, ... (one per adjacent triangle). Splits of edges that
+     do not share a vertex can therefore run concurrently.
+     \sa allocate()
+     */
+    void split(Edge e, Vertex v, Edge enew, Face fnew);
+
+
+    /// append \c nvertices vertices, \c nedges edges and \c nfaces faces at
+    /// once, to be connected later, e.g. by split(Edge, Vertex, Edge, Face)
+    void allocate(unsigned int nvertices, unsigned int nedges, unsigned int nfaces)
+    {
+        vprops_.resize(vertices_size() + nvertices);
+        eprops_.resize(edges_size()    + nedges);
+        hprops_.resize(halfedges_size() + 2*nedges);
+        fprops_.resize(faces_size()    + nfaces);
+    }
+
 
     /** Subdivide the edge \c e = (v0,v1) by splitting it into the two edge
      (v0,p) and (p,v1). Note that this function does not introduce any other
@@ -2805,6 +2880,13 @@ public: //--------------------------------------------- higher-level operations
 
 	FeatureHalfedge insert_tail_vertex(FeatureLine l, FeatureVertex v,int face_id);
 
+	/// replace the points of feature line \c l by \c points, segment i lies in
+	/// face \c face_id[i]. the head and tail vertex keep their handles, the other
+	/// vertices and the halfedges of \c l are reused in order and new ones are
+	/// added as needed. the ones left over are deleted.
+	void set_feature_line(FeatureLine l, const std::vector<Point>& points,
+	                      const std::vector<int>& face_id, Scalar length);
+
     /// insert edge between the to-vertices v0 of h0 and v1 of h1.
     /// returns the new halfedge from v0 to v1.
     /// \attention h0 and h1 have to belong to the same face
@@ -3022,6 +3104,8 @@ private: //------------------------------------------------------- private data
 	unsigned int deleted_lines_;
 	unsigned int deleted_end_point_;
     bool garbage_;
+    unsigned int revision_;
+    std::map<std::string, unsigned int> cache_revisions_;
 
     // helper data for add_face()
     typedef std::pair<Halfedge, Halfedge>  NextCacheEntry;
@@ -0,0 +1,58 @@
+//=============================================================================
+// Copyright (C) Graphics & Geometry Processing Group, Bielefeld University
+//=============================================================================
+#ifndef GRAPHENE_WORKER_THREAD_H
+#define GRAPHENE_WORKER_THREAD_H
+//=============================================================================
+
+
+#include <QThread>
+#include <QCoreApplication>
+#include <functional>
+
+
+//=============================================================================
+
+
+namespace graphene {
+namespace qt {
+
+
+//=============================================================================
+
+
+/// Runs a job outside of the GUI thread, connect to finished() to pick up
+/// the result. The job must not touch widgets or OpenGL.
+class Worker_thread : public QThread
+{
+public:
+
+    Worker_thread(const std::function<void()>& job, QObject* parent=0)
+        : QThread(parent), job_(job)
+    {}
+
+    /// wait for the job to end, handling the events of the calling thread
+    /// meanwhile: a job blocked in a Qt::BlockingQueuedConnection to this
+    /// thread can go on and see that it was cancelled
+    void wait_handling_events()
+    {
+        while (!wait(10))
+            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+
+protected:
+
+    virtual void run() { job_(); }
+
+private:
+
+    std::function<void()> job_;
+};
+
+
+//=============================================================================
+} // namespace qt
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_WORKER_THREAD_H
+//=============================================================================
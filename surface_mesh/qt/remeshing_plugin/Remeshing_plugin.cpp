@@ -2,7 +2,6 @@
 
 #include "Remeshing_plugin.h"
 #include <graphene/surface_mesh/algorithms/remeshing/Remesher.h>
-#include <graphene/utility/Stop_watch.h>
 #include <graphene/macros.h>
 
 #include <sstream>
@@ -23,8 +22,40 @@ namespace qt {
 
 Remeshing_plugin::
 Remeshing_plugin()
+    : worker_(NULL), progress_dialog_(NULL), job_node_(NULL), job_finished_(false)
 {
     name_ = "Remeshing_plugin";
+
+    // called from the worker thread, forward to the GUI thread
+    progress_.set_callback([this](const std::string& stage, float fraction)
+    {
+        QMetaObject::invokeMethod(this, "slot_progress", Qt::QueuedConnection,
+                                  Q_ARG(QString, QString::fromStdString(stage)),
+                                  Q_ARG(float, fraction));
+
+        // smoothing ends an iteration: show the intermediate mesh while the
+        // worker waits, so that the GUI never renders a half-modified mesh
+        if (stage == "smooth" && !progress_.is_cancelled())
+            QMetaObject::invokeMethod(this, "slot_show_intermediate",
+                                      Qt::BlockingQueuedConnection);
+    });
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+Remeshing_plugin::
+~Remeshing_plugin()
+{
+    if (worker_)
+    {
+        // the job may be waiting for slot_show_intermediate(), keep handling
+        // events until it ends, but drop its intermediate and final meshes
+        job_node_ = NULL;
+        progress_.cancel();
+        worker_->wait_handling_events();
+    }
 }
 
 
@@ -79,32 +110,22 @@ slot_uniform_remeshing()
 
     if (node)
     {
-        QApplication::setOverrideCursor(Qt::WaitCursor);
-
         Surface_mesh* mesh = &node->mesh_;
 
         Scalar length = widget_->le_edge_length->text().toFloat();
         int iters     = widget_->sb_uniform_iterations->value();
         bool project  = widget_->cb_uniform_project->isChecked();
+        bool parallel = widget_->cb_uniform_parallel->isChecked();
+        int budget    = widget_->sb_uniform_budget->value();
 
         if (length)
         {
-            utility::Stop_watch timer;
-            timer.start();
-
-            uniform_remeshing(*mesh, length, iters, project);
-
-            timer.stop();
-            LOG(Log_info) << timer << std::endl;
-
+            run_job(node, budget, [=]()
+            {
+                return uniform_remeshing(*mesh, length, iters, project,
+                                         parallel, &progress_);
+            });
         }
-
-        analyze_mesh();
-
-        node->update_mesh();
-        QApplication::postEvent(main_window_, new Geometry_changed_event());
-
-        QApplication::restoreOverrideCursor();
     }
 }
 
@@ -120,8 +141,6 @@ slot_adaptive_remeshing()
 
     if (node)
     {
-        QApplication::setOverrideCursor(Qt::WaitCursor);
-
         Surface_mesh* mesh = &node->mesh_;
 
         Scalar min_length = widget_->le_min_length->text().toFloat();
@@ -130,7 +149,9 @@ slot_adaptive_remeshing()
         int iters         = widget_->sb_adaptive_iterations->value();
         bool relative     = widget_->cb_relative_lengths->isChecked();
         bool project      = widget_->cb_adaptive_project->isChecked();
-        
+        bool parallel     = widget_->cb_adaptive_parallel->isChecked();
+        int budget        = widget_->sb_adaptive_budget->value();
+        bool anisotropic  = widget_->cb_anisotropic->isChecked();
 
         if (relative)
         {
@@ -141,20 +162,79 @@ slot_adaptive_remeshing()
         }
 
 
-        utility::Stop_watch timer;
-        timer.start();
+        run_job(node, budget, [=]()
+        {
+            if (anisotropic)
+                return anisotropic_remeshing(*mesh, min_length, max_length, error,
+                                             iters, project, parallel, &progress_);
+            return adaptive_remeshing(*mesh, min_length, max_length, error,
+                                      iters, project, parallel, &progress_);
+        });
+    }
+}
 
-        adaptive_remeshing(*mesh, min_length, max_length, error, iters, project);
 
-        timer.stop();
-        LOG(Log_info) << timer << std::endl;
+//-----------------------------------------------------------------------------
 
-        analyze_mesh();
 
-        node->update_mesh();
-        QApplication::postEvent(main_window_, new Geometry_changed_event());
+void
+Remeshing_plugin::
+run_job(Surface_mesh_node* node, int budget, const std::function<bool()>& job)
+{
+    // one job at a time, the mesh belongs to the worker until it is done
+    if (worker_) return;
+
+    job_node_ = node;
+    widget_->setEnabled(false);
+
+    // keep the node from being edited, reverted or closed meanwhile
+    node->set_busy(true);
+
+    // the modal dialog blocks all other user input until the job is done,
+    // also after a cancel, while the job winds down
+    progress_dialog_ = new QProgressDialog("Remeshing", "Cancel", 0, 100, main_window_);
+    progress_dialog_->setWindowModality(Qt::ApplicationModal);
+    progress_dialog_->setAutoReset(false);
+    progress_dialog_->setAutoClose(false);
+    progress_dialog_->setMinimumDuration(0);
+    progress_dialog_->show();
+    connect(progress_dialog_, SIGNAL(canceled()), this, SLOT(slot_cancel()));
+
+    progress_.set_time_budget(1000.0 * budget);
+    progress_.start();
+
+    worker_ = new Worker_thread([this, job]() { job_finished_ = job(); }, this);
+    connect(worker_, SIGNAL(finished()), this, SLOT(slot_job_finished()));
+    worker_->start();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Remeshing_plugin::
+slot_progress(QString stage, float fraction)
+{
+    if (progress_dialog_)
+    {
+        progress_dialog_->setLabelText("Remeshing: " + stage);
+        progress_dialog_->setValue(int(100.0f * fraction));
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
 
-        QApplication::restoreOverrideCursor();
+void
+Remeshing_plugin::
+slot_show_intermediate()
+{
+    if (job_node_)
+    {
+        job_node_->update_mesh();
+        QApplication::postEvent(main_window_, new Geometry_changed_event());
     }
 }
 
@@ -162,6 +242,47 @@ slot_adaptive_remeshing()
 //-----------------------------------------------------------------------------
 
 
+void
+Remeshing_plugin::
+slot_cancel()
+{
+    progress_.cancel();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Remeshing_plugin::
+slot_job_finished()
+{
+    // the plugin is being destroyed
+    if (!job_node_) return;
+
+    LOG(Log_info) << "Time: " << progress_.elapsed() << " ms"
+                  << (job_finished_ ? "" : " (stopped early)") << std::endl;
+
+    worker_->deleteLater();
+    worker_ = NULL;
+
+    progress_dialog_->deleteLater();
+    progress_dialog_ = NULL;
+
+    analyze_mesh(job_node_->mesh_);
+
+    job_node_->update_mesh();
+    QApplication::postEvent(main_window_, new Geometry_changed_event());
+    job_node_->set_busy(false);
+    job_node_ = NULL;
+
+    widget_->setEnabled(true);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 void
 Remeshing_plugin::
 slot_mean_edge_length()
@@ -347,26 +468,23 @@ slot_select_ravine()
 //------------------------------------------------------------------------------
 void
 Remeshing_plugin::
-analyze_mesh()
+analyze_mesh(const Surface_mesh& mesh)
 {
-    Surface_mesh* mesh = selected_mesh();
-    assert(mesh);
-
 
     // compute min, max, mean-min triangle angle
     Scalar amin(M_PI), amax(0.0), aminmean(0.0), a0, a1, a2;
 
     // loop over all triangles
-    Surface_mesh::Face_iterator fit, fend=mesh->faces_end();
+    Surface_mesh::Face_iterator fit, fend=mesh.faces_end();
     Surface_mesh::Vertex_around_face_circulator  vfit;
     Point p0, p1, p2;
 
-    for (fit=mesh->faces_begin(); fit!=fend; ++fit)
+    for (fit=mesh.faces_begin(); fit!=fend; ++fit)
     {
-        vfit = mesh->vertices(*fit);
-        p0 = mesh->position(*vfit);
-        p1 = mesh->position(*++vfit);
-        p2 = mesh->position(*++vfit);
+        vfit = mesh.vertices(*fit);
+        p0 = mesh.position(*vfit);
+        p1 = mesh.position(*++vfit);
+        p2 = mesh.position(*++vfit);
 
         a0 = acos(std::min(Scalar(1.0), std::max(Scalar(-1.0), dot(normalize(p1-p0), normalize(p2-p0)))));
         a1 = acos(std::min(Scalar(1.0), std::max(Scalar(-1.0), dot(normalize(p0-p1), normalize(p2-p1)))));
@@ -381,7 +499,7 @@ analyze_mesh()
 
     amin *= 180.0 / M_PI;
     amax *= 180.0 / M_PI;
-    aminmean *= 180.0 / M_PI / (Scalar) mesh->n_faces();
+    aminmean *= 180.0 / M_PI / (Scalar) mesh.n_faces();
 
     LOG(Log_info) << "triangle angles [" << amin << ", " << amax << "], mean-min  = " << aminmean << std::endl;
 }
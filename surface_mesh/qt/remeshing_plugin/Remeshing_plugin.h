@@ -2,9 +2,14 @@
 #define GRAPHENE_REMESHING_PLUGIN_H
 
 #include <iostream>
+#include <functional>
 
 #include <graphene/qt/Main_window.h>
 #include <graphene/surface_mesh/qt/Surface_mesh_plugin_interface.h>
+#include <graphene/surface_mesh/qt/Worker_thread.h>
+#include <graphene/utility/Progress.h>
+
+#include <QProgressDialog>
 
 #include "ui_Remeshing_plugin.h"
 
@@ -25,6 +30,7 @@ class Remeshing_plugin :
 
 public:
     Remeshing_plugin();
+    ~Remeshing_plugin();
     void init(Main_window *w);
 
 public slots:
@@ -35,8 +41,25 @@ public slots:
 	void slot_select_ravine();
 	void slot_calculate_line();
 
+private slots:
+    void slot_progress(QString stage, float fraction);
+    void slot_show_intermediate();
+    void slot_cancel();
+    void slot_job_finished();
+
+private:
+    /// run remeshing job on a worker thread, budget in seconds (0 = unlimited)
+    void run_job(Surface_mesh_node* node, int budget,
+                 const std::function<bool()>& job);
+
+    void analyze_mesh(const Surface_mesh& mesh);
+
 private:
-    void analyze_mesh();
+    utility::Progress   progress_;
+    Worker_thread*      worker_;
+    QProgressDialog*    progress_dialog_;
+    Surface_mesh_node*  job_node_;
+    bool                job_finished_;
 
 protected:
     Remeshing_plugin_widget* widget_;
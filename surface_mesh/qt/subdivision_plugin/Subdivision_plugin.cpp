@@ -7,8 +7,12 @@
 #include <graphene/surface_mesh/algorithms/subdivision/sqrt3_subdivision.h>
 #include <graphene/surface_mesh/algorithms/subdivision/loop_subdivision.h>
 #include <graphene/surface_mesh/algorithms/subdivision/catmull_clark_subdivision.h>
+#include <graphene/surface_mesh/algorithms/subdivision/Limit_evaluator.h>
 #include <graphene/surface_mesh/algorithms/subdivision/line_dilate.h>
 #include <graphene/surface_mesh/algorithms/subdivision/feature extension.h>
+#include <graphene/surface_mesh/algorithms/feature_detection/Crest_lines.h>
+#include <graphene/surface_mesh/algorithms/feature_detection/Line_simplifier.h>
+#include <graphene/macros.h>
 
 #include <QToolBox>
 #include <QGroupBox>
@@ -30,8 +34,16 @@ namespace qt {
 
 Subdivision_plugin::
 Subdivision_plugin()
+    : worker_(NULL), progress_dialog_(NULL), job_node_(NULL), job_finished_(false)
 {
     name_ = "Subdivision_plugin";
+
+    // called from the worker thread, forward to the GUI thread
+    progress_.set_callback([this](const std::string&, float fraction)
+    {
+        QMetaObject::invokeMethod(this, "slot_progress", Qt::QueuedConnection,
+                                  Q_ARG(float, fraction));
+    });
 }
 
 
@@ -41,6 +53,13 @@ Subdivision_plugin()
 Subdivision_plugin::
 ~Subdivision_plugin()
 {
+    if (worker_)
+    {
+        // as Remeshing_plugin, drop the result of the job
+        job_node_ = NULL;
+        progress_.cancel();
+        worker_->wait_handling_events();
+    }
 }
 
 
@@ -60,28 +79,38 @@ init(Main_window *w)
     rb_catmull_     = new QRadioButton("Catmull Clark", toolbox);
     rb_sqrt3_       = new QRadioButton("Sqrt(3)", toolbox);
     rb_triangulate_ = new QRadioButton("Triangle-Split", toolbox);
+    rb_crest_       = new QRadioButton("Crest Lines", toolbox);
 	rb_dilate_      = new QRadioButton("Dilate Feature Line", toolbox);
 	rb_extension_   = new QRadioButton("Feature Extension", toolbox);
+    rb_simplify_    = new QRadioButton("Simplify Feature Lines", toolbox);
 
     QButtonGroup* bg = new QButtonGroup(this);
     bg->addButton(rb_loop_);
     bg->addButton(rb_catmull_);
     bg->addButton(rb_sqrt3_);
     bg->addButton(rb_triangulate_);
+    bg->addButton(rb_crest_);
 	bg->addButton(rb_dilate_);
 	bg->addButton(rb_extension_);
+    bg->addButton(rb_simplify_);
+
+    pb_subdivide_ = new QPushButton("Subdivide", toolbox);
+    connect(pb_subdivide_, SIGNAL(clicked()), this, SLOT(subdivide()));
 
-    QPushButton* pb_subdivide = new QPushButton("Subdivide", toolbox);
-    connect(pb_subdivide, SIGNAL(clicked()), this, SLOT(subdivide()));
+    pb_limit_ = new QPushButton("Limit Surface", toolbox);
+    connect(pb_limit_, SIGNAL(clicked()), this, SLOT(limit_surface()));
 
     QVBoxLayout *vbox = new QVBoxLayout;
     vbox->addWidget(rb_loop_);
     vbox->addWidget(rb_catmull_);
     vbox->addWidget(rb_sqrt3_);
     vbox->addWidget(rb_triangulate_);
+    vbox->addWidget(rb_crest_);
 	vbox->addWidget(rb_dilate_);
 	vbox->addWidget(rb_extension_);
-    vbox->addWidget(pb_subdivide);
+    vbox->addWidget(rb_simplify_);
+    vbox->addWidget(pb_subdivide_);
+    vbox->addWidget(pb_limit_);
     vbox->addStretch(1);
     groupBox->setLayout(vbox);
 
@@ -99,24 +128,40 @@ subdivide()
 {
     Surface_mesh_node* node = selected_node();
 
-    if (node)
+    if (node && !worker_)
     {
+        Surface_mesh* mesh = &node->mesh_;
+
         if (rb_sqrt3_->isChecked())
         {
             sqrt3_subdivision(node->mesh_);
         }
         else if (rb_loop_->isChecked())
         {
-            loop_subdivision(node->mesh_);
+            if (!mesh->is_triangle_mesh())
+            {
+                LOG(Log_warning) << "Loop subdivision: needs a triangle mesh" << std::endl;
+                return;
+            }
+
+            run_job(node, [=]() { return loop_subdivision(*mesh, &progress_); });
+            return;
         }
         else if (rb_catmull_->isChecked())
         {
-            catmull_clark_subdivision(node->mesh_);
+            run_job(node, [=]() { return catmull_clark_subdivision(*mesh, &progress_); });
+            return;
         }
 		else if (rb_triangulate_->isChecked())
 		{
 			triangle_split();
 		}
+        else if (rb_crest_->isChecked())
+        {
+            surface_mesh::Curvature_analyzer analyzer(node->mesh_);
+            analyzer.analyze_tensor(1, true);
+            surface_mesh::Crest_lines(node->mesh_).extract(analyzer);
+        }
 		else if(rb_dilate_->isChecked())
 		{
 			node->is_visual = false;
@@ -126,6 +171,17 @@ subdivide()
 		{
 			feature_extension(node->mesh_);
 		}
+        else if (rb_simplify_->isChecked())
+        {
+            // a tenth of the mean edge length is below what can be seen
+            Scalar length(0);
+            for (auto e : node->mesh_.edges())
+                length += node->mesh_.edge_length(e);
+            if (node->mesh_.n_edges())
+                length /= node->mesh_.n_edges();
+
+            surface_mesh::Line_simplifier(node->mesh_).simplify(0.1 * length);
+        }
         node->update_mesh();
         QApplication::postEvent(main_window_, new Geometry_changed_event());
     }
@@ -135,6 +191,120 @@ subdivide()
 //-----------------------------------------------------------------------------
 
 
+void
+Subdivision_plugin::
+limit_surface()
+{
+    Surface_mesh_node* node = selected_node();
+
+    if (node && !worker_ && (rb_loop_->isChecked() || rb_catmull_->isChecked()))
+    {
+        surface_mesh::Limit_evaluator evaluator(rb_loop_->isChecked() ?
+                                                surface_mesh::Subdivider::LOOP :
+                                                surface_mesh::Subdivider::CATMULL_CLARK);
+
+        if (!evaluator.setup(node->mesh_) || !evaluator.project(node->mesh_))
+        {
+            LOG(Log_warning) << "Limit surface: unsupported mesh" << std::endl;
+            return;
+        }
+
+        node->update_mesh();
+        QApplication::postEvent(main_window_, new Geometry_changed_event());
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivision_plugin::
+run_job(Surface_mesh_node* node, const std::function<bool()>& job)
+{
+    job_node_ = node;
+    pb_subdivide_->setEnabled(false);
+
+    // keep the node from being edited, reverted or closed meanwhile
+    node->set_busy(true);
+
+    // the modal dialog blocks all other user input until the job is done,
+    // also after a cancel, while the job winds down
+    progress_dialog_ = new QProgressDialog("Subdivision", "Cancel", 0, 100, main_window_);
+    progress_dialog_->setWindowModality(Qt::ApplicationModal);
+    progress_dialog_->setAutoReset(false);
+    progress_dialog_->setAutoClose(false);
+    progress_dialog_->setMinimumDuration(0);
+    progress_dialog_->show();
+    connect(progress_dialog_, SIGNAL(canceled()), this, SLOT(slot_cancel()));
+
+    progress_.start();
+
+    worker_ = new Worker_thread([this, job]() { job_finished_ = job(); }, this);
+    connect(worker_, SIGNAL(finished()), this, SLOT(slot_job_finished()));
+    worker_->start();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivision_plugin::
+slot_progress(float fraction)
+{
+    if (progress_dialog_)
+        progress_dialog_->setValue(int(100.0f * fraction));
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivision_plugin::
+slot_cancel()
+{
+    progress_.cancel();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+Subdivision_plugin::
+slot_job_finished()
+{
+    // the plugin is being destroyed
+    if (!job_node_) return;
+
+    if (!job_finished_)
+    {
+        if (progress_.is_cancelled())
+            LOG(Log_info) << "Subdivision cancelled" << std::endl;
+        else
+            LOG(Log_warning) << "Subdivision: unsupported mesh" << std::endl;
+    }
+
+    worker_->deleteLater();
+    worker_ = NULL;
+
+    progress_dialog_->deleteLater();
+    progress_dialog_ = NULL;
+
+    job_node_->update_mesh();
+    QApplication::postEvent(main_window_, new Geometry_changed_event());
+    job_node_->set_busy(false);
+    job_node_ = NULL;
+
+    pb_subdivide_->setEnabled(true);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 void
 Subdivision_plugin::
 triangle_split()
@@ -163,6 +333,8 @@ triangle_split()
                 node->mesh_.split(f, c);
             }
         }
+
+        node->mesh_.geometry_changed();
     }
 }
 
@@ -8,9 +8,15 @@
 
 #include <graphene/qt/Main_window.h>
 #include <graphene/surface_mesh/qt/Surface_mesh_plugin_interface.h>
+#include <graphene/surface_mesh/qt/Worker_thread.h>
+#include <graphene/utility/Progress.h>
 
 #include <QComboBox>
 #include <QRadioButton>
+#include <QPushButton>
+#include <QProgressDialog>
+
+#include <functional>
 
 
 //=============================================================================
@@ -43,9 +49,27 @@ public:
 
 public slots:
     void subdivide();
+    void limit_surface();
+
+private slots:
+    void slot_progress(float fraction);
+    void slot_cancel();
+    void slot_job_finished();
+
+private:
+    /// run a subdivision job on a worker thread, cancellable from the dialog
+    void run_job(Surface_mesh_node* node, const std::function<bool()>& job);
 
 protected:
-    QRadioButton *rb_loop_, *rb_catmull_, *rb_sqrt3_, *rb_triangulate_,*rb_dilate_,*rb_extension_;
+    QRadioButton *rb_loop_, *rb_catmull_, *rb_sqrt3_, *rb_triangulate_,*rb_crest_,*rb_dilate_,*rb_extension_,*rb_simplify_;
+    QPushButton  *pb_subdivide_, *pb_limit_;
+
+private:
+    utility::Progress   progress_;
+    Worker_thread*      worker_;
+    QProgressDialog*    progress_dialog_;
+    Surface_mesh_node*  job_node_;
+    bool                job_finished_;
 };
 
 
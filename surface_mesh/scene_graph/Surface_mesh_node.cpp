@@ -9,8 +9,13 @@
 #include <graphene/surface_mesh/scene_graph/Surface_mesh_node.h>
 #include <graphene/surface_mesh/scene_graph/mean_curvature_texture.h>
 #include <graphene/surface_mesh/data_structure/IO.h>
+#include <graphene/surface_mesh/data_structure/Feature_graph.h>
+#include <graphene/surface_mesh/algorithms/decimation/Decimater.h>
+#include <graphene/surface_mesh/algorithms/surface_mesh_tools/Geodesics.h>
 #include <graphene/utility/Stop_watch.h>
 
+#include <algorithm>
+#include <cfloat>
 #include <climits>
 #include <sstream>
 
@@ -25,6 +30,86 @@ namespace graphene {
 		//=============================================================================
 
 
+		namespace {
+
+			// uniform grid over a bounding box, the finest clusters of the LOD
+			// hierarchy. res is a power of two, coarser levels halve it.
+			struct Lod_grid
+			{
+				Lod_grid(geometry::Bounding_box bb, int r) : min(bb.min()), res(r)
+				{
+					const Point size = bb.max() - bb.min();
+					for (int i = 0; i < 3; ++i)
+						scale[i] = (size[i] > 0.0) ? res / size[i] : 0.0;
+				}
+
+				int n_cells() const { return res * res * res; }
+
+				int cell(const Point& p) const
+				{
+					int c[3];
+					for (int i = 0; i < 3; ++i)
+						c[i] = std::min(res - 1, std::max(0, int((p[i] - min[i]) * scale[i])));
+					return (c[2] * res + c[1]) * res + c[0];
+				}
+
+				// the cell containing cell c of a grid of resolution r in the grid
+				// of resolution r >> l
+				static int coarse(int c, int r, int l)
+				{
+					const int x = c % r, y = (c / r) % r, z = c / (r * r);
+					const int rl = r >> l;
+					return ((z >> l) * rl + (y >> l)) * rl + (x >> l);
+				}
+
+				Point min, scale;
+				int   res;
+			};
+
+
+			// the grid cell of the centroid of f
+			int centroid_cell(const surface_mesh::Surface_mesh& mesh,
+				const Lod_grid& grid,
+				surface_mesh::Surface_mesh::Face f)
+			{
+				Point c(0, 0, 0);
+				int n = 0;
+				for (auto v : mesh.vertices(f))
+				{
+					c += mesh.position(v);
+					++n;
+				}
+				return grid.cell(c / n);
+			}
+
+
+			// order faces by their cells[i] (counting sort), the faces of cell c
+			// are [offsets[c], offsets[c+1])
+			void sort_by_cell(std::vector<surface_mesh::Surface_mesh::Face>& faces,
+				const std::vector<int>& cells,
+				int n_cells,
+				std::vector<int>& offsets)
+			{
+				offsets.assign(n_cells + 1, 0);
+				for (size_t i = 0; i < faces.size(); ++i)
+					++offsets[cells[i] + 1];
+
+				for (int c = 0; c < n_cells; ++c)
+					offsets[c + 1] += offsets[c];
+
+				std::vector<int> next(offsets.begin(), offsets.end() - 1);
+				std::vector<surface_mesh::Surface_mesh::Face> sorted(faces.size());
+				for (size_t i = 0; i < faces.size(); ++i)
+					sorted[next[cells[i]]++] = faces[i];
+				faces.swap(sorted);
+			}
+
+		}
+
+
+		//=============================================================================
+
+
 		Surface_mesh_node::
 			Surface_mesh_node(Base_node* _parent, const std::string& _name)
 			: Object_node(_parent, _name)
@@ -58,6 +143,9 @@ namespace graphene {
 			lineVert_buffer_ = 0;
 			line_index_buffer_ = 0;
 			line_ravidx_buffer_ = 0;
+			lod_vertex_array_object_ = 0;
+			lod_vertex_buffer_ = 0;
+			lod_normal_buffer_ = 0;
 
 
 			// initialize buffer sizes
@@ -92,6 +180,9 @@ namespace graphene {
 			material_ = Vec4f(0.1, 1.0, 1.0, 100.0);
 			crease_angle_ = 0.0;
 			is_visual = false;
+			lod_min_faces_ = 1000000;
+			lod_pixel_error_ = 1.0f;
+			lod_revision_ = 0;
 
 			// selection modes
 			clear_selection_modes();
@@ -343,7 +434,10 @@ namespace graphene {
 				phong_shader->set_uniform("use_vertexcolor", has_colors());
 				glDepthRange(0.002, 1.0);
 
-				glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+				if (lod_levels_.empty())
+					glDrawArrays(GL_TRIANGLES, 0, n_vertices_);
+				else
+					draw_lod(gl);
 
 				phong_shader->set_uniform("front_color", ridge_color_);
 
@@ -459,16 +553,34 @@ namespace graphene {
 			}
 
 
+			// faces in drawing order, grouped by LOD cluster for large meshes.
+			// both only depend on the geometry: keep them while the mesh
+			// revision stays the same (material, colors, feature lines, ...)
+			if (draw_faces_.empty() || lod_revision_ != mesh_.revision())
+			{
+				clear_lod();
+				draw_faces_.clear();
+				draw_faces_.reserve(mesh_.n_faces());
+				for (auto f : mesh_.faces())
+					draw_faces_.push_back(f);
+				if (lod_min_faces_ && mesh_.n_faces() >= lod_min_faces_)
+					build_lod();
+				lod_revision_ = mesh_.revision();
+			}
+
+
 			// activate VAO
 			glBindVertexArray(vertex_array_object_);
 
+			points.clear();
+			normals.clear();
 			points.reserve(mesh_.n_faces() * 3);
 			normals.reserve(mesh_.n_faces() * 3);
 
 			auto vpoints = mesh_.vertex_property<Point>("v:point");
 			auto vertex_indices = mesh_.vertex_property<size_t>("v:index");
 			size_t i(0);
-			for (auto f : mesh_.faces())
+			for (auto f : draw_faces_)
 			{
 				Surface_mesh::Vertex_around_face_circulator  fvit, fvend;
 				Surface_mesh::Vertex v0, v1, v2;
@@ -566,7 +678,7 @@ namespace graphene {
 			auto vcolors = mesh_.get_vertex_property<Color>("v:color");
 			auto fcolors = mesh_.get_face_property<Color>("f:color");
 
-			for (auto f : mesh_.faces())
+			for (auto f : draw_faces_)
 			{
 				Surface_mesh::Vertex_around_face_circulator fvit, fvend;
 				Surface_mesh::Vertex v0, v1, v2;
@@ -619,7 +731,7 @@ namespace graphene {
 			std::vector<float> texcoords;
 			texcoords.reserve(mesh_.n_faces() * 3);
 
-			for (auto f : mesh_.faces())
+			for (auto f : draw_faces_)
 			{
 				Surface_mesh::Vertex_around_face_circulator fvit, fvend;
 				Surface_mesh::Vertex v0, v1, v2;
@@ -712,96 +824,28 @@ namespace graphene {
 
 			//ridge ravine
 				
-					auto fpoints = mesh_.get_feature_v_property<Point>("f:point");
-					auto visual = mesh_.get_line_property<bool>("l:visual");
-					Point v_pos;
 					mesh_.vertset.clear();
 					mesh_.ridges.clear();
 					mesh_.ravines.clear();
 					n_lines_ = 0;
 					n_rav_lines_ = 0;
-					for (auto v : mesh_.fvertices())
-					{
-						v_pos = fpoints[v];
-						mesh_.vertset.push_back(v_pos);
-					}
-                if (!is_visual)
-				  {
+					// only the points of the drawn lines, copied run by run from the
+					// compact line runs, so deleted or simplified away feature
+					// vertices are not uploaded
+					surface_mesh::Feature_graph graph(mesh_);
 					for (auto l : mesh_.lines())
 					{
-						if (!mesh_.is_deleted(l))
-						{
-							Surface_mesh::FeatureHalfedge hhead;
-							Surface_mesh::FeatureVertex vtail;
-							hhead = mesh_.halfedge(l);
-							vtail = mesh_.tail(l);
-							if (mesh_.is_ridge(l))
-							{
-								while (1)
-								{
-									mesh_.ridges.push_back(mesh_.from_vertex(hhead).idx());
-									mesh_.ridges.push_back(mesh_.to_vertex(hhead).idx());
-									if (mesh_.to_vertex(hhead) == vtail) break;
-									hhead = mesh_.next_halfedge(hhead);
-								}
-							}
-							else
-							{
-								while (1)
-								{
-									mesh_.ravines.push_back(mesh_.from_vertex(hhead).idx());
-									mesh_.ravines.push_back(mesh_.to_vertex(hhead).idx());
-									if (mesh_.to_vertex(hhead) == vtail) break;
-									hhead = mesh_.next_halfedge(hhead);
-								}
-							}
-						}
-					}
+						if (mesh_.is_deleted(l) || (is_visual && !mesh_.is_visual(l))) continue;
 
-					if (!mesh_.ridges.empty())
-					{
-						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, line_index_buffer_);
-						glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh_.ridges.size() * sizeof(unsigned int), &mesh_.ridges[0], GL_STATIC_DRAW);
-						n_lines_ = mesh_.ridges.size();
-					}
+						const int first = mesh_.vertset.size();
+						const Point* points = graph.points(l);
+						mesh_.vertset.insert(mesh_.vertset.end(), points, points + graph.size(l));
 
-					if (!mesh_.ravines.empty())
-					{
-						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, line_ravidx_buffer_);
-						glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh_.ravines.size() * sizeof(unsigned int), &mesh_.ravines[0], GL_STATIC_DRAW);
-						n_rav_lines_ = mesh_.ravines.size();
-					}
-				}
-				else
-				{
-					for (auto l : mesh_.lines())
-					{
-						if (!mesh_.is_deleted(l) && mesh_.is_visual(l))
+						std::vector<int>& segments = graph.is_ridge(l) ? mesh_.ridges : mesh_.ravines;
+						for (unsigned int i = 0; i + 1 < graph.size(l); ++i)
 						{
-							Surface_mesh::FeatureHalfedge hhead;
-							Surface_mesh::FeatureVertex vtail;
-							hhead = mesh_.halfedge(l);
-							vtail = mesh_.tail(l);
-							if (mesh_.is_ridge(l))
-							{
-								while (1)
-								{
-									mesh_.ridges.push_back(mesh_.from_vertex(hhead).idx());
-									mesh_.ridges.push_back(mesh_.to_vertex(hhead).idx());
-									if (mesh_.to_vertex(hhead) == vtail) break;
-									hhead = mesh_.next_halfedge(hhead);
-								}
-							}
-							else
-							{
-								while (1)
-								{
-									mesh_.ravines.push_back(mesh_.from_vertex(hhead).idx());
-									mesh_.ravines.push_back(mesh_.to_vertex(hhead).idx());
-									if (mesh_.to_vertex(hhead) == vtail) break;
-									hhead = mesh_.next_halfedge(hhead);
-								}
-							}
+							segments.push_back(first + i);
+							segments.push_back(first + i + 1);
 						}
 					}
 
@@ -818,7 +862,6 @@ namespace graphene {
 						glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh_.ravines.size() * sizeof(unsigned int), &mesh_.ravines[0], GL_STATIC_DRAW);
 						n_rav_lines_ = mesh_.ravines.size();
 					}
-				}
 		}
 
 		//-----------------------------------------------------------------------------
@@ -1094,6 +1137,33 @@ namespace graphene {
 		//-----------------------------------------------------------------------------
 
 
+		void
+			Surface_mesh_node::
+			grow_selection(Scalar radius)
+		{
+			auto selected = mesh_.get_vertex_property<bool>("v:selected");
+
+			if (selected)
+			{
+				// select everything within geodesic distance radius
+				std::vector<Surface_mesh::Vertex> sources, vertices;
+				for (auto v : mesh_.vertices())
+					if (selected[v])
+						sources.push_back(v);
+
+				surface_mesh::Geodesics(mesh_).ball(sources, radius, vertices);
+
+				for (auto v : vertices)
+					selected[v] = true;
+
+				update_selection();
+			}
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
 		void
 			Surface_mesh_node::
 			initialize_buffers()
@@ -1144,6 +1214,303 @@ namespace graphene {
 			if (line_ravidx_buffer_)     glDeleteBuffers(1, &line_ravidx_buffer_);
 			if (vsa_index_buffer_)       glDeleteBuffers(1, &vsa_index_buffer_);
 			if (vertex_array_object_)    glDeleteVertexArrays(1, &vertex_array_object_);
+
+			clear_lod();
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Surface_mesh_node::
+			build_lod()
+		{
+			// the decimater needs triangles, 3 buffer vertices per face
+			if (!mesh_.is_triangle_mesh())
+				return;
+
+			utility::Stop_watch timer; timer.start();
+
+
+			// a few thousand cells, finer for larger meshes
+			const int target = std::min(32, std::max(8, int(cbrt(mesh_.n_faces() / 16384.0))));
+			int res = 8;
+			while (2 * res <= target)
+				res *= 2;
+			Bounding_box bb;
+			for (auto v : mesh_.vertices())
+				bb += mesh_.position(v);
+			const Lod_grid grid(bb, res);
+
+			std::vector<int> offsets, cells;
+			std::vector<Point> lod_points;
+			std::vector<Normal> lod_normals;
+			Lod_level level;
+
+
+			// level 0: the mesh itself, draw_faces_ determines the buffer order.
+			// the faces of the decimated copies keep their finest cell.
+			Surface_mesh lod = mesh_;
+			auto fcell = lod.face_property<int>("f:lod_cell", -1);
+
+			cells.resize(draw_faces_.size());
+			for (size_t i = 0; i < draw_faces_.size(); ++i)
+				cells[i] = fcell[draw_faces_[i]] = centroid_cell(mesh_, grid, draw_faces_[i]);
+			sort_by_cell(draw_faces_, cells, grid.n_cells(), offsets);
+
+			level.res = res;
+			level.error = 0.0;
+			level.clusters.resize(grid.n_cells());
+			level.boxes.resize(grid.n_cells());
+			for (int c = 0; c < grid.n_cells(); ++c)
+			{
+				level.clusters[c].first = 3 * offsets[c];
+				level.clusters[c].count = 3 * (offsets[c + 1] - offsets[c]);
+				for (int i = offsets[c]; i < offsets[c + 1]; ++i)
+					for (auto v : mesh_.vertices(draw_faces_[i]))
+						level.boxes[c] += mesh_.position(v);
+			}
+			lod_levels_.push_back(level);
+
+
+			// coarser levels: a quarter of the faces and half the grid
+			// resolution each, the error bounds of the successive decimations
+			// add up. vertices between faces of different cells of the new
+			// level stay unselected, which locks them in the decimater, so the
+			// cell borders keep the vertices and edges of the mesh.
+			auto vselected = lod.vertex_property<bool>("v:selected", false);
+			std::vector<Surface_mesh::Face> faces;
+			Scalar error = 0.0;
+			unsigned int nf;
+
+			for (int l = 1; (res >> l) > 0 && (nf = lod.n_faces()) / 4 >= 4096; ++l)
+			{
+				unsigned int n_free = 0;
+				for (auto v : lod.vertices())
+				{
+					int c = -1;
+					bool border = false;
+					for (auto f : lod.faces(v))
+					{
+						const int cf = Lod_grid::coarse(fcell[f], res, l);
+						if (c >= 0 && cf != c)
+							border = true;
+						c = cf;
+					}
+					vselected[v] = !border;
+					if (!border)
+						++n_free;
+				}
+				if (!n_free)
+					break;
+
+				surface_mesh::Decimater decimater(lod);
+				decimater.set_parallel(true);
+				decimater.decimate(nf / 4);
+				if (lod.n_faces() == nf)
+					break;
+
+				error += decimater.error();
+				lod.update_vertex_normals();
+				auto vnormals = lod.get_vertex_property<Normal>("v:normal");
+
+				faces.clear();
+				cells.clear();
+				for (auto f : lod.faces())
+				{
+					faces.push_back(f);
+					cells.push_back(Lod_grid::coarse(fcell[f], res, l));
+				}
+				const int n_cells = (res >> l) * (res >> l) * (res >> l);
+				sort_by_cell(faces, cells, n_cells, offsets);
+
+				// the boxes of the finer cells they contain
+				const Lod_level& finer = lod_levels_.back();
+				level.res = res >> l;
+				level.error = error;
+				level.clusters.assign(n_cells, Lod_cluster());
+				level.boxes.assign(n_cells, Bounding_box());
+				for (int c = 0; c < finer.res * finer.res * finer.res; ++c)
+					level.boxes[Lod_grid::coarse(c, finer.res, 1)] += finer.boxes[c];
+
+				for (int c = 0; c < n_cells; ++c)
+				{
+					level.clusters[c].first = lod_points.size();
+					for (int i = offsets[c]; i < offsets[c + 1]; ++i)
+					{
+						for (auto v : lod.vertices(faces[i]))
+						{
+							lod_points.push_back(lod.position(v));
+							lod_normals.push_back(vnormals[v]);
+							level.boxes[c] += lod.position(v);
+						}
+					}
+					level.clusters[c].count = lod_points.size() - level.clusters[c].first;
+				}
+				lod_levels_.push_back(level);
+
+				// features or locked vertices prevent further reduction
+				if (4 * lod.n_faces() > 3 * nf)
+					break;
+			}
+
+			if (lod_levels_.size() < 2)
+			{
+				clear_lod();
+				return;
+			}
+
+
+			// upload the coarse levels
+			glGenVertexArrays(1, &lod_vertex_array_object_);
+			glBindVertexArray(lod_vertex_array_object_);
+
+			glGenBuffers(1, &lod_vertex_buffer_);
+			glBindBuffer(GL_ARRAY_BUFFER, lod_vertex_buffer_);
+			glBufferData(GL_ARRAY_BUFFER, lod_points.size() * 3 * sizeof(float), lod_points.data(), GL_STATIC_DRAW);
+			glVertexAttribPointer(gl::attrib_locations::VERTEX, 3, GL_FLOAT, GL_FALSE, 0, 0);
+			glEnableVertexAttribArray(gl::attrib_locations::VERTEX);
+
+			glGenBuffers(1, &lod_normal_buffer_);
+			glBindBuffer(GL_ARRAY_BUFFER, lod_normal_buffer_);
+			glBufferData(GL_ARRAY_BUFFER, lod_normals.size() * 3 * sizeof(float), lod_normals.data(), GL_STATIC_DRAW);
+			glVertexAttribPointer(gl::attrib_locations::NORMAL, 3, GL_FLOAT, GL_FALSE, 0, 0);
+			glEnableVertexAttribArray(gl::attrib_locations::NORMAL);
+
+			glBindVertexArray(0);
+
+
+			timer.stop();
+			LOG(Log_info) << "LOD: " << lod_levels_.size() << " levels, "
+				<< grid.n_cells() << " cells, coarsest " << lod.n_faces() << " faces, error "
+				<< lod_levels_.back().error << " (" << timer << ")" << std::endl;
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Surface_mesh_node::
+			clear_lod()
+		{
+			lod_levels_.clear();
+
+			if (lod_vertex_buffer_)       glDeleteBuffers(1, &lod_vertex_buffer_);
+			if (lod_normal_buffer_)       glDeleteBuffers(1, &lod_normal_buffer_);
+			if (lod_vertex_array_object_) glDeleteVertexArrays(1, &lod_vertex_array_object_);
+
+			lod_vertex_buffer_ = 0;
+			lod_normal_buffer_ = 0;
+			lod_vertex_array_object_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------------------
+
+
+		void
+			Surface_mesh_node::
+			draw_lod(gl::GL_state* gl)
+		{
+			GLint viewport[4];
+			glGetIntegerv(GL_VIEWPORT, viewport);
+
+			// an error e at clip-space depth w covers e * scale / w pixels
+			const float scale = 0.5f * viewport[3] * gl->proj_(1, 1);
+			const Mat4f& mvp = gl->modelviewproj_;
+			const int n_levels = lod_levels_.size();
+			std::vector< std::vector<int> > selected(n_levels);
+
+
+			// select a cut through the octree, (level, cell) pairs to visit
+			// start with all cells of the coarsest level
+			std::vector< std::pair<int, int> > stack;
+			const int top = lod_levels_.back().res;
+			for (int c = 0; c < top * top * top; ++c)
+				stack.push_back(std::make_pair(n_levels - 1, c));
+
+			while (!stack.empty())
+			{
+				const int l = stack.back().first;
+				const int c = stack.back().second;
+				stack.pop_back();
+
+				Bounding_box& bb = lod_levels_[l].boxes[c];
+				if (bb.is_empty()) continue;
+
+				// culled if all corners are outside the same clip plane
+				int outside[6] = { 0, 0, 0, 0, 0, 0 };
+				float wmin = FLT_MAX;
+				for (int k = 0; k < 8; ++k)
+				{
+					const Vec4f p = mvp * Vec4f((k & 1) ? bb.max()[0] : bb.min()[0],
+						(k & 2) ? bb.max()[1] : bb.min()[1],
+						(k & 4) ? bb.max()[2] : bb.min()[2],
+						1.0f);
+					for (int i = 0; i < 3; ++i)
+					{
+						if (p[i] < -p[3]) ++outside[2 * i];
+						if (p[i] > p[3]) ++outside[2 * i + 1];
+					}
+					wmin = std::min(wmin, p[3]);
+				}
+				if (std::find(outside, outside + 6, 8) != outside + 6)
+					continue;
+
+				// accurate enough at the nearest corner, cells reaching the near
+				// plane are refined down to the mesh
+				if (l == 0 || (wmin > gl->near_ && lod_levels_[l].error * scale <= lod_pixel_error_ * wmin))
+				{
+					selected[l].push_back(c);
+					continue;
+				}
+
+				// the eight cells of the next finer level
+				const int r = lod_levels_[l].res, r2 = lod_levels_[l - 1].res;
+				const int x = 2 * (c % r), y = 2 * ((c / r) % r), z = 2 * (c / (r * r));
+				for (int k = 0; k < 8; ++k)
+					stack.push_back(std::make_pair(l - 1, ((z + ((k >> 2) & 1)) * r2 + y + ((k >> 1) & 1)) * r2 + x + (k & 1)));
+			}
+
+
+			// clusters of a level are consecutive by cell, merge adjacent ranges
+			auto draw_level = [&](int l)
+			{
+				std::vector<int>& cells = selected[l];
+				std::sort(cells.begin(), cells.end());
+
+				GLint first = 0;
+				GLsizei count = 0;
+				for (size_t i = 0; i < cells.size(); ++i)
+				{
+					const Lod_cluster& cluster = lod_levels_[l].clusters[cells[i]];
+					if (!cluster.count) continue;
+
+					if (count && first + count == cluster.first)
+					{
+						count += cluster.count;
+					}
+					else
+					{
+						if (count) glDrawArrays(GL_TRIANGLES, first, count);
+						first = cluster.first;
+						count = cluster.count;
+					}
+				}
+				if (count) glDrawArrays(GL_TRIANGLES, first, count);
+			};
+
+
+			// level 0 from the buffers of the mesh, the others without colors
+			draw_level(0);
+
+			gl->get_active_shader()->set_uniform("use_vertexcolor", false);
+			glBindVertexArray(lod_vertex_array_object_);
+			for (int l = 1; l < n_levels; ++l)
+				draw_level(l);
+			glBindVertexArray(vertex_array_object_);
 		}
 
 
@@ -1169,7 +1536,7 @@ namespace graphene {
 				mesh_.update_face_normals();
 				auto fnormals = mesh_.face_property<Normal>("f:normal");
 
-				for (auto f : mesh_.faces())
+				for (auto f : draw_faces_)
 				{
 					ni = fnormals[f];
 
@@ -1209,7 +1576,7 @@ namespace graphene {
 				auto vnormals = mesh_.get_vertex_property<Normal>("v:normal");
 				auto fnormals = mesh_.face_property<Normal>("f:normal");
 
-				for (auto f : mesh_.faces())
+				for (auto f : draw_faces_)
 				{
 					Surface_mesh::Vertex_around_face_circulator fvit, fvend;
 					Surface_mesh::Vertex v0, v1, v2;
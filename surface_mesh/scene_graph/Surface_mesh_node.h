@@ -51,6 +51,7 @@ public:
     void select_isolated();
     void delete_selected();
     void grow_selection();
+    void grow_selection(Scalar radius);
     void set_selection(const std::vector<size_t>& indices);
     void get_selection(std::vector<size_t>& indices);
     void clear_selection(const std::vector<size_t>& indices);
@@ -86,12 +87,59 @@ public:
     double crease_angle_;
 	bool is_visual;
 
+    // meshes with at least this many faces get a level-of-detail hierarchy
+    // in update_mesh() and are drawn view-dependent in "Solid" mode (0: off)
+    unsigned int lod_min_faces_;
+    // screen-space error in pixels tolerated by the LOD selection
+    float lod_pixel_error_;
+
 
 private:
 
     void initialize_buffers();
     void delete_buffers();
 
+    // decimated copies of the mesh, clustered by an octree of grid cells:
+    // level l has cells of 2^l times the size of the finest ones. sorts
+    // draw_faces_ so that each finest cell is a range of the vertex buffer.
+    void build_lod();
+    void clear_lod();
+
+    // descend the octree from the coarsest level, draw each cell at the first
+    // level whose error projects to at most lod_pixel_error_ pixels, skip
+    // cells outside the view frustum
+    void draw_lod(gl::GL_state* gl);
+
+
+private:
+
+    // triangles of one grid cell at one level: a range of a vertex buffer
+    struct Lod_cluster
+    {
+        Lod_cluster() : first(0), count(0) {}
+        GLint    first;
+        GLsizei  count;
+    };
+
+    // level 0 is the mesh itself, coarser levels are in lod_vertex_buffer_.
+    // the vertices on the borders of the cells of a level are kept by all
+    // finer levels, so cells of different levels fit without cracks.
+    struct Lod_level
+    {
+        int                        res;       // grid resolution
+        Scalar                     error;     // object-space error bound
+        std::vector<Lod_cluster>   clusters;  // indexed by grid cell
+        std::vector<Bounding_box>  boxes;     // per cell, of all finer levels too
+    };
+
+    std::vector<Lod_level>     lod_levels_;
+
+    // Surface_mesh::revision() the hierarchy and draw_faces_ were built for
+    unsigned int lod_revision_;
+
+    // faces in the order of the vertex buffer
+    std::vector<Surface_mesh::Face> draw_faces_;
+
 
 private:
 
@@ -112,6 +160,10 @@ private:
 	GLuint line_ravidx_buffer_;
 	GLuint vsa_index_buffer_;
 
+    GLuint lod_vertex_array_object_;
+    GLuint lod_vertex_buffer_;
+    GLuint lod_normal_buffer_;
+
     // buffer sizes
     GLsizei n_vertices_;
     GLsizei n_edges_;
@@ -0,0 +1,106 @@
+//=============================================================================
+
+#ifndef GRAPHENE_PROGRESS_H
+#define GRAPHENE_PROGRESS_H
+
+
+//== INCLUDES =================================================================
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+
+
+//== NAMESPACE ================================================================
+
+
+namespace graphene {
+namespace utility {
+
+
+//== CLASS DEFINITION =========================================================
+
+/// \addtogroup utility
+/// @{
+
+
+/// Progress reporting, cancellation and wall-clock budget for long running
+/// algorithms. The algorithm calls report() at points where the mesh is in a
+/// consistent state and stops as soon as it returns false. cancel() may be
+/// called from any thread.
+class Progress
+{
+public:
+
+    /// callback receiving the current stage and the overall fraction in [0,1]
+    typedef std::function<void(const std::string& stage, float fraction)> Callback;
+
+
+    /// Constructor, starts the clock
+    Progress()
+        : cancelled_(false), budget_(0.0)
+    {
+        start();
+    }
+
+
+    /// set function called by report(), called from the algorithm's thread
+    void set_callback(const Callback& callback) { callback_ = callback; }
+
+    /// set wall-clock budget in ms measured from start(), 0 means unlimited
+    void set_time_budget(double ms) { budget_ = ms; }
+
+    /// restart the clock and clear a previous cancellation
+    void start()
+    {
+        start_ = std::chrono::steady_clock::now();
+        cancelled_ = false;
+    }
+
+    /// request the algorithm to stop at its next report()
+    void cancel() { cancelled_ = true; }
+
+
+    /// time in ms since start()
+    double elapsed() const
+    {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start_).count();
+    }
+
+    /// was cancel() called or is the time budget used up?
+    bool is_cancelled() const
+    {
+        return cancelled_ || (budget_ > 0.0 && elapsed() > budget_);
+    }
+
+
+    /// report progress, returns false if the algorithm should stop
+    bool report(const std::string& stage, float fraction)
+    {
+        if (callback_) callback_(stage, fraction);
+        return !is_cancelled();
+    }
+
+
+private:
+
+    Progress(const Progress&);
+    Progress& operator=(const Progress&);
+
+    std::atomic<bool>  cancelled_;
+    double             budget_;
+    Callback           callback_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+
+//=============================================================================
+/// @}
+//=============================================================================
+} // namespace utility
+} // namespace graphene
+//=============================================================================
+#endif // GRAPHENE_PROGRESS_H defined
+//=============================================================================